@@ -0,0 +1,103 @@
+
+// -- LCAnalysisTools headers
+#include "BenchmarkStore.h"
+
+// -- std headers
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+using namespace lc_analysis ;
+
+namespace {
+
+  void usage( const char *program ) {
+    std::cout << "Usage:" << std::endl ;
+    std::cout << "  " << program << " store <run.json> [options]" << std::endl ;
+    std::cout << "      Store a benchmark run as baseline for its host and suite" << std::endl ;
+    std::cout << "  " << program << " compare <run.json> [options]" << std::endl ;
+    std::cout << "      Compare a benchmark run against the baseline of its host and suite" << std::endl ;
+    std::cout << "Options:" << std::endl ;
+    std::cout << "  --store <directory>   the baseline directory (default: $LCANALYSISTOOLS_BENCH_STORE or ./bench-baselines)" << std::endl ;
+    std::cout << "  --baseline <file>     compare against this file instead of the stored baseline" << std::endl ;
+    std::cout << "  --threshold <percent> minimum slowdown to flag a regression (default: 5)" << std::endl ;
+    std::cout << "  --sigma <n>           minimum significance in robust standard deviations (default: 3)" << std::endl ;
+    std::cout << "Exit status: 0 if no regression, 1 if regressions or baseline cases missing in the run are found, 2 on error" << std::endl ;
+  }
+}
+
+int main( int argc, char **argv ) {
+  if( argc < 3 ) {
+    usage( argv[0] ) ;
+    return 2 ;
+  }
+  const std::string command = argv[1] ;
+  const std::string runFile = argv[2] ;
+  const char *storeEnv = std::getenv( "LCANALYSISTOOLS_BENCH_STORE" ) ;
+  std::string storeDirectory = storeEnv ? storeEnv : "bench-baselines" ;
+  std::string baselineFile ;
+  double threshold = 5. ;
+  double sigma = 3. ;
+  try {
+    for( int i=3 ; i<argc ; ++i ) {
+      const std::string arg = argv[i] ;
+      const bool hasValue = ( i+1 < argc ) ;
+      if( arg == "--store" && hasValue ) {
+        storeDirectory = argv[++i] ;
+      }
+      else if( arg == "--baseline" && hasValue ) {
+        baselineFile = argv[++i] ;
+      }
+      else if( arg == "--threshold" && hasValue ) {
+        threshold = std::stod( argv[++i] ) ;
+      }
+      else if( arg == "--sigma" && hasValue ) {
+        sigma = std::stod( argv[++i] ) ;
+      }
+      else {
+        usage( argv[0] ) ;
+        return 2 ;
+      }
+    }
+    bench::BenchmarkStore store( storeDirectory ) ;
+    if( command == "store" ) {
+      std::cout << "Baseline stored in " << store.store( runFile ) << std::endl ;
+      return 0 ;
+    }
+    if( command != "compare" ) {
+      usage( argv[0] ) ;
+      return 2 ;
+    }
+    const auto run = bench::readBenchmarkRun( runFile ) ;
+    const auto baseline = baselineFile.empty() ? store.baseline( run ) : bench::readBenchmarkRun( baselineFile ) ;
+    const auto runComparison = bench::compareBenchmarkRuns( baseline, run, threshold, sigma ) ;
+    const auto &comparisons = runComparison._comparisons ;
+    std::size_t regressions = 0 ;
+    std::cout << std::left << std::setw(40) << "benchmark" << std::right 
+      << std::setw(14) << "unit" << std::setw(16) << "baseline" << std::setw(16) << "current" 
+      << std::setw(10) << "change" << std::setw(10) << "sigma" << std::endl ;
+    for( const auto &comparison : comparisons ) {
+      std::cout << std::left << std::setw(40) << comparison._name << std::right << std::fixed << std::setprecision(3)
+        << std::setw(14) << comparison._unit
+        << std::setw(16) << comparison._baseline << std::setw(16) << comparison._current
+        << std::setw(9) << std::setprecision(1) << comparison._change << "%"
+        << std::setw(10) << comparison._significance 
+        << ( comparison._regression ? "  REGRESSION" : ( comparison._improvement ? "  improvement" : "" ) ) << std::endl ;
+      regressions += comparison._regression ? 1 : 0 ;
+    }
+    for( const auto &name : runComparison._missing ) {
+      std::cout << std::left << std::setw(40) << name << "  MISSING (in the baseline only)" << std::endl ;
+    }
+    for( const auto &name : runComparison._added ) {
+      std::cout << std::left << std::setw(40) << name << "  new (not in the baseline)" << std::endl ;
+    }
+    std::cout << regressions << " regression(s) found out of " << comparisons.size() << " compared benchmark(s), "
+      << runComparison._missing.size() << " missing, " << runComparison._added.size() << " new" << std::endl ;
+    return ( regressions > 0 || not runComparison._missing.empty() ) ? 1 : 0 ;
+  }
+  catch( const std::exception &e ) {
+    std::cerr << "Error: " << e.what() << std::endl ;
+    return 2 ;
+  }
+}
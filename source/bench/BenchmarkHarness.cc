@@ -0,0 +1,280 @@
+
+// -- LCAnalysisTools headers
+#include "BenchmarkHarness.h"
+#include "PerfCounters.h"
+
+// -- std headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+// -- unix headers
+#include <unistd.h>
+
+#ifndef LCANALYSISTOOLS_VERSION
+#define LCANALYSISTOOLS_VERSION "unknown"
+#endif
+
+namespace {
+
+  /// Quote a string for JSON output, escaping quotes, backslashes and control characters
+  std::string jsonString( const std::string &str ) {
+    std::stringstream ss ;
+    ss << '"' ;
+    for( const char c : str ) {
+      switch( c ) {
+        case '"': ss << "\\\"" ; break ;
+        case '\\': ss << "\\\\" ; break ;
+        case '\n': ss << "\\n" ; break ;
+        case '\t': ss << "\\t" ; break ;
+        case '\r': ss << "\\r" ; break ;
+        case '\b': ss << "\\b" ; break ;
+        case '\f': ss << "\\f" ; break ;
+        default:
+          if( static_cast<unsigned char>( c ) < 0x20 ) {
+            ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>( c ) << std::dec << std::setfill(' ') ;
+          }
+          else {
+            ss << c ;
+          }
+          break ;
+      }
+    }
+    ss << '"' ;
+    return ss.str() ;
+  }
+}
+
+namespace lc_analysis {
+
+  namespace bench {
+
+    double median( std::vector<double> values ) {
+      if( values.empty() ) {
+        return 0. ;
+      }
+      const auto middle = values.size() / 2 ;
+      std::nth_element( values.begin(), values.begin() + middle, values.end() ) ;
+      if( values.size() % 2 ) {
+        return values[middle] ;
+      }
+      const auto lower = *std::max_element( values.begin(), values.begin() + middle ) ;
+      return ( lower + values[middle] ) / 2. ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    double medianAbsoluteDeviation( const std::vector<double> &values ) {
+      const auto center = median( values ) ;
+      std::vector<double> deviations ;
+      deviations.reserve( values.size() ) ;
+      for( const auto value : values ) {
+        deviations.push_back( std::fabs( value - center ) ) ;
+      }
+      return median( std::move(deviations) ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void writeBenchmarkJSON( const std::string &fname, const std::string &suite,
+      const std::vector<BenchmarkResult> &results, const BenchmarkContext &context ) {
+      std::ofstream file( fname ) ;
+      if( not file ) {
+        throw std::runtime_error( "Couldn't open benchmark output file " + fname ) ;
+      }
+      char host[256] = {0} ;
+      gethostname( host, sizeof(host)-1 ) ;
+      const auto now = std::time( nullptr ) ;
+      char date[64] = {0} ;
+      std::strftime( date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime( &now ) ) ;
+      file << std::setprecision(10) ;
+      file << "{\n" ;
+      file << "  \"context\": {\n" ;
+      file << "    \"suite\": " << jsonString( suite ) << ",\n" ;
+      file << "    \"host\": " << jsonString( host ) << ",\n" ;
+      file << "    \"date\": " << jsonString( date ) << ",\n" ;
+      file << "    \"version\": " << jsonString( LCANALYSISTOOLS_VERSION ) << ",\n" ;
+      file << "    \"compiler\": " << jsonString( __VERSION__ ) ;
+      for( const auto &entry : context ) {
+        file << ",\n    " << jsonString( entry.first ) << ": " << jsonString( entry.second ) ;
+      }
+      file << "\n  },\n" ;
+      file << "  \"benchmarks\": [\n" ;
+      for( std::size_t i=0 ; i<results.size() ; ++i ) {
+        const auto &r = results[i] ;
+        file << "    { \"name\": " << jsonString( r._name ) << ", "
+          << "\"unit\": " << jsonString( r._unit ) << ", "
+          << "\"operations\": " << r._operations << ", "
+          << "\"ns_per_op\": " << r._nsPerOp << ", "
+          << "\"mad_ns_per_op\": " << r._mad << ", "
+          << "\"ops_per_second\": " << r._opsPerSecond << ", "
+          << "\"samples_ns_per_op\": [" ;
+        for( std::size_t s=0 ; s<r._samples.size() ; ++s ) {
+          file << ( s ? ", " : "" ) << r._samples[s] ;
+        }
+        file << "]" ;
+        if( not r._counters.empty() ) {
+          file << ", \"counters_per_op\": {" ;
+          for( std::size_t c=0 ; c<r._counters.size() ; ++c ) {
+            file << ( c ? ", " : " " ) << jsonString( r._counters[c].first ) << ": " << r._counters[c].second ;
+          }
+          file << " }" ;
+        }
+        file << " }"
+          << ( i+1 < results.size() ? "," : "" ) << "\n" ;
+      }
+      file << "  ]\n" ;
+      file << "}\n" ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    BenchmarkHarness::BenchmarkHarness( const std::string &suite, int argc, char **argv ) :
+      _suite(suite) {
+      for( int i=1 ; i<argc ; ++i ) {
+        const std::string arg = argv[i] ;
+        const bool hasValue = ( i+1 < argc ) ;
+        if( arg == "--filter" && hasValue ) {
+          _filter = argv[++i] ;
+        }
+        else if( arg == "--min-time" && hasValue ) {
+          _minTime = std::stod( argv[++i] ) ;
+        }
+        else if( arg == "--repetitions" && hasValue ) {
+          _repetitions = std::max( 1, std::stoi( argv[++i] ) ) ;
+        }
+        else if( arg == "--json" && hasValue ) {
+          _jsonFile = argv[++i] ;
+        }
+        else if( arg == "--list" ) {
+          _listOnly = true ;
+        }
+        else if( arg == "--perf" ) {
+          _perfCounters = std::make_unique<PerfCounters>() ;
+        }
+        else {
+          throw std::invalid_argument( "Unknown or incomplete benchmark option: " + arg ) ;
+        }
+      }
+      if( _perfCounters && not _perfCounters->available() ) {
+        std::cerr << "Hardware performance counters not available (" 
+          << _perfCounters->unavailableReason() << "), running without" << std::endl ;
+        _perfCounters.reset() ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    BenchmarkHarness::~BenchmarkHarness() {
+      /* nop */
+    }
+
+    //----------------------------------------------------------------------------
+
+    void BenchmarkHarness::add( const std::string &name, Function func ) {
+      _cases.push_back( { name, std::move(func) } ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    int BenchmarkHarness::run() {
+      std::vector<BenchmarkResult> results ;
+      for( const auto &c : _cases ) {
+        if( not _filter.empty() && c._name.find( _filter ) == std::string::npos ) {
+          continue ;
+        }
+        if( _listOnly ) {
+          std::cout << c._name << std::endl ;
+          continue ;
+        }
+        auto result = measure( c._name, c._function ) ;
+        std::cout << std::left << std::setw(40) << result._name
+          << std::right << std::setw(14) << std::fixed << std::setprecision(3) << result._nsPerOp << " ns/op"
+          << " +/- " << std::setw(10) << result._mad
+          << std::setw(18) << std::scientific << std::setprecision(4) << result._opsPerSecond << " ops/s"
+          << std::defaultfloat << std::endl ;
+        if( not result._counters.empty() ) {
+          std::cout << "    " << std::fixed << std::setprecision(3) ;
+          for( const auto &counter : result._counters ) {
+            std::cout << " " << counter.first << "/op=" << counter.second ;
+          }
+          std::cout << std::defaultfloat << std::endl ;
+        }
+        results.push_back( std::move(result) ) ;
+      }
+      if( not _listOnly && not _jsonFile.empty() ) {
+        writeBenchmarkJSON( _jsonFile, _suite, results, { { "perf_counters", _perfCounters ? "enabled" : "disabled" } } ) ;
+      }
+      return 0 ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    BenchmarkResult BenchmarkHarness::measure( const std::string &name, const Function &func ) const {
+      using clock = std::chrono::steady_clock ;
+      auto timeRun = [&]( std::size_t n ) {
+        const auto start = clock::now() ;
+        func( n ) ;
+        return std::chrono::duration<double>( clock::now() - start ).count() ;
+      };
+      // counters are started and stopped outside of the timed region.
+      // A counter may fail to be read, so the runs are counted per counter
+      std::vector<std::size_t> counterRuns ;
+      auto countedRun = [&]( std::size_t n, BenchmarkResult &result ) {
+        if( not _perfCounters ) {
+          return timeRun( n ) ;
+        }
+        _perfCounters->start() ;
+        const auto elapsed = timeRun( n ) ;
+        const auto readings = _perfCounters->stop() ;
+        for( const auto &reading : readings ) {
+          auto iter = std::find_if( result._counters.begin(), result._counters.end(), [&]( const auto &counter ) {
+            return counter.first == reading._name ;
+          }) ;
+          if( result._counters.end() == iter ) {
+            result._counters.emplace_back( reading._name, 0. ) ;
+            counterRuns.push_back( 0 ) ;
+            iter = std::prev( result._counters.end() ) ;
+          }
+          iter->second += reading._value ;
+          ++counterRuns[ std::distance( result._counters.begin(), iter ) ] ;
+        }
+        return elapsed ;
+      };
+      // warm up and calibrate: grow the number of operations
+      // until a run lasts at least a tenth of the minimum time
+      std::size_t operations = 1 ;
+      double elapsed = timeRun( operations ) ;
+      while( elapsed < _minTime / 10. ) {
+        operations *= 10 ;
+        elapsed = timeRun( operations ) ;
+      }
+      operations = static_cast<std::size_t>( operations * std::max( 1., _minTime / elapsed ) ) ;
+      BenchmarkResult result ;
+      result._name = name ;
+      result._operations = operations ;
+      for( std::size_t r=0 ; r<_repetitions ; ++r ) {
+        result._samples.push_back( countedRun( operations, result ) * 1e9 / operations ) ;
+      }
+      for( std::size_t c=0 ; c<result._counters.size() ; ++c ) {
+        result._counters[c].second /= static_cast<double>( operations * counterRuns[c] ) ;
+      }
+      result._nsPerOp = median( result._samples ) ;
+      result._mad = medianAbsoluteDeviation( result._samples ) ;
+      result._opsPerSecond = 1e9 / result._nsPerOp ;
+      return result ;
+    }
+
+    //----------------------------------------------------------------------------
+
+  }
+
+}
@@ -0,0 +1,139 @@
+
+#ifndef _LCANALYSISTOOLS_BENCHMARKHARNESS_H
+#define _LCANALYSISTOOLS_BENCHMARKHARNESS_H
+
+// -- std headers
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lc_analysis {
+
+  namespace bench {
+
+    class PerfCounters ;
+
+    /// Prevent the compiler from optimizing away a computed value
+    template <typename T>
+    inline void doNotOptimize( const T &value ) {
+      asm volatile( "" : : "r,m"(value) : "memory" ) ;
+    }
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /// Median of a list of values
+    double median( std::vector<double> values ) ;
+
+    /// Median absolute deviation of a list of values
+    double medianAbsoluteDeviation( const std::vector<double> &values ) ;
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  BenchmarkResult struct
+     *
+     *  Measurement of a single benchmark case, repeated 
+     *  several times. The ns/op and ops/s values are 
+     *  computed from the median of the repetitions.
+     *  Cases measuring something else than a time per operation
+     *  (e.g. memory) store their value in _nsPerOp and set the unit
+     */
+    struct BenchmarkResult {
+      std::string                _name {} ;
+      std::string                _unit {"ns/op"} ;
+      std::size_t                _operations {0} ;
+      std::vector<double>        _samples {} ;
+      double                     _nsPerOp {0.} ;
+      double                     _mad {0.} ;
+      double                     _opsPerSecond {0.} ;
+      /// Hardware counters per operation, averaged over the repetitions (if enabled)
+      std::vector<std::pair<std::string, double>> _counters {} ;
+    };
+
+    /// Context entries written in the JSON output, in addition to the default ones
+    using BenchmarkContext = std::vector<std::pair<std::string, std::string>> ;
+
+    /// Write benchmark results as JSON. The context always contains
+    /// the suite name, the host name, the date, the library version 
+    /// and the compiler version
+    void writeBenchmarkJSON( const std::string &fname, const std::string &suite,
+      const std::vector<BenchmarkResult> &results, const BenchmarkContext &context = {} ) ;
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  BenchmarkHarness class
+     *
+     *  Minimal benchmark driver. Each registered case is a function
+     *  running a given number of operations. The harness calibrates
+     *  the number of operations to reach a minimum run time, repeats
+     *  the measurement and reports the median ns/op and ops/s and the
+     *  median absolute deviation on the console and optionally as JSON.
+     *
+     *  Command line options:
+     *   - --filter <string>: only run cases whose name contains the string
+     *   - --min-time <seconds>: minimum measurement time per repetition
+     *   - --repetitions <n>: number of measurements per case
+     *   - --json <file>: write the results as JSON in the file
+     *   - --perf: read hardware performance counters around each 
+     *     repetition (see PerfCounters), including the threads started
+     *     after the harness construction. Ignored if not available
+     *   - --list: list the cases and exit
+     */
+    class BenchmarkHarness {
+    public:
+      /// The benchmark function type. Runs the given number of operations
+      using Function = std::function<void( std::size_t )> ;
+
+    public:
+      /// Constructor with command line arguments
+      BenchmarkHarness( const std::string &suite, int argc, char **argv ) ;
+
+      /// Destructor
+      ~BenchmarkHarness() ;
+
+      /// Register a new benchmark case
+      void add( const std::string &name, Function func ) ;
+
+      /// Run all the registered cases. Returns the program exit code
+      int run() ;
+
+    private:
+      /// Measure a single case
+      BenchmarkResult measure( const std::string &name, const Function &func ) const ;
+
+    private:
+      /// A registered benchmark case
+      struct Case {
+        std::string              _name {} ;
+        Function                 _function {} ;
+      };
+      /// The suite name
+      std::string                _suite {} ;
+      /// The registered cases
+      std::vector<Case>          _cases {} ;
+      /// Only run cases matching this filter
+      std::string                _filter {} ;
+      /// The JSON output file name (if any)
+      std::string                _jsonFile {} ;
+      /// The minimum measurement time per repetition, in seconds
+      double                     _minTime {0.2} ;
+      /// The number of measurements per case
+      std::size_t                _repetitions {5} ;
+      /// Whether to only list the cases
+      bool                       _listOnly {false} ;
+      /// The hardware performance counters, if requested
+      std::unique_ptr<PerfCounters> _perfCounters {} ;
+    };
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,370 @@
+
+// -- LCAnalysisTools headers
+#include "BenchmarkStore.h"
+
+// -- std headers
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+// -- unix headers
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace lc_analysis {
+
+  namespace bench {
+
+    namespace {
+
+      /// A parsed JSON value. Only what is needed to read back benchmark runs
+      struct JSONValue {
+        enum class Type { Null, Bool, Number, String, Array, Object } ;
+        Type                                            _type {Type::Null} ;
+        bool                                            _bool {false} ;
+        double                                          _number {0.} ;
+        std::string                                     _string {} ;
+        std::vector<JSONValue>                          _array {} ;
+        std::vector<std::pair<std::string, JSONValue>>  _object {} ;
+
+        /// Get an object member. Returns nullptr if not found
+        const JSONValue *member( const std::string &key ) const {
+          for( const auto &entry : _object ) {
+            if( entry.first == key ) {
+              return &entry.second ;
+            }
+          }
+          return nullptr ;
+        }
+      };
+
+      /// Minimal recursive descent JSON parser
+      class JSONParser {
+      public:
+        JSONParser( const std::string &text ) : _text(text) {}
+
+        JSONValue parse() {
+          auto value = parseValue() ;
+          skipSpaces() ;
+          if( _pos != _text.size() ) {
+            error( "trailing characters" ) ;
+          }
+          return value ;
+        }
+
+      private:
+        [[noreturn]] void error( const std::string &message ) const {
+          std::stringstream ss ; ss << "JSON parse error at position " << _pos << ": " << message ;
+          throw std::runtime_error( ss.str() ) ;
+        }
+
+        void skipSpaces() {
+          while( _pos < _text.size() && std::isspace( static_cast<unsigned char>( _text[_pos] ) ) ) {
+            ++_pos ;
+          }
+        }
+
+        void expect( char c ) {
+          skipSpaces() ;
+          if( _pos >= _text.size() || _text[_pos] != c ) {
+            error( std::string( "expected '" ) + c + "'" ) ;
+          }
+          ++_pos ;
+        }
+
+        bool consume( char c ) {
+          skipSpaces() ;
+          if( _pos < _text.size() && _text[_pos] == c ) {
+            ++_pos ;
+            return true ;
+          }
+          return false ;
+        }
+
+        bool consumeWord( const std::string &word ) {
+          if( _text.compare( _pos, word.size(), word ) == 0 ) {
+            _pos += word.size() ;
+            return true ;
+          }
+          return false ;
+        }
+
+        /// Parse the 4 hex digits of a \\u escape sequence, as UTF-8
+        std::string parseCodePoint() {
+          if( _pos + 4 > _text.size() ) {
+            error( "incomplete unicode escape sequence" ) ;
+          }
+          std::size_t end = 0 ;
+          const auto code = std::stoul( _text.substr( _pos, 4 ), &end, 16 ) ;
+          if( 4 != end ) {
+            error( "invalid unicode escape sequence" ) ;
+          }
+          _pos += 4 ;
+          std::string utf8 ;
+          if( code < 0x80 ) {
+            utf8 += static_cast<char>( code ) ;
+          }
+          else if( code < 0x800 ) {
+            utf8 += static_cast<char>( 0xc0 | ( code >> 6 ) ) ;
+            utf8 += static_cast<char>( 0x80 | ( code & 0x3f ) ) ;
+          }
+          else {
+            utf8 += static_cast<char>( 0xe0 | ( code >> 12 ) ) ;
+            utf8 += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3f ) ) ;
+            utf8 += static_cast<char>( 0x80 | ( code & 0x3f ) ) ;
+          }
+          return utf8 ;
+        }
+
+        std::string parseString() {
+          expect( '"' ) ;
+          std::string result ;
+          while( _pos < _text.size() && _text[_pos] != '"' ) {
+            if( _text[_pos] != '\\' ) {
+              result += _text[_pos++] ;
+              continue ;
+            }
+            if( ++_pos >= _text.size() ) {
+              error( "unterminated escape sequence" ) ;
+            }
+            const char c = _text[_pos++] ;
+            switch( c ) {
+              case 'n': result += '\n' ; break ;
+              case 't': result += '\t' ; break ;
+              case 'r': result += '\r' ; break ;
+              case 'b': result += '\b' ; break ;
+              case 'f': result += '\f' ; break ;
+              case 'u': result += parseCodePoint() ; break ;
+              default: result += c ; break ;
+            }
+          }
+          expect( '"' ) ;
+          return result ;
+        }
+
+        JSONValue parseValue() {
+          skipSpaces() ;
+          if( _pos >= _text.size() ) {
+            error( "unexpected end of input" ) ;
+          }
+          JSONValue value ;
+          const char c = _text[_pos] ;
+          if( c == '{' ) {
+            ++_pos ;
+            value._type = JSONValue::Type::Object ;
+            if( consume( '}' ) ) {
+              return value ;
+            }
+            do {
+              auto key = parseString() ;
+              expect( ':' ) ;
+              value._object.emplace_back( std::move(key), parseValue() ) ;
+            } while( consume( ',' ) ) ;
+            expect( '}' ) ;
+          }
+          else if( c == '[' ) {
+            ++_pos ;
+            value._type = JSONValue::Type::Array ;
+            if( consume( ']' ) ) {
+              return value ;
+            }
+            do {
+              value._array.push_back( parseValue() ) ;
+            } while( consume( ',' ) ) ;
+            expect( ']' ) ;
+          }
+          else if( c == '"' ) {
+            value._type = JSONValue::Type::String ;
+            value._string = parseString() ;
+          }
+          else if( consumeWord( "true" ) ) {
+            value._type = JSONValue::Type::Bool ;
+            value._bool = true ;
+          }
+          else if( consumeWord( "false" ) ) {
+            value._type = JSONValue::Type::Bool ;
+          }
+          else if( consumeWord( "null" ) ) {
+            value._type = JSONValue::Type::Null ;
+          }
+          else {
+            const char *begin = _text.c_str() + _pos ;
+            char *end = nullptr ;
+            value._type = JSONValue::Type::Number ;
+            value._number = std::strtod( begin, &end ) ;
+            if( end == begin ) {
+              error( "invalid value" ) ;
+            }
+            _pos += ( end - begin ) ;
+          }
+          return value ;
+        }
+
+      private:
+        const std::string    &_text ;
+        std::size_t           _pos {0} ;
+      };
+
+      /// Get a number member from a JSON object, 0 if missing
+      double numberMember( const JSONValue &object, const std::string &key ) {
+        const auto value = object.member( key ) ;
+        return ( value && value->_type == JSONValue::Type::Number ) ? value->_number : 0. ;
+      }
+
+      /// Create a directory if it doesn't exist yet
+      void makeDirectory( const std::string &directory ) {
+        if( ::mkdir( directory.c_str(), 0755 ) != 0 && errno != EEXIST ) {
+          throw std::runtime_error( "Couldn't create directory " + directory ) ;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    BenchmarkRun readBenchmarkRun( const std::string &fname ) {
+      std::ifstream file( fname ) ;
+      if( not file ) {
+        throw std::runtime_error( "Couldn't open benchmark file " + fname ) ;
+      }
+      std::stringstream buffer ;
+      buffer << file.rdbuf() ;
+      const auto text = buffer.str() ;
+      const auto root = JSONParser( text ).parse() ;
+      BenchmarkRun run ;
+      if( const auto context = root.member( "context" ) ) {
+        for( const auto &entry : context->_object ) {
+          if( entry.second._type == JSONValue::Type::String ) {
+            run._context[entry.first] = entry.second._string ;
+          }
+          else if( entry.second._type == JSONValue::Type::Number ) {
+            std::stringstream ss ; ss << entry.second._number ;
+            run._context[entry.first] = ss.str() ;
+          }
+        }
+      }
+      const auto benchmarks = root.member( "benchmarks" ) ;
+      if( nullptr == benchmarks || benchmarks->_type != JSONValue::Type::Array ) {
+        throw std::runtime_error( "No benchmark list in file " + fname ) ;
+      }
+      for( const auto &entry : benchmarks->_array ) {
+        BenchmarkResult result ;
+        if( const auto name = entry.member( "name" ) ) {
+          result._name = name->_string ;
+        }
+        if( const auto unit = entry.member( "unit" ) ) {
+          result._unit = unit->_string ;
+        }
+        result._operations = static_cast<std::size_t>( numberMember( entry, "operations" ) ) ;
+        result._nsPerOp = numberMember( entry, "ns_per_op" ) ;
+        result._mad = numberMember( entry, "mad_ns_per_op" ) ;
+        result._opsPerSecond = numberMember( entry, "ops_per_second" ) ;
+        if( const auto samples = entry.member( "samples_ns_per_op" ) ) {
+          for( const auto &sample : samples->_array ) {
+            result._samples.push_back( sample._number ) ;
+          }
+        }
+        run._results.push_back( std::move(result) ) ;
+      }
+      return run ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    BenchmarkRunComparison compareBenchmarkRuns( const BenchmarkRun &baseline,
+      const BenchmarkRun &current, double threshold, double minSignificance ) {
+      // scale factor from MAD to standard deviation for normal distributions
+      constexpr double madToSigma = 1.4826 ;
+      BenchmarkRunComparison runComparison ;
+      for( const auto &base : baseline._results ) {
+        const bool found = std::any_of( current._results.begin(), current._results.end(), [&]( const auto &result ) {
+          return base._name == result._name ;
+        }) ;
+        if( not found ) {
+          runComparison._missing.push_back( base._name ) ;
+        }
+      }
+      auto &comparisons = runComparison._comparisons ;
+      for( const auto &result : current._results ) {
+        auto iter = std::find_if( baseline._results.begin(), baseline._results.end(), [&]( const auto &base ) {
+          return base._name == result._name ;
+        }) ;
+        if( baseline._results.end() == iter ) {
+          runComparison._added.push_back( result._name ) ;
+          continue ;
+        }
+        if( iter->_nsPerOp <= 0. ) {
+          continue ;
+        }
+        BenchmarkComparison comparison ;
+        comparison._name = result._name ;
+        comparison._unit = result._unit ;
+        comparison._baseline = iter->_nsPerOp ;
+        comparison._current = result._nsPerOp ;
+        comparison._change = 100. * ( result._nsPerOp - iter->_nsPerOp ) / iter->_nsPerOp ;
+        const double sigma = madToSigma * std::hypot( result._mad, iter->_mad ) ;
+        const double difference = std::fabs( result._nsPerOp - iter->_nsPerOp ) ;
+        comparison._significance = ( sigma > 0. ) ? difference / sigma :
+          ( difference > 0. ? std::numeric_limits<double>::infinity() : 0. ) ;
+        const bool significant = ( comparison._significance >= minSignificance ) ;
+        comparison._regression = ( significant && comparison._change > threshold ) ;
+        comparison._improvement = ( significant && comparison._change < -threshold ) ;
+        comparisons.push_back( comparison ) ;
+      }
+      return runComparison ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    BenchmarkStore::BenchmarkStore( const std::string &directory ) :
+      _directory(directory) {
+      /* nop */
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::string BenchmarkStore::baselineFile( const std::string &host, const std::string &suite ) const {
+      return _directory + "/" + host + "/" + suite + ".json" ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::string BenchmarkStore::store( const std::string &runFile ) const {
+      // parse it first to make sure we store a valid run
+      const auto run = readBenchmarkRun( runFile ) ;
+      const auto host = run._context.find( "host" ) ;
+      const auto suite = run._context.find( "suite" ) ;
+      if( run._context.end() == host || run._context.end() == suite ) {
+        throw std::runtime_error( "Benchmark file " + runFile + " has no host or suite in its context" ) ;
+      }
+      makeDirectory( _directory ) ;
+      makeDirectory( _directory + "/" + host->second ) ;
+      const auto fname = baselineFile( host->second, suite->second ) ;
+      std::ifstream input( runFile, std::ios::binary ) ;
+      std::ofstream output( fname, std::ios::binary ) ;
+      if( not output ) {
+        throw std::runtime_error( "Couldn't write baseline file " + fname ) ;
+      }
+      output << input.rdbuf() ;
+      return fname ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    BenchmarkRun BenchmarkStore::baseline( const BenchmarkRun &run ) const {
+      const auto host = run._context.find( "host" ) ;
+      const auto suite = run._context.find( "suite" ) ;
+      if( run._context.end() == host || run._context.end() == suite ) {
+        throw std::runtime_error( "Benchmark run has no host or suite in its context" ) ;
+      }
+      return readBenchmarkRun( baselineFile( host->second, suite->second ) ) ;
+    }
+
+  }
+
+}
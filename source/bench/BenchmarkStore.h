@@ -0,0 +1,108 @@
+
+#ifndef _LCANALYSISTOOLS_BENCHMARKSTORE_H
+#define _LCANALYSISTOOLS_BENCHMARKSTORE_H
+
+// -- std headers
+#include <map>
+#include <string>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include "BenchmarkHarness.h"
+
+namespace lc_analysis {
+
+  namespace bench {
+
+    /**
+     *  @brief  BenchmarkRun struct
+     *
+     *  A full benchmark run, as written in JSON by the BenchmarkHarness
+     */
+    struct BenchmarkRun {
+      std::map<std::string, std::string>   _context {} ;
+      std::vector<BenchmarkResult>         _results {} ;
+    };
+
+    /// Read a benchmark run from a JSON file written by the BenchmarkHarness
+    BenchmarkRun readBenchmarkRun( const std::string &fname ) ;
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  BenchmarkComparison struct
+     *
+     *  Comparison of a benchmark case between a baseline and a new run
+     */
+    struct BenchmarkComparison {
+      std::string                _name {} ;
+      std::string                _unit {} ;
+      double                     _baseline {0.} ;
+      double                     _current {0.} ;
+      /// Relative change of the median value, in percent
+      double                     _change {0.} ;
+      /// Change in units of the combined robust standard deviation
+      double                     _significance {0.} ;
+      /// Whether the case is slower by more than the threshold, significantly
+      bool                       _regression {false} ;
+      /// Whether the case is faster by more than the threshold, significantly
+      bool                       _improvement {false} ;
+    };
+
+    /**
+     *  @brief  BenchmarkRunComparison struct
+     *
+     *  Comparison of a run against a baseline: the cases found in both runs,
+     *  and the names of the cases found in only one of them
+     */
+    struct BenchmarkRunComparison {
+      std::vector<BenchmarkComparison>     _comparisons {} ;
+      /// The baseline cases not in the current run (dropped or renamed)
+      std::vector<std::string>             _missing {} ;
+      /// The current cases not in the baseline (new or renamed)
+      std::vector<std::string>             _added {} ;
+    };
+
+    /// Compare a run against a baseline. Lower values are better for all units.
+    /// A case is flagged when its median value changes by more than threshold 
+    /// (in percent) and by more than minSignificance robust standard deviations
+    /// (1.4826 * MAD, combined between both runs). Cases found in only one of
+    /// the runs are listed as missing or added
+    BenchmarkRunComparison compareBenchmarkRuns( const BenchmarkRun &baseline,
+      const BenchmarkRun &current, double threshold, double minSignificance ) ;
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  BenchmarkStore class
+     *
+     *  Stores benchmark runs as baselines in a directory,
+     *  organized per host and suite: <directory>/<host>/<suite>.json
+     */
+    class BenchmarkStore {
+    public:
+      /// Constructor with the store directory
+      BenchmarkStore( const std::string &directory ) ;
+
+      /// Get the baseline file name for a given host and suite
+      std::string baselineFile( const std::string &host, const std::string &suite ) const ;
+
+      /// Store the run JSON file as baseline for its host and suite
+      std::string store( const std::string &runFile ) const ;
+
+      /// Load the baseline matching the host and suite of a run.
+      /// Throws if no baseline is found
+      BenchmarkRun baseline( const BenchmarkRun &run ) const ;
+
+    private:
+      /// The store directory
+      std::string                _directory {} ;
+    };
+
+  }
+
+}
+
+#endif
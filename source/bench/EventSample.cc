@@ -0,0 +1,334 @@
+
+// -- LCAnalysisTools headers
+#include "EventSample.h"
+
+// -- std headers
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <random>
+#include <utility>
+
+namespace lc_analysis {
+
+  namespace bench {
+
+    namespace {
+
+      /// Relative abundances of particles in the MC particle 
+      /// collection of an e+e- -> qq / ZH event at 250 GeV.
+      /// The sign of the id is randomized for particles having 
+      /// an anti-particle
+      const std::vector<std::pair<int, double>> eventComposition = {
+        // final state
+        { 22, 30. }, { 211, 25. }, { 321, 3.5 }, { 2212, 1.5 }, { 2112, 1.3 }, 
+        { 130, 1.6 }, { 11, 2.0 }, { 13, 0.4 }, { 12, 0.3 }, { 14, 0.3 }, { 16, 0.1 },
+        // decayed hadrons
+        { 111, 9.0 }, { 310, 1.4 }, { 221, 1.0 }, { 113, 1.2 }, { 213, 2.0 }, 
+        { 223, 1.0 }, { 313, 0.7 }, { 323, 0.7 }, { 331, 0.2 }, { 333, 0.2 }, 
+        { 3122, 0.5 }, { 3222, 0.1 }, { 3112, 0.1 }, { 3212, 0.1 }, { 3312, 0.05 }, 
+        { 2224, 0.2 }, { 2214, 0.2 }, { 2114, 0.2 }, { 1114, 0.2 },
+        { 411, 0.15 }, { 421, 0.3 }, { 431, 0.08 }, { 413, 0.1 }, { 423, 0.1 }, { 4122, 0.05 },
+        { 511, 0.08 }, { 521, 0.08 }, { 531, 0.02 }, { 513, 0.05 }, { 523, 0.05 }, { 5122, 0.01 }, 
+        { 443, 0.01 }, { 15, 0.1 },
+        // partons and hard process
+        { 1, 1.5 }, { 2, 1.5 }, { 3, 0.8 }, { 4, 0.5 }, { 5, 0.5 }, { 21, 3.5 }, 
+        { 2101, 0.1 }, { 2103, 0.1 }, { 1103, 0.05 }, { 2203, 0.05 },
+        { 23, 0.05 }, { 25, 0.05 }, { 24, 0.02 }
+      };
+
+      /// Generator specific ids found in the MC history, not in the PDG table
+      const std::vector<int> unknownIds = { 91, 92, 93, 94 } ;
+
+      /// Decay modes of the synthetic MC events, for particles (not anti-particles)
+      const std::map<int, std::vector<std::vector<int>>> decayTable = {
+        { 111, { { 22, 22 } } },
+        { 113, { { 211, -211 } } },
+        { 213, { { 211, 111 } } },
+        { 223, { { 211, -211, 111 } } },
+        { 221, { { 22, 22 }, { 111, 111, 111 } } },
+        { 310, { { 211, -211 }, { 111, 111 } } },
+        { 313, { { 321, -211 } } },
+        { 333, { { 321, -321 } } },
+        { 3122, { { 2212, -211 } } },
+        { 421, { { -321, 211 }, { -321, 211, 111 }, { -321, -11, 12 } } },
+        { 411, { { -321, 211, 211 } } },
+        { 431, { { 333, 211 } } },
+        { 4122, { { 2212, -321, 211 } } },
+        { 521, { { -421, 211 }, { -421, -11, 12 } } },
+        { 511, { { -411, 211 } } },
+        { 531, { { -431, 211 } } },
+        { 5122, { { 4122, -211 } } }
+      };
+
+      /// Light hadrons produced in the string fragmentation
+      const std::vector<int> lightHadrons = {
+        211, -211, 211, -211, 111, 111, 321, -321, 310, 113, 213, -213, 
+        223, 221, 313, -313, 2212, -2212, 3122, -3122, 22
+      };
+
+      /// Heavy hadrons formed with a b or c quark
+      const std::vector<int> bHadrons = { -521, -511, -531, 5122 } ;
+      const std::vector<int> cHadrons = { 421, 411, 431, 4122 } ;
+
+      /// Relative abundances of the PFO types in the jets.
+      /// Overlay particles are charged pions and photons only
+      const std::vector<std::pair<int, double>> jetComposition = {
+        { 211, 22. }, { -211, 22. }, { 22, 35. }, { 2112, 9. }, { 11, 1.5 }, { -11, 1.5 },
+        { 13, 1.5 }, { -13, 1.5 }, { 321, 1.5 }, { -321, 1.5 }, { 2212, 1. }, { -2212, 1. },
+        { 310, 1.5 }, { 3122, 0.5 }
+      };
+      const std::vector<int> overlayTypes = { 211, -211, 22, 22 } ;
+
+      /// The kinematics of the synthetic reconstructed events
+      constexpr double SqrtS = 250. ;
+      constexpr double ZMass = 91.1876 ;
+      constexpr double HiggsMass = 125.1 ;
+      constexpr double BMass = 4.18 ;
+
+      /// Get a random unit vector, isotropic
+      kinematics::FourMomentum randomDirection( std::mt19937 &generator ) {
+        std::uniform_real_distribution<double> cosTheta( -1., 1. ) ;
+        std::uniform_real_distribution<double> phi( -M_PI, M_PI ) ;
+        const double c = cosTheta( generator ), s = std::sqrt( 1. - c*c ), p = phi( generator ) ;
+        return kinematics::FourMomentum{ s*std::cos( p ), s*std::sin( p ), c, 1. } ;
+      }
+
+      /// Decay a particle isotropically in two daughters of equal mass
+      std::pair<kinematics::FourMomentum, kinematics::FourMomentum> twoBodyDecay( const kinematics::FourMomentum &parent,
+        double daughterMass, std::mt19937 &generator ) {
+        const double m = parent.mass() ;
+        const double p = std::sqrt( m*m/4. - daughterMass*daughterMass ) ;
+        const auto direction = randomDirection( generator ) ;
+        kinematics::FourMomentum first{ p*direction._px, p*direction._py, p*direction._pz, m/2. } ;
+        kinematics::FourMomentum second{ -first._px, -first._py, -first._pz, m/2. } ;
+        first.boost( parent._px/parent._e, parent._py/parent._e, parent._pz/parent._e ) ;
+        second.boost( parent._px/parent._e, parent._py/parent._e, parent._pz/parent._e ) ;
+        return { first, second } ;
+      }
+
+      /// Add a particle of given type and momentum, its energy following the type mass
+      void addRecoParticle( RecoEventSample &event, int type, double px, double py, double pz, bool overlay ) {
+        const double m = kinematics::mass( type ) ;
+        RecoParticleSample particle ;
+        particle._type = type ;
+        particle._momentum = kinematics::FourMomentum{ px, py, pz, std::sqrt( px*px + py*py + pz*pz + m*m ) } ;
+        particle._overlay = overlay ;
+        event.push_back( particle ) ;
+      }
+
+      /// Fragment a b quark in a jet of PFOs: exponential momentum fractions
+      /// along the quark direction, with gaussian transverse kicks
+      void addJet( RecoEventSample &event, const kinematics::FourMomentum &quark, std::mt19937 &generator ) {
+        std::vector<double> weights ;
+        for( const auto &entry : jetComposition ) {
+          weights.push_back( entry.second ) ;
+        }
+        std::discrete_distribution<std::size_t> composition( weights.begin(), weights.end() ) ;
+        std::poisson_distribution<std::size_t> multiplicity( 23. ) ;
+        std::exponential_distribution<double> fraction( 1. ) ;
+        std::normal_distribution<double> kick( 0., 0.4 ) ;
+        const std::size_t n = 2 + multiplicity( generator ) ;
+        std::vector<double> fractions( n ) ;
+        for( auto &f : fractions ) {
+          f = fraction( generator ) ;
+        }
+        const double total = std::accumulate( fractions.begin(), fractions.end(), 0. ) ;
+        // unit axis and two unit vectors orthogonal to it
+        const double p = quark.p() ;
+        const double ax = quark._px / p, ay = quark._py / p, az = quark._pz / p ;
+        const bool alongZ = std::fabs( az ) > 0.9 ;
+        double ux = alongZ ? 1. : -ay, uy = alongZ ? 0. : ax, uz = alongZ ? -ax : 0. ;
+        const double un = std::sqrt( ux*ux + uy*uy + uz*uz ) ;
+        ux /= un ; uy /= un ; uz /= un ;
+        const double vx = ay*uz - az*uy, vy = az*ux - ax*uz, vz = ax*uy - ay*ux ;
+        for( const auto f : fractions ) {
+          const double along = p * f / total ;
+          const double ku = kick( generator ), kv = kick( generator ) ;
+          addRecoParticle( event, jetComposition[ composition( generator ) ].first,
+            along*ax + ku*ux + kv*vx, along*ay + ku*uy + kv*vy, along*az + ku*uz + kv*vz, false ) ;
+        }
+      }
+
+      /// Get the charge conjugate of a pdg id, itself if self-conjugate
+      int conjugate( int pdg ) {
+        return ( pdg::PDGIndex::NoRow != pdg::PDGIndex::instance().row( -pdg ) ) ? -pdg : pdg ;
+      }
+
+      /// Add a node to the event, with an optional parent. Returns its index
+      mc::NodeIndex addNode( MCEventSample &event, int pdg, mc::NodeFlags flags, mc::NodeIndex parent ) {
+        const auto index = static_cast<mc::NodeIndex>( event._pdgs.size() ) ;
+        event._pdgs.push_back( pdg ) ;
+        event._flags.push_back( flags ) ;
+        if( mc::NoNode != parent ) {
+          event._edges.emplace_back( parent, index ) ;
+        }
+        return index ;
+      }
+
+      /// Add a hadron to the event and decay it recursively
+      void addHadron( MCEventSample &event, int pdg, mc::NodeIndex parent, std::mt19937 &generator ) {
+        std::vector<std::pair<int, mc::NodeIndex>> stack = { { pdg, parent } } ;
+        while( not stack.empty() ) {
+          const auto entry = stack.back() ;
+          stack.pop_back() ;
+          const bool anti = ( entry.first < 0 && conjugate( entry.first ) != entry.first ) ;
+          const auto mode = decayTable.find( anti ? -entry.first : entry.first ) ;
+          if( decayTable.end() == mode ) {
+            addNode( event, entry.first, mc::node::GeneratorStable, entry.second ) ;
+            continue ;
+          }
+          const auto node = addNode( event, entry.first, mc::node::GeneratorDecayed, entry.second ) ;
+          std::uniform_int_distribution<std::size_t> choice( 0, mode->second.size()-1 ) ;
+          for( const auto daughter : mode->second[ choice( generator ) ] ) {
+            stack.emplace_back( anti ? conjugate( daughter ) : daughter, node ) ;
+          }
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::vector<int> generatePdgSample( std::size_t n, unsigned int seed ) {
+      std::mt19937 generator( seed ) ;
+      std::vector<double> weights ;
+      weights.reserve( eventComposition.size() ) ;
+      for( const auto &entry : eventComposition ) {
+        weights.push_back( entry.second ) ;
+      }
+      std::discrete_distribution<std::size_t> composition( weights.begin(), weights.end() ) ;
+      std::bernoulli_distribution antiParticle( 0.5 ) ;
+      // self-conjugate particles keep a positive id
+      auto selfConjugate = []( int pdg ) {
+        return ( pdg == 22 || pdg == 21 || pdg == 23 || pdg == 25 || pdg == 111 || pdg == 130 || pdg == 310 
+          || pdg == 221 || pdg == 113 || pdg == 223 || pdg == 331 || pdg == 333 || pdg == 443 ) ;
+      };
+      std::vector<int> sample ;
+      sample.reserve( n ) ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const int pdg = eventComposition[ composition( generator ) ].first ;
+        sample.push_back( ( not selfConjugate( pdg ) && antiParticle( generator ) ) ? -pdg : pdg ) ;
+      }
+      return sample ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::vector<int> generateUnknownPdgSample( std::size_t n, unsigned int seed ) {
+      std::mt19937 generator( seed ) ;
+      std::uniform_int_distribution<std::size_t> index( 0, unknownIds.size()-1 ) ;
+      std::vector<int> sample ;
+      sample.reserve( n ) ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        sample.push_back( unknownIds[ index( generator ) ] ) ;
+      }
+      return sample ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::vector<MCEventSample> generateMCEvents( std::size_t n, unsigned int seed ) {
+      std::mt19937 generator( seed ) ;
+      std::uniform_real_distribution<double> flavour( 0., 1. ) ;
+      std::uniform_int_distribution<std::size_t> multiplicity( 15, 35 ) ;
+      std::uniform_int_distribution<std::size_t> light( 0, lightHadrons.size()-1 ) ;
+      std::uniform_int_distribution<std::size_t> heavy( 0, bHadrons.size()-1 ) ;
+      std::vector<MCEventSample> events( n ) ;
+      for( auto &event : events ) {
+        const auto electron = addNode( event, 11, mc::node::GeneratorDocumentation, mc::NoNode ) ;
+        const auto positron = addNode( event, -11, mc::node::GeneratorDocumentation, mc::NoNode ) ;
+        const auto z = addNode( event, 23, mc::node::GeneratorDecayed, electron ) ;
+        event._edges.emplace_back( positron, z ) ;
+        const double f = flavour( generator ) ;
+        const int quark = ( f < 0.22 ) ? 5 : ( f < 0.39 ? 4 : 1 + static_cast<int>( 3 * ( f - 0.39 ) / 0.61 ) ) ;
+        const auto q = addNode( event, quark, mc::node::GeneratorDecayed, z ) ;
+        const auto qbar = addNode( event, -quark, mc::node::GeneratorDecayed, z ) ;
+        const auto string = addNode( event, 92, mc::node::GeneratorDecayed, q ) ;
+        event._edges.emplace_back( qbar, string ) ;
+        if( quark >= 4 ) {
+          const auto &hadrons = ( 5 == quark ) ? bHadrons : cHadrons ;
+          addHadron( event, hadrons[ heavy( generator ) ], string, generator ) ;
+          addHadron( event, conjugate( hadrons[ heavy( generator ) ] ), string, generator ) ;
+        }
+        const auto nlight = multiplicity( generator ) ;
+        for( std::size_t i=0 ; i<nlight ; ++i ) {
+          addHadron( event, lightHadrons[ light( generator ) ], string, generator ) ;
+        }
+      }
+      return events ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::vector<RecoEventSample> generateRecoEvents( std::size_t n, std::size_t nOverlay, unsigned int seed ) {
+      std::mt19937 generator( seed ) ;
+      std::exponential_distribution<double> overlayPt( 1. / 0.4 ) ;
+      std::uniform_real_distribution<double> overlayEta( -3., 3. ) ;
+      std::uniform_real_distribution<double> overlayPhi( -M_PI, M_PI ) ;
+      std::uniform_int_distribution<std::size_t> overlayType( 0, overlayTypes.size()-1 ) ;
+      const double s = SqrtS*SqrtS ;
+      const double pZ = std::sqrt( ( s - std::pow( ZMass + HiggsMass, 2 ) ) * ( s - std::pow( ZMass - HiggsMass, 2 ) ) ) / ( 2. * SqrtS ) ;
+      const double muonMass = kinematics::mass( 13 ) ;
+      std::vector<RecoEventSample> events( n ) ;
+      for( auto &event : events ) {
+        const auto direction = randomDirection( generator ) ;
+        const kinematics::FourMomentum z{ pZ*direction._px, pZ*direction._py, pZ*direction._pz, std::sqrt( pZ*pZ + ZMass*ZMass ) } ;
+        const kinematics::FourMomentum higgs{ -z._px, -z._py, -z._pz, SqrtS - z._e } ;
+        const auto muons = twoBodyDecay( z, muonMass, generator ) ;
+        addRecoParticle( event, 13, muons.first._px, muons.first._py, muons.first._pz, false ) ;
+        addRecoParticle( event, -13, muons.second._px, muons.second._py, muons.second._pz, false ) ;
+        const auto quarks = twoBodyDecay( higgs, BMass, generator ) ;
+        addJet( event, quarks.first, generator ) ;
+        addJet( event, quarks.second, generator ) ;
+        for( std::size_t i=0 ; i<nOverlay ; ++i ) {
+          const double pt = overlayPt( generator ), eta = overlayEta( generator ), phi = overlayPhi( generator ) ;
+          addRecoParticle( event, overlayTypes[ overlayType( generator ) ], pt*std::cos( phi ), pt*std::sin( phi ), pt*std::sinh( eta ), true ) ;
+        }
+        std::shuffle( event.begin(), event.end(), generator ) ;
+      }
+      return events ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::vector<CalorimeterHitSample> generateCalorimeterHits( std::size_t n, std::size_t nHits, unsigned int seed ) {
+      // the fields, as (offset, width) of the encoding
+      const auto encode = []( uint64_t &cellID, unsigned int offset, unsigned int width, long value ) {
+        cellID |= ( static_cast<uint64_t>( value ) & ( ( uint64_t(1) << width ) - 1 ) ) << offset ;
+      } ;
+      std::mt19937 generator( seed ) ;
+      std::uniform_int_distribution<int> endcap( 0, 3 ) ;
+      std::uniform_int_distribution<int> side( -1, 1 ) ;
+      std::uniform_int_distribution<int> module( 0, 4 ) ;
+      std::uniform_int_distribution<int> stave( 0, 7 ) ;
+      std::exponential_distribution<double> depth( 1. / 8. ) ;
+      std::uniform_int_distribution<int> cell( -400, 400 ) ;
+      std::exponential_distribution<double> energy( 1. / 0.005 ) ;
+      std::vector<CalorimeterHitSample> collections( n ) ;
+      for( auto &collection : collections ) {
+        collection._encoding = "system:5,side:-2,module:8,stave:4,layer:9,submodule:4,x:32:-16,y:-16" ;
+        collection._cellIDs.resize( nHits ) ;
+        collection._energies.resize( nHits ) ;
+        for( std::size_t i=0 ; i<nHits ; ++i ) {
+          // one hit out of 4 in the endcaps (system 29), the others in the barrel (system 20)
+          const bool isEndcap = ( 0 == endcap( generator ) ) ;
+          const long layer = std::min( static_cast<long>( depth( generator ) ), 29L ) ;
+          uint64_t cellID = 0 ;
+          encode( cellID, 0, 5, isEndcap ? 29 : 20 ) ;
+          encode( cellID, 5, 2, isEndcap ? ( side( generator ) < 0 ? -1 : 1 ) : 0 ) ;
+          encode( cellID, 7, 8, module( generator ) ) ;
+          encode( cellID, 15, 4, stave( generator ) ) ;
+          encode( cellID, 19, 9, layer ) ;
+          encode( cellID, 32, 16, cell( generator ) ) ;
+          encode( cellID, 48, 16, cell( generator ) ) ;
+          collection._cellIDs[i] = cellID ;
+          collection._energies[i] = energy( generator ) * std::exp( -layer / 15. ) ;
+        }
+      }
+      return collections ;
+    }
+
+  }
+
+}
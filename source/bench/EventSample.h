@@ -0,0 +1,92 @@
+
+#ifndef _LCANALYSISTOOLS_EVENTSAMPLE_H
+#define _LCANALYSISTOOLS_EVENTSAMPLE_H
+
+// -- std headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/DecayTree.h>
+#include <LCAnalysisTools/Kinematics.h>
+
+namespace lc_analysis {
+
+  namespace bench {
+
+    /// Generate a sample of pdg ids following the particle composition 
+    /// of a typical e+e- -> qq / ZH Monte-Carlo event at 250 GeV, including
+    /// the generator history (partons, resonances and decayed hadrons).
+    /// Ids found in the PDG table only are generated.
+    std::vector<int> generatePdgSample( std::size_t n, unsigned int seed = 42 ) ;
+
+    /// Generate a sample of generator specific pdg ids typically found
+    /// in the MC history of e+e- events (strings, clusters, ...).
+    /// These ids are not part of the PDG table
+    std::vector<int> generateUnknownPdgSample( std::size_t n, unsigned int seed = 42 ) ;
+
+    /**
+     *  @brief  MCEventSample struct
+     *
+     *  Synthetic MC history of an event, in the input format of DecayTree::build()
+     */
+    struct MCEventSample {
+      std::vector<int>                     _pdgs {} ;
+      std::vector<mc::NodeFlags>           _flags {} ;
+      std::vector<mc::DecayTree::Edge>     _edges {} ;
+    };
+
+    /// Generate synthetic MC histories of e+e- -> Z -> qq events: the beam 
+    /// leptons, the Z, the quarks, a string and its hadrons, decayed with 
+    /// a small decay table (heavy hadrons to charm and strange hadrons, 
+    /// resonances, pi0, K0S...). About 22% b and 17% c events
+    std::vector<MCEventSample> generateMCEvents( std::size_t n, unsigned int seed = 42 ) ;
+
+    /**
+     *  @brief  RecoParticleSample struct
+     *
+     *  Synthetic reconstructed particle, one object per particle as in LCIO
+     */
+    struct RecoParticleSample {
+      /// The PFO type (pdg-like)
+      int                                  _type {0} ;
+      /// The four-momentum, in GeV
+      kinematics::FourMomentum             _momentum {} ;
+      /// Whether the particle comes from the beam induced background overlay
+      bool                                 _overlay {false} ;
+    };
+
+    /// A synthetic reconstructed event
+    using RecoEventSample = std::vector<RecoParticleSample> ;
+
+    /// Generate synthetic reconstructed e+e- -> ZH -> mu+mu- bb events at 250 GeV:
+    /// two isolated muons, two b jets of about 25 PFOs each (charged hadrons,
+    /// photons, neutral hadrons, a few leptons) and nOverlay low pT particles
+    /// from the gamma gamma -> hadrons overlay, in random order. The PFO
+    /// energies follow the PDG table mass of their type
+    std::vector<RecoEventSample> generateRecoEvents( std::size_t n, std::size_t nOverlay = 0, unsigned int seed = 42 ) ;
+
+    /**
+     *  @brief  CalorimeterHitSample struct
+     *
+     *  Synthetic calorimeter hit collection: its cell id encoding, and the
+     *  64 bits cell ids and energies of its hits
+     */
+    struct CalorimeterHitSample {
+      std::string                          _encoding {} ;
+      std::vector<uint64_t>                _cellIDs {} ;
+      std::vector<double>                  _energies {} ;
+    };
+
+    /// Generate synthetic ECal hit collections of nHits hits each, with the
+    /// ILD / CLIC encoding "system:5,side:-2,module:8,stave:4,layer:9,submodule:4,x:32:-16,y:-16":
+    /// barrel and endcap hits in 30 layers, with energies decreasing with the layer
+    std::vector<CalorimeterHitSample> generateCalorimeterHits( std::size_t n, std::size_t nHits, unsigned int seed = 42 ) ;
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,349 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Ancestry.h>
+#include <LCAnalysisTools/CommonAncestor.h>
+#include <LCAnalysisTools/DecayCensus.h>
+#include <LCAnalysisTools/DecayPattern.h>
+#include <LCAnalysisTools/DecayTree.h>
+#include <LCAnalysisTools/PDGHelper.h>
+#include <LCAnalysisTools/TruthLinks.h>
+#include "BenchmarkHarness.h"
+#include "EventSample.h"
+
+// -- std headers
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace lc_analysis ;
+
+namespace {
+
+  /// Number of synthetic events, cycled over
+  constexpr std::size_t NEvents = 1000 ;
+
+  /// The decay chain searched in the pattern benchmarks
+  const std::string BenchPattern = "[B0 -> (D- -> K+ pi- pi-) pi+]cc" ;
+
+  /// Naive heavy flavour tagging: walk up the first parents of every
+  /// final state particle, looking up each ancestor in the PDG table
+  std::size_t naiveHeavyFlavourCount( const mc::DecayTree &tree ) {
+    std::size_t count = 0 ;
+    for( mc::NodeIndex n=0 ; n<tree.size() ; ++n ) {
+      if( not ( tree.flags( n ) & mc::node::GeneratorStable ) ) {
+        continue ;
+      }
+      for( auto parent = tree.firstParent( n ) ; mc::NoNode != parent ; parent = tree.firstParent( parent ) ) {
+        const auto pdg = tree.pdg( parent ) ;
+        if( not tree.particle( parent ).valid() ) {
+          continue ;
+        }
+        const auto &particle = pdg::PDGHelper::particle( pdg ) ;
+        if( pdg::PDGHelper::isHadron( particle ) && pdg::PDGHelper::hasQuark<pdg::Quark::b>( particle ) ) {
+          ++count ;
+          break ;
+        }
+      }
+    }
+    return count ;
+  }
+
+  /// Whether the daughters of a node have exactly the given names, in any order
+  bool hasDaughterNames( const mc::DecayTree &tree, mc::NodeIndex n, std::vector<std::string> names ) {
+    const auto daughters = tree.daughters( n ) ;
+    if( daughters.size() != names.size() ) {
+      return false ;
+    }
+    for( const auto daughter : daughters ) {
+      if( not tree.particle( daughter ).valid() ) {
+        return false ;
+      }
+      auto iter = std::find( names.begin(), names.end(), pdg::PDGHelper::particle( tree.pdg( daughter ) ).name() ) ;
+      if( names.end() == iter ) {
+        return false ;
+      }
+      names.erase( iter ) ;
+    }
+    return true ;
+  }
+
+  /// Hand-written search of BenchPattern, with PDG table lookups
+  /// and nested loops over the daughters as in analysis code
+  std::size_t naivePatternCount( const mc::DecayTree &tree ) {
+    std::size_t count = 0 ;
+    for( mc::NodeIndex n=0 ; n<tree.size() ; ++n ) {
+      if( not tree.particle( n ).valid() ) {
+        continue ;
+      }
+      const auto &name = pdg::PDGHelper::particle( tree.pdg( n ) ).name() ;
+      const bool anti = ( "B~0" == name ) ;
+      if( not anti && "B0" != name ) {
+        continue ;
+      }
+      const auto daughters = tree.daughters( n ) ;
+      if( 2 != daughters.size() ) {
+        continue ;
+      }
+      for( std::size_t d=0 ; d<2 ; ++d ) {
+        const auto dmeson = daughters[d] ;
+        const auto pion = daughters[1-d] ;
+        if( not tree.particle( dmeson ).valid() || not tree.particle( pion ).valid() ) {
+          continue ;
+        }
+        if( pdg::PDGHelper::particle( tree.pdg( dmeson ) ).name() == ( anti ? "D+" : "D-" )
+          && pdg::PDGHelper::particle( tree.pdg( pion ) ).name() == ( anti ? "pi-" : "pi+" )
+          && hasDaughterNames( tree, dmeson, anti ? std::vector<std::string>{ "K-", "pi+", "pi+" } : std::vector<std::string>{ "K+", "pi-", "pi-" } ) ) {
+          ++count ;
+          break ;
+        }
+      }
+    }
+    return count ;
+  }
+
+  /// Get the generator stable charged particles of a tree
+  std::vector<mc::NodeIndex> chargedFinalState( const mc::DecayTree &tree ) {
+    std::vector<mc::NodeIndex> nodes ;
+    for( mc::NodeIndex n=0 ; n<tree.size() ; ++n ) {
+      if( ( tree.flags( n ) & mc::node::GeneratorStable ) && ( tree.categories( n ) & pdg::category::Charged ) ) {
+        nodes.push_back( n ) ;
+      }
+    }
+    return nodes ;
+  }
+
+  /// Naive lowest common ancestor: walk both first parent ancestries and intersect them
+  mc::NodeIndex naiveCommonAncestor( const mc::DecayTree &tree, mc::NodeIndex u, mc::NodeIndex v ) {
+    std::vector<mc::NodeIndex> ancestors ;
+    for( auto n = u ; mc::NoNode != n ; n = tree.firstParent( n ) ) {
+      ancestors.push_back( n ) ;
+    }
+    for( auto n = v ; mc::NoNode != n ; n = tree.firstParent( n ) ) {
+      if( ancestors.end() != std::find( ancestors.begin(), ancestors.end(), n ) ) {
+        return n ;
+      }
+    }
+    return mc::NoNode ;
+  }
+
+  /// Synthetic reco to MC links of an event: one reco object per visible final state
+  /// particle, linked to it, and sometimes to a second particle with a lower weight
+  struct EventLinks {
+    std::size_t                         _nreco {0} ;
+    std::vector<mc::TruthLinkIndex::Link> _links {} ;
+  };
+
+  EventLinks generateLinks( const mc::DecayTree &tree, std::mt19937 &generator ) {
+    EventLinks event ;
+    std::vector<mc::NodeIndex> visible ;
+    for( mc::NodeIndex n=0 ; n<tree.size() ; ++n ) {
+      const auto categories = tree.categories( n ) ;
+      const bool neutrino = ( categories & pdg::category::Lepton ) && not ( categories & pdg::category::Charged ) ;
+      if( ( tree.flags( n ) & mc::node::GeneratorStable ) && not neutrino ) {
+        visible.push_back( n ) ;
+      }
+    }
+    std::bernoulli_distribution shared( 0.3 ) ;
+    std::uniform_real_distribution<float> weight( 0.6f, 1.f ) ;
+    std::uniform_int_distribution<std::size_t> other( 0, visible.empty() ? 0 : visible.size()-1 ) ;
+    for( std::size_t r=0 ; r<visible.size() ; ++r ) {
+      const auto w = weight( generator ) ;
+      event._links.push_back( { static_cast<mc::ObjectIndex>( r ), visible[r], w } ) ;
+      if( shared( generator ) ) {
+        event._links.push_back( { static_cast<mc::ObjectIndex>( r ), visible[ other( generator ) ], 1.f - w } ) ;
+      }
+    }
+    event._nreco = visible.size() ;
+    return event ;
+  }
+
+  /// Navigator-like truth matching: maps of link lists in both directions,
+  /// rebuilt for each event, then the best MC match of each reco object
+  std::size_t mapTruthMatch( const EventLinks &event ) {
+    using Links = std::vector<std::pair<mc::ObjectIndex, float>> ;
+    std::map<mc::ObjectIndex, Links> recoToMC, mcToReco ;
+    for( const auto &link : event._links ) {
+      recoToMC[link._reco].emplace_back( link._mc, link._weight ) ;
+      mcToReco[link._mc].emplace_back( link._reco, link._weight ) ;
+    }
+    std::size_t count = 0 ;
+    for( std::size_t r=0 ; r<event._nreco ; ++r ) {
+      auto iter = recoToMC.find( static_cast<mc::ObjectIndex>( r ) ) ;
+      if( recoToMC.end() == iter ) {
+        continue ;
+      }
+      const auto best = std::max_element( iter->second.begin(), iter->second.end(), []( const auto &lhs, const auto &rhs ) {
+        return lhs.second < rhs.second ;
+      }) ;
+      count += best->first ;
+    }
+    return count + mcToReco.size() ;
+  }
+
+  /// String based decay census, as in validation scripts: each decay is
+  /// keyed by its parent and sorted daughter names
+  void stringCensus( const mc::DecayTree &tree, std::unordered_map<std::string, uint64_t> &counts ) {
+    std::vector<std::string> names ;
+    for( mc::NodeIndex n=0 ; n<tree.size() ; ++n ) {
+      if( ( tree.flags( n ) & ( mc::node::Leaf | mc::node::UnknownParticle ) ) ) {
+        continue ;
+      }
+      names.clear() ;
+      for( const auto daughter : tree.daughters( n ) ) {
+        names.push_back( tree.particle( daughter ).valid() ? pdg::PDGHelper::particle( tree.pdg( daughter ) ).name() : std::to_string( tree.pdg( daughter ) ) ) ;
+      }
+      std::sort( names.begin(), names.end() ) ;
+      std::string key = pdg::PDGHelper::particle( tree.pdg( n ) ).name() + " ->" ;
+      for( const auto &name : names ) {
+        key += " " + name ;
+      }
+      ++counts[key] ;
+    }
+  }
+}
+
+int main( int argc, char **argv ) {
+  try {
+    bench::BenchmarkHarness harness( "MCTruth", argc, argv ) ;
+    const auto events = bench::generateMCEvents( NEvents ) ;
+    std::vector<mc::DecayTree> trees( events.size() ) ;
+    for( std::size_t e=0 ; e<events.size() ; ++e ) {
+      trees[e].build( events[e]._pdgs, events[e]._flags, events[e]._edges ) ;
+    }
+    // one operation is one event in all cases
+    harness.add( "decaytree/build", [&events]( std::size_t n ) {
+      mc::DecayTree tree ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const auto &event = events[ i % events.size() ] ;
+        tree.build( event._pdgs, event._flags, event._edges ) ;
+        bench::doNotOptimize( tree.size() ) ;
+      }
+    }) ;
+    harness.add( "ancestry/naive", [&trees]( std::size_t n ) {
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        bench::doNotOptimize( naiveHeavyFlavourCount( trees[ i % trees.size() ] ) ) ;
+      }
+    }) ;
+    harness.add( "ancestry/memoized", [&trees]( std::size_t n ) {
+      mc::HeavyFlavourAncestry ancestry ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const auto &tree = trees[ i % trees.size() ] ;
+        ancestry.build( tree ) ;
+        std::size_t count = 0 ;
+        for( mc::NodeIndex node=0 ; node<tree.size() ; ++node ) {
+          if( ( tree.flags( node ) & mc::node::GeneratorStable ) && 5 == ancestry.flavour( node ) ) {
+            ++count ;
+          }
+        }
+        bench::doNotOptimize( count ) ;
+      }
+    }) ;
+    const mc::DecayPattern pattern( BenchPattern ) ;
+    std::size_t nmatches = 0 ;
+    std::vector<mc::NodeIndex> matchesCheck ;
+    for( const auto &tree : trees ) {
+      const auto nnaive = naivePatternCount( tree ) ;
+      const auto ncompiled = pattern.match( tree, matchesCheck ) ;
+      if( nnaive != ncompiled ) {
+        throw std::runtime_error( "Pattern match count mismatch for " + BenchPattern ) ;
+      }
+      nmatches += ncompiled ;
+    }
+    std::cout << BenchPattern << ": " << nmatches << " matches in " << trees.size() << " events" << std::endl ;
+    harness.add( "pattern/naive", [&trees]( std::size_t n ) {
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        bench::doNotOptimize( naivePatternCount( trees[ i % trees.size() ] ) ) ;
+      }
+    }) ;
+    harness.add( "pattern/compiled", [&trees, &pattern]( std::size_t n ) {
+      std::vector<mc::NodeIndex> matches ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        matches.clear() ;
+        bench::doNotOptimize( pattern.match( trees[ i % trees.size() ], matches ) ) ;
+      }
+    }) ;
+    std::vector<std::vector<mc::NodeIndex>> finalStates ;
+    for( const auto &tree : trees ) {
+      finalStates.push_back( chargedFinalState( tree ) ) ;
+    }
+    // one operation is the common ancestors of all pairs of charged final state particles of an event
+    harness.add( "lca/naive", [&trees, &finalStates]( std::size_t n ) {
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const auto &tree = trees[ i % trees.size() ] ;
+        const auto &nodes = finalStates[ i % trees.size() ] ;
+        std::size_t count = 0 ;
+        for( std::size_t a=0 ; a<nodes.size() ; ++a ) {
+          for( std::size_t b=a+1 ; b<nodes.size() ; ++b ) {
+            count += naiveCommonAncestor( tree, nodes[a], nodes[b] ) ;
+          }
+        }
+        bench::doNotOptimize( count ) ;
+      }
+    }) ;
+    harness.add( "lca/indexed", [&trees, &finalStates]( std::size_t n ) {
+      mc::CommonAncestorIndex index ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const auto &nodes = finalStates[ i % trees.size() ] ;
+        index.build( trees[ i % trees.size() ] ) ;
+        std::size_t count = 0 ;
+        for( std::size_t a=0 ; a<nodes.size() ; ++a ) {
+          for( std::size_t b=a+1 ; b<nodes.size() ; ++b ) {
+            count += index.lca( nodes[a], nodes[b] ) ;
+          }
+        }
+        bench::doNotOptimize( count ) ;
+      }
+    }) ;
+    std::mt19937 generator( 42 ) ;
+    std::vector<EventLinks> eventLinks ;
+    for( const auto &tree : trees ) {
+      eventLinks.push_back( generateLinks( tree, generator ) ) ;
+    }
+    // one operation is building the links of an event and the best MC match of each reco object
+    harness.add( "truthlink/map", [&eventLinks]( std::size_t n ) {
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        bench::doNotOptimize( mapTruthMatch( eventLinks[ i % eventLinks.size() ] ) ) ;
+      }
+    }) ;
+    harness.add( "truthlink/index", [&trees, &eventLinks]( std::size_t n ) {
+      mc::TruthLinkIndex index ;
+      std::vector<pdg::Categories> categories ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const auto &event = eventLinks[ i % eventLinks.size() ] ;
+        const auto &tree = trees[ i % trees.size() ] ;
+        index.build( event._nreco, tree.size(), event._links ) ;
+        std::size_t count = 0 ;
+        for( mc::ObjectIndex r=0 ; r<event._nreco ; ++r ) {
+          count += index.bestMC( r ) ;
+        }
+        index.truthCategories( tree, categories ) ;
+        bench::doNotOptimize( count ) ;
+        bench::doNotOptimize( categories.data() ) ;
+      }
+    }) ;
+    harness.add( "census/strings", [&trees]( std::size_t n ) {
+      std::unordered_map<std::string, uint64_t> counts ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        stringCensus( trees[ i % trees.size() ], counts ) ;
+      }
+      bench::doNotOptimize( counts.size() ) ;
+    }) ;
+    harness.add( "census/hashconsed", [&trees]( std::size_t n ) {
+      mc::DecayCensus::Shard shard ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        shard.add( trees[ i % trees.size() ] ) ;
+      }
+      bench::doNotOptimize( shard.modes().size() ) ;
+    }) ;
+    return harness.run() ;
+  }
+  catch( const std::exception &e ) {
+    std::cerr << "Benchmark failed: " << e.what() << std::endl ;
+    return 1 ;
+  }
+}
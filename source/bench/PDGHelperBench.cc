@@ -0,0 +1,181 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/PDGHelper.h>
+#include <LCAnalysisTools/PFOClassification.h>
+#include "BenchmarkHarness.h"
+#include "EventSample.h"
+
+// -- std headers
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+using namespace lc_analysis ;
+using namespace lc_analysis::pdg ;
+
+namespace {
+
+  /// Number of pdg ids in the benchmark samples
+  constexpr std::size_t SampleSize = 1 << 14 ;
+
+  /// Register a benchmark case for a PDGHelper predicate.
+  /// One operation is one predicate call
+  template <typename Predicate>
+  void addPredicate( bench::BenchmarkHarness &harness, const std::string &name,
+    const std::vector<const ParticleData*> &particles, Predicate predicate ) {
+    harness.add( "predicate/" + name, [&particles, predicate]( std::size_t n ) {
+      std::size_t count = 0 ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        count += predicate( *particles[ i % particles.size() ] ) ? 1 : 0 ;
+      }
+      bench::doNotOptimize( count ) ;
+    }) ;
+  }
+
+  /// Number of PFOs per event in the PFO classification benchmarks
+  constexpr std::size_t PFOsPerEvent = 100 ;
+
+  /// Generate PFO type codes with the composition of a Pandora PFO
+  /// collection: charged pions, photons, neutral hadrons, leptons
+  std::vector<int> generatePFOTypes( std::size_t n ) {
+    const std::vector<int> types = { 211, -211, 22, 2112, 11, -11, 13, -13, 321, -321, 2212, -2212, 310, 3122 } ;
+    const std::vector<double> weights = { 22., 22., 35., 9., 1.5, 1.5, 1.5, 1.5, 1.5, 1.5, 1., 1., 1.5, 0.5 } ;
+    std::mt19937 generator( 42 ) ;
+    std::discrete_distribution<std::size_t> type( weights.begin(), weights.end() ) ;
+    std::vector<int> sample( n ) ;
+    for( auto &t : sample ) {
+      t = types[ type( generator ) ] ;
+    }
+    return sample ;
+  }
+
+  /// Register a benchmark case for particle lookups.
+  /// One operation is one lookup
+  void addLookup( bench::BenchmarkHarness &harness, const std::string &name, const std::vector<int> &pdgs ) {
+    harness.add( "particle/" + name, [&pdgs]( std::size_t n ) {
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        bench::doNotOptimize( &PDGHelper::particle( pdgs[ i % pdgs.size() ] ) ) ;
+      }
+    }) ;
+  }
+}
+
+int main( int argc, char **argv ) {
+  try {
+    bench::BenchmarkHarness harness( "PDGHelper", argc, argv ) ;
+    // realistic event composition
+    const auto eventPdgs = bench::generatePdgSample( SampleSize ) ;
+    // generator specific ids, missing in the table
+    const auto unknownPdgs = bench::generateUnknownPdgSample( SampleSize ) ;
+    // the same id over and over
+    const std::vector<int> hotPdgs( SampleSize, 22 ) ;
+    // ids uniformly spread over the whole table
+    std::vector<int> coldPdgs ;
+    coldPdgs.reserve( SampleSize ) ;
+    std::mt19937 generator( 42 ) ;
+    std::uniform_int_distribution<std::size_t> row( 0, pdgTable.size()-1 ) ;
+    for( std::size_t i=0 ; i<SampleSize ; ++i ) {
+      coldPdgs.push_back( pdgTable[ row( generator ) ].pdg() ) ;
+    }
+    // particles for the predicates
+    std::vector<const ParticleData*> particles ;
+    particles.reserve( SampleSize ) ;
+    for( const auto pdg : eventPdgs ) {
+      particles.push_back( &PDGHelper::particle( pdg ) ) ;
+    }
+
+    addLookup( harness, "hit", eventPdgs ) ;
+    addLookup( harness, "hot", hotPdgs ) ;
+    addLookup( harness, "cold", coldPdgs ) ;
+    harness.add( "particle/miss", [&unknownPdgs]( std::size_t n ) {
+      std::size_t misses = 0 ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        try {
+          bench::doNotOptimize( &PDGHelper::particle( unknownPdgs[ i % unknownPdgs.size() ] ) ) ;
+        }
+        catch( const std::runtime_error & ) {
+          ++misses ;
+        }
+      }
+      bench::doNotOptimize( misses ) ;
+    }) ;
+
+    addPredicate( harness, "isQuark", particles, PDGHelper::isQuark ) ;
+    addPredicate( harness, "isLepton", particles, PDGHelper::isLepton ) ;
+    addPredicate( harness, "isHadron", particles, PDGHelper::isHadron ) ;
+    addPredicate( harness, "isMeson", particles, PDGHelper::isMeson ) ;
+    addPredicate( harness, "isBaryon", particles, PDGHelper::isBaryon ) ;
+    addPredicate( harness, "isDiQuark", particles, PDGHelper::isDiQuark ) ;
+    addPredicate( harness, "isNucleus", particles, PDGHelper::isNucleus ) ;
+    addPredicate( harness, "isPentaQuark", particles, PDGHelper::isPentaQuark ) ;
+    addPredicate( harness, "isGaugeBosonOrHiggs", particles, PDGHelper::isGaugeBosonOrHiggs ) ;
+    addPredicate( harness, "isSMGaugeBosonOrHiggs", particles, PDGHelper::isSMGaugeBosonOrHiggs ) ;
+    addPredicate( harness, "isGeneratorSpecific", particles, PDGHelper::isGeneratorSpecific ) ;
+    addPredicate( harness, "isSpecialParticle", particles, PDGHelper::isSpecialParticle ) ;
+    addPredicate( harness, "isRHadron", particles, PDGHelper::isRHadron ) ;
+    addPredicate( harness, "isQBall", particles, PDGHelper::isQBall ) ;
+    addPredicate( harness, "isDyon", particles, PDGHelper::isDyon ) ;
+    addPredicate( harness, "isSUSY", particles, PDGHelper::isSUSY ) ;
+    addPredicate( harness, "isTechnicolor", particles, PDGHelper::isTechnicolor ) ;
+    addPredicate( harness, "isCompositeQuarkOrLepton", particles, PDGHelper::isCompositeQuarkOrLepton ) ;
+    addPredicate( harness, "hasFundamentalAnti", particles, PDGHelper::hasFundamentalAnti ) ;
+    addPredicate( harness, "hasQuark<u>", particles, PDGHelper::hasQuark<Quark::u> ) ;
+    addPredicate( harness, "hasQuark<d>", particles, PDGHelper::hasQuark<Quark::d> ) ;
+    addPredicate( harness, "hasQuark<s>", particles, PDGHelper::hasQuark<Quark::s> ) ;
+    addPredicate( harness, "hasQuark<c>", particles, PDGHelper::hasQuark<Quark::c> ) ;
+    addPredicate( harness, "hasQuark<b>", particles, PDGHelper::hasQuark<Quark::b> ) ;
+    addPredicate( harness, "hasQuark<t>", particles, PDGHelper::hasQuark<Quark::t> ) ;
+
+    std::vector<int16_t> charges( eventPdgs.size() ) ;
+    harness.add( "threeCharge/batch", [&eventPdgs, &charges]( std::size_t n ) {
+      for( std::size_t done=0 ; done<n ; ) {
+        const auto count = std::min( n-done, eventPdgs.size() ) ;
+        PDGHelper::threeCharge( eventPdgs.data(), charges.data(), count ) ;
+        bench::doNotOptimize( charges.data() ) ;
+        done += count ;
+      }
+    }) ;
+
+    std::vector<Categories> categories( eventPdgs.size() ) ;
+    harness.add( "categories/batch", [&eventPdgs, &categories]( std::size_t n ) {
+      for( std::size_t done=0 ; done<n ; ) {
+        const auto count = std::min( n-done, eventPdgs.size() ) ;
+        PDGHelper::categories( eventPdgs.data(), categories.data(), count ) ;
+        bench::doNotOptimize( categories.data() ) ;
+        done += count ;
+      }
+    }) ;
+
+    // one operation is one PFO
+    const auto pfoTypes = generatePFOTypes( SampleSize ) ;
+    harness.add( "pfo/naive", [&pfoTypes]( std::size_t n ) {
+      std::size_t chargedHadrons = 0 ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const auto &particle = PDGHelper::particle( pfoTypes[ i % pfoTypes.size() ] ) ;
+        chargedHadrons += ( PDGHelper::isHadron( particle ) && 0 != particle.threeCharge() ) ? 1 : 0 ;
+      }
+      bench::doNotOptimize( chargedHadrons ) ;
+    }) ;
+    harness.add( "pfo/batch", [&pfoTypes]( std::size_t n ) {
+      reco::PFOClassification classification ;
+      std::vector<int> event ;
+      std::size_t chargedHadrons = 0 ;
+      for( std::size_t done=0 ; done<n ; ) {
+        const auto count = std::min( n-done, PFOsPerEvent ) ;
+        const auto first = done % ( pfoTypes.size() - PFOsPerEvent ) ;
+        event.assign( pfoTypes.begin() + first, pfoTypes.begin() + first + count ) ;
+        classification.classify( event ) ;
+        chargedHadrons += classification.count( reco::pfo::ChargedHadronBit ) ;
+        done += count ;
+      }
+      bench::doNotOptimize( chargedHadrons ) ;
+    }) ;
+
+    return harness.run() ;
+  }
+  catch( const std::exception &e ) {
+    std::cerr << "Benchmark failed: " << e.what() << std::endl ;
+    return 1 ;
+  }
+}
@@ -0,0 +1,152 @@
+
+// -- LCAnalysisTools headers
+#include "PerfCounters.h"
+
+// -- std headers
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+// -- linux headers
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace lc_analysis {
+
+  namespace bench {
+
+#ifdef __linux__
+
+    namespace {
+
+      /// Open a single counter for the calling thread and the threads it
+      /// creates afterwards, on any cpu. Returns -1 on failure and errno is set
+      int openCounter( uint32_t type, uint64_t config ) {
+        perf_event_attr attr ;
+        std::memset( &attr, 0, sizeof(attr) ) ;
+        attr.size = sizeof(attr) ;
+        attr.type = type ;
+        attr.config = config ;
+        attr.disabled = 1 ;
+        attr.exclude_kernel = 1 ;
+        attr.exclude_hv = 1 ;
+        attr.inherit = 1 ;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING ;
+        return static_cast<int>( ::syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 ) ) ;
+      }
+
+      /// Cache event configuration
+      constexpr uint64_t cacheConfig( uint64_t cache, uint64_t op, uint64_t result ) {
+        return cache | ( op << 8 ) | ( result << 16 ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    PerfCounters::PerfCounters() {
+      const struct {
+        const char  *_name ;
+        uint32_t     _type ;
+        uint64_t     _config ;
+      } events[] = {
+        { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { "l1d_misses", PERF_TYPE_HW_CACHE, cacheConfig( PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS ) },
+        { "llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { "branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+      };
+      for( const auto &event : events ) {
+        const int fd = openCounter( event._type, event._config ) ;
+        if( fd < 0 ) {
+          if( _unavailableReason.empty() ) {
+            _unavailableReason = std::string( event._name ) + ": " + std::strerror( errno ) ;
+          }
+          continue ;
+        }
+        _counters.push_back( { event._name, fd } ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    PerfCounters::~PerfCounters() {
+      for( const auto &counter : _counters ) {
+        ::close( counter._fd ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void PerfCounters::start() {
+      for( const auto &counter : _counters ) {
+        ::ioctl( counter._fd, PERF_EVENT_IOC_RESET, 0 ) ;
+        ::ioctl( counter._fd, PERF_EVENT_IOC_ENABLE, 0 ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::vector<PerfCounters::Reading> PerfCounters::stop() {
+      for( const auto &counter : _counters ) {
+        ::ioctl( counter._fd, PERF_EVENT_IOC_DISABLE, 0 ) ;
+      }
+      std::vector<Reading> readings ;
+      readings.reserve( _counters.size() ) ;
+      for( const auto &counter : _counters ) {
+        // value, time enabled, time running
+        uint64_t values[3] = {0, 0, 0} ;
+        if( ::read( counter._fd, values, sizeof(values) ) != sizeof(values) || values[2] == 0 ) {
+          continue ;
+        }
+        // scale up if the counter was multiplexed
+        const double scale = static_cast<double>( values[1] ) / values[2] ;
+        readings.push_back( { counter._name, values[0] * scale } ) ;
+      }
+      return readings ;
+    }
+
+#else
+
+    PerfCounters::PerfCounters() :
+      _unavailableReason( "perf_event_open is only available on Linux" ) {
+      /* nop */
+    }
+
+    //----------------------------------------------------------------------------
+
+    PerfCounters::~PerfCounters() {
+      /* nop */
+    }
+
+    //----------------------------------------------------------------------------
+
+    void PerfCounters::start() {
+      /* nop */
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::vector<PerfCounters::Reading> PerfCounters::stop() {
+      return {} ;
+    }
+
+#endif
+
+    //----------------------------------------------------------------------------
+
+    bool PerfCounters::available() const {
+      return not _counters.empty() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    const std::string &PerfCounters::unavailableReason() const {
+      return _unavailableReason ;
+    }
+
+  }
+
+}
@@ -0,0 +1,74 @@
+
+#ifndef _LCANALYSISTOOLS_PERFCOUNTERS_H
+#define _LCANALYSISTOOLS_PERFCOUNTERS_H
+
+// -- std headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lc_analysis {
+
+  namespace bench {
+
+    /**
+     *  @brief  PerfCounters class
+     *
+     *  Reads hardware performance counters of the calling thread 
+     *  using perf_event_open (Linux only): cycles, instructions,
+     *  L1 data cache read misses, last level cache misses and 
+     *  branch misses. The counters are inherited by the threads created
+     *  after the constructor, so they must be opened before any worker
+     *  thread is started. Each counter is opened independently, so that 
+     *  counters not supported by the host (typically in containers or 
+     *  virtual machines) are simply skipped. Counter values are scaled
+     *  when the kernel multiplexes them.
+     */
+    class PerfCounters {
+    public:
+      /// A counter reading
+      struct Reading {
+        std::string              _name {} ;
+        double                   _value {0.} ;
+      };
+
+    public:
+      /// Constructor. Opens the available counters (disabled)
+      PerfCounters() ;
+
+      /// Destructor. Closes the counters
+      ~PerfCounters() ;
+
+      PerfCounters( const PerfCounters & ) = delete ;
+      PerfCounters &operator=( const PerfCounters & ) = delete ;
+
+      /// Whether at least one counter could be opened
+      bool available() const ;
+
+      /// The reason why no counter is available (if any)
+      const std::string &unavailableReason() const ;
+
+      /// Reset and enable the counters
+      void start() ;
+
+      /// Disable the counters and get their values since start().
+      /// The counters that couldn't be read are missing
+      std::vector<Reading> stop() ;
+
+    private:
+      /// An opened counter
+      struct Counter {
+        std::string              _name {} ;
+        int                      _fd {-1} ;
+      };
+      /// The opened counters
+      std::vector<Counter>       _counters {} ;
+      /// Why no counter could be opened
+      std::string                _unavailableReason {} ;
+    };
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,897 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Candidates.h>
+#include <LCAnalysisTools/CellID.h>
+#include <LCAnalysisTools/DurhamClustering.h>
+#include <LCAnalysisTools/EventShapes.h>
+#include <LCAnalysisTools/IsolatedLeptons.h>
+#include <LCAnalysisTools/Kinematics.h>
+#include <LCAnalysisTools/OverlayRemoval.h>
+#include <LCAnalysisTools/PDGHelper.h>
+#include "BenchmarkHarness.h"
+#include "EventSample.h"
+
+// -- std headers
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace lc_analysis ;
+
+namespace {
+
+  /// Number of synthetic events, cycled over
+  constexpr std::size_t NEvents = 1000 ;
+
+  /// The center of mass energy of the synthetic events
+  constexpr double SqrtS = 250. ;
+
+  /// Number of overlay particles in the candidate building events
+  constexpr std::size_t NOverlay = 150 ;
+
+  /// The D meson mass window of the candidate building benchmarks
+  constexpr double DMinMass = 1.80 ;
+  constexpr double DMaxMass = 1.94 ;
+
+  /// The number of jets of the clustering benchmarks
+  constexpr std::size_t NJets = 4 ;
+
+  /// The particle multiplicities of the clustering benchmarks
+  const std::vector<std::size_t> ClusteringMultiplicities = { 50, 100, 200, 500 } ;
+
+  /// Number of synthetic events of the clustering benchmarks, cycled over
+  constexpr std::size_t NClusteringEvents = 50 ;
+
+  /// The kt radius and number of exclusive jets of the overlay removal benchmarks
+  constexpr double OverlayR = 1. ;
+  constexpr std::size_t OverlayJets = 4 ;
+
+  /// The numbers of overlay particles of the overlay removal benchmarks
+  const std::vector<std::size_t> OverlayMultiplicities = { 50, 150, 500 } ;
+
+  /// The numbers of overlay particles of the event shape benchmarks
+  const std::vector<std::size_t> ShapeMultiplicities = { 0, 150 } ;
+
+  /// The maximum error of the approximate thrust
+  constexpr double ThrustMaxError = 1e-3 ;
+
+  /// The highest order of the Fox-Wolfram moments
+  constexpr std::size_t FoxWolframOrder = 6 ;
+
+  /// The cosines of the isolation cone half angles, and the isolation criteria
+  /// (cone, minimum energy and maximum cone energy fraction)
+  const std::vector<double> IsolationCones = { 0.98, 0.95, 0.90 } ;
+  constexpr std::size_t IsolationCone = 1 ;
+  constexpr double IsolationMinEnergy = 5. ;
+  constexpr double IsolationMaxFraction = 0.1 ;
+
+  /// The numbers of overlay particles of the lepton isolation benchmarks
+  const std::vector<std::size_t> IsolationMultiplicities = { 0, 150, 500 } ;
+
+  /// The number of hits of the calorimeter hit collections
+  constexpr std::size_t NCalorimeterHits = 5000 ;
+
+  /**
+   *  @brief  LorentzVector struct
+   *
+   *  Hand-rolled TLorentzVector-like four-vector, as found in analysis code
+   */
+  struct LorentzVector {
+    double _px {0.}, _py {0.}, _pz {0.}, _e {0.} ;
+
+    double P() const { return std::sqrt( _px*_px + _py*_py + _pz*_pz ) ; }
+    double Pt() const { return std::sqrt( _px*_px + _py*_py ) ; }
+    double M() const { const double m2 = _e*_e - P()*P() ; return m2 < 0. ? -std::sqrt( -m2 ) : std::sqrt( m2 ) ; }
+    double CosTheta() const { return P() > 0. ? _pz / P() : 1. ; }
+    LorentzVector operator-( const LorentzVector &rhs ) const { return { _px-rhs._px, _py-rhs._py, _pz-rhs._pz, _e-rhs._e } ; }
+    LorentzVector &operator+=( const LorentzVector &rhs ) { _px += rhs._px ; _py += rhs._py ; _pz += rhs._pz ; _e += rhs._e ; return *this ; }
+    void Boost( double bx, double by, double bz ) {
+      const double b2 = bx*bx + by*by + bz*bz ;
+      const double gamma = 1. / std::sqrt( 1. - b2 ) ;
+      const double bp = bx*_px + by*_py + bz*_pz ;
+      const double gamma2 = b2 > 0. ? ( gamma - 1. ) / b2 : 0. ;
+      _px += gamma2*bp*bx + gamma*bx*_e ;
+      _py += gamma2*bp*by + gamma*by*_e ;
+      _pz += gamma2*bp*bz + gamma*bz*_e ;
+      _e = gamma * ( _e + bp ) ;
+    }
+  };
+
+  /// The kinematics of an event computed in the benchmarks: mass
+  /// hypotheses from the PFO types, pT, polar angles and recoil masses
+  /// of the PFOs, then masses in the rest frame of the visible system.
+  /// Returns the sum of all the computed quantities
+  double aosKinematics( const bench::RecoEventSample &event ) {
+    const LorentzVector initial{ 0., 0., 0., SqrtS } ;
+    std::vector<LorentzVector> vectors ;
+    vectors.reserve( event.size() ) ;
+    LorentzVector visible ;
+    double result = 0. ;
+    for( const auto &particle : event ) {
+      const auto &p = particle._momentum ;
+      const auto &data = pdg::PDGHelper::particle( particle._type ) ;
+      const double m = data.hasMass() ? data.mass() / 1000. : 0. ;
+      LorentzVector vector{ p._px, p._py, p._pz, std::sqrt( p._px*p._px + p._py*p._py + p._pz*p._pz + m*m ) } ;
+      result += vector.Pt() + vector.CosTheta() + ( initial - vector ).M() ;
+      visible += vector ;
+      vectors.push_back( vector ) ;
+    }
+    for( auto &vector : vectors ) {
+      vector.Boost( -visible._px/visible._e, -visible._py/visible._e, -visible._pz/visible._e ) ;
+      result += vector.M() ;
+    }
+    return result ;
+  }
+
+  /**
+   *  @brief  SoAKinematics struct
+   *
+   *  The same computation with a FourMomentumArray and its kernels
+   */
+  struct SoAKinematics {
+    kinematics::FourMomentumArray    _momenta {} ;
+    std::vector<int>                 _types {} ;
+    std::vector<double>              _pts {}, _cosThetas {}, _recoilMasses {}, _masses {} ;
+
+    double operator()( const bench::RecoEventSample &event ) {
+      const auto initial = kinematics::FourMomentum::initialState( SqrtS ) ;
+      _momenta.clear() ;
+      _types.clear() ;
+      for( const auto &particle : event ) {
+        _momenta.push_back( particle._momentum ) ;
+        _types.push_back( particle._type ) ;
+      }
+      _momenta.setMassHypotheses( _types ) ;
+      _momenta.transverseMomenta( _pts ) ;
+      _momenta.cosThetas( _cosThetas ) ;
+      _momenta.recoilMasses( initial, _recoilMasses ) ;
+      _momenta.boostToRestFrame( _momenta.sum() ) ;
+      _momenta.masses( _masses ) ;
+      double result = 0. ;
+      for( std::size_t i=0 ; i<_momenta.size() ; ++i ) {
+        result += _pts[i] + _cosThetas[i] + _recoilMasses[i] + _masses[i] ;
+      }
+      return result ;
+    }
+  };
+
+  /// A candidate as built by hand in analysis code
+  struct NaiveCandidate {
+    std::vector<uint32_t>  _daughters {} ;
+    LorentzVector          _momentum {} ;
+  };
+
+  /// Naive D0 -> K- pi+ and D+ -> K- pi+ pi+ candidates (and conjugates):
+  /// all the pairs and triplets of charged particles, with their mass.
+  /// Returns the number of candidates
+  std::size_t naiveDCandidates( const bench::RecoEventSample &event, std::vector<NaiveCandidate> &candidates ) {
+    candidates.clear() ;
+    const double kaonMass = kinematics::mass( 321 ), pionMass = kinematics::mass( 211 ) ;
+    auto withMass = []( const kinematics::FourMomentum &p, double m ) {
+      return LorentzVector{ p._px, p._py, p._pz, std::sqrt( p.p2() + m*m ) } ;
+    };
+    auto charge = []( const bench::RecoParticleSample &particle ) {
+      return pdg::PDGHelper::particle( particle._type ).threeCharge() ;
+    };
+    auto add = [&]( const LorentzVector &a, const LorentzVector &b ) {
+      return LorentzVector{ a._px+b._px, a._py+b._py, a._pz+b._pz, a._e+b._e } ;
+    };
+    for( uint32_t k=0 ; k<event.size() ; ++k ) {
+      const int kaonCharge = charge( event[k] ) ;
+      if( 0 == kaonCharge ) {
+        continue ;
+      }
+      const auto kaon = withMass( event[k]._momentum, kaonMass ) ;
+      for( uint32_t p1=0 ; p1<event.size() ; ++p1 ) {
+        if( p1 == k || charge( event[p1] ) != -kaonCharge ) {
+          continue ;
+        }
+        const auto kpi = add( kaon, withMass( event[p1]._momentum, pionMass ) ) ;
+        const double m = kpi.M() ;
+        if( m > DMinMass && m < DMaxMass ) {
+          candidates.push_back( NaiveCandidate{ { k, p1 }, kpi } ) ;
+        }
+        for( uint32_t p2=p1+1 ; p2<event.size() ; ++p2 ) {
+          if( p2 == k || charge( event[p2] ) != -kaonCharge ) {
+            continue ;
+          }
+          const auto kpipi = add( kpi, withMass( event[p2]._momentum, pionMass ) ) ;
+          const double m3 = kpipi.M() ;
+          if( m3 > DMinMass && m3 < DMaxMass ) {
+            candidates.push_back( NaiveCandidate{ { k, p1, p2 }, kpipi } ) ;
+          }
+        }
+      }
+    }
+    return candidates.size() ;
+  }
+
+  /**
+   *  @brief  PrunedDCandidates struct
+   *
+   *  The same candidates with a CandidateBuilder, from charge sorted lists
+   */
+  struct PrunedDCandidates {
+    kinematics::FourMomentumArray    _momenta {} ;
+    std::vector<uint32_t>            _positives {}, _negatives {} ;
+    reco::CandidateBuilder           _builder { DMinMass, DMaxMass } ;
+    reco::CandidateArena             _candidates {} ;
+
+    std::size_t operator()( const bench::RecoEventSample &event ) {
+      _momenta.clear() ;
+      _positives.clear() ;
+      _negatives.clear() ;
+      for( uint32_t i=0 ; i<event.size() ; ++i ) {
+        _momenta.push_back( event[i]._momentum ) ;
+        const int charge = pdg::PDGHelper::particle( event[i]._type ).threeCharge() ;
+        if( 0 != charge ) {
+          ( charge > 0 ? _positives : _negatives ).push_back( i ) ;
+        }
+      }
+      std::size_t count = 0 ;
+      for( const auto kaons : { &_negatives, &_positives } ) {
+        const auto pions = ( kaons == &_negatives ) ? &_positives : &_negatives ;
+        count += _builder.build( _momenta, { { kaons, 321 }, { pions, 211 } }, _candidates ) ;
+        count += _builder.build( _momenta, { { kaons, 321 }, { pions, 211 }, { pions, 211 } }, _candidates ) ;
+      }
+      return count ;
+    }
+  };
+
+
+  /// Naive exclusive Durham clustering as found in analysis code: all the
+  /// pairs are compared at each step, O(N^3). Fills the y_{n,n+1} values
+  /// from the number of particles down to njets and returns the jets
+  std::vector<LorentzVector> naiveDurham( const kinematics::FourMomentumArray &particles, std::size_t njets, std::vector<double> &yValues ) {
+    std::vector<LorentzVector> jets ;
+    double evis = 0. ;
+    for( std::size_t i=0 ; i<particles.size() ; ++i ) {
+      const auto p = particles.get( i ) ;
+      jets.push_back( LorentzVector{ p._px, p._py, p._pz, p._e } ) ;
+      evis += p._e ;
+    }
+    yValues.assign( jets.size(), 0. ) ;
+    while( jets.size() > njets ) {
+      double ymin = std::numeric_limits<double>::max() ;
+      std::size_t imin = 0, jmin = 0 ;
+      for( std::size_t i=0 ; i<jets.size() ; ++i ) {
+        for( std::size_t j=i+1 ; j<jets.size() ; ++j ) {
+          const double cosTheta = ( jets[i]._px*jets[j]._px + jets[i]._py*jets[j]._py + jets[i]._pz*jets[j]._pz ) / ( jets[i].P() * jets[j].P() ) ;
+          const double e = std::min( jets[i]._e, jets[j]._e ) ;
+          const double y = 2. * e * e * ( 1. - cosTheta ) / ( evis * evis ) ;
+          if( y < ymin ) {
+            ymin = y ;
+            imin = i ;
+            jmin = j ;
+          }
+        }
+      }
+      yValues[ jets.size()-1 ] = ymin ;
+      jets[imin] += jets[jmin] ;
+      jets.erase( jets.begin() + jmin ) ;
+    }
+    return jets ;
+  }
+
+  /// Naive exclusive kt overlay removal as found in analysis code: all the
+  /// pairs and beam distances are compared at each step, O(N^3). Fills the
+  /// indices of the kept particles, in increasing order
+  void naiveOverlayRemoval( const kinematics::FourMomentumArray &particles, std::vector<uint32_t> &kept ) {
+    struct Jet {
+      LorentzVector              _p {} ;
+      double                     _pt2 {0.}, _rapidity {0.}, _phi {0.} ;
+      std::vector<uint32_t>      _particles {} ;
+    };
+    const auto makeJet = []( const LorentzVector &p ) {
+      Jet jet ;
+      jet._p = p ;
+      jet._pt2 = p._px*p._px + p._py*p._py ;
+      const double mt2 = std::max( p._e*p._e - p._pz*p._pz, jet._pt2 ) ;
+      const double eplus = p._e + std::fabs( p._pz ) ;
+      const double rapidity = ( mt2 > 0. && eplus > 0. ) ? std::min( 0.5 * std::log( eplus*eplus / mt2 ), 1e5 ) : 1e5 ;
+      jet._rapidity = p._pz < 0. ? -rapidity : rapidity ;
+      jet._phi = std::atan2( p._py, p._px ) ;
+      return jet ;
+    } ;
+    std::vector<Jet> jets ;
+    for( std::size_t i=0 ; i<particles.size() ; ++i ) {
+      const auto p = particles.get( i ) ;
+      jets.push_back( makeJet( LorentzVector{ p._px, p._py, p._pz, p._e } ) ) ;
+      jets.back()._particles.push_back( static_cast<uint32_t>( i ) ) ;
+    }
+    while( jets.size() > OverlayJets ) {
+      double dmin = std::numeric_limits<double>::max() ;
+      std::size_t imin = 0, jmin = 0 ;
+      bool beam = true ;
+      // beam distances first: the beam wins ties, e.g. with particles along the beam axis
+      for( std::size_t i=0 ; i<jets.size() ; ++i ) {
+        if( jets[i]._pt2 < dmin ) {
+          dmin = jets[i]._pt2 ;
+          imin = i ;
+        }
+      }
+      for( std::size_t i=0 ; i<jets.size() ; ++i ) {
+        for( std::size_t j=i+1 ; j<jets.size() ; ++j ) {
+          const double dy = jets[i]._rapidity - jets[j]._rapidity ;
+          double dphi = std::fabs( jets[i]._phi - jets[j]._phi ) ;
+          dphi = std::min( dphi, 2.*M_PI - dphi ) ;
+          const double d = std::min( jets[i]._pt2, jets[j]._pt2 ) * ( dy*dy + dphi*dphi ) / ( OverlayR*OverlayR ) ;
+          if( d < dmin ) {
+            dmin = d ;
+            imin = i ;
+            jmin = j ;
+            beam = false ;
+          }
+        }
+      }
+      if( not beam ) {
+        auto p = jets[imin]._p ;
+        p += jets[jmin]._p ;
+        auto merged = makeJet( p ) ;
+        merged._particles = jets[imin]._particles ;
+        merged._particles.insert( merged._particles.end(), jets[jmin]._particles.begin(), jets[jmin]._particles.end() ) ;
+        jets[jmin] = std::move( merged ) ;
+      }
+      jets.erase( jets.begin() + imin ) ;
+    }
+    kept.clear() ;
+    for( const auto &jet : jets ) {
+      kept.insert( kept.end(), jet._particles.begin(), jet._particles.end() ) ;
+    }
+    std::sort( kept.begin(), kept.end() ) ;
+  }
+
+  /// Naive exact thrust as found in analysis code: the optimal partition is cut by
+  /// the plane of two particles, all the pairs are tried with the 4 assignments
+  /// of the pair to the sides, O(N^3)
+  double naiveThrust( const kinematics::FourMomentumArray &particles ) {
+    std::vector<LorentzVector> momenta ;
+    double norm = 0. ;
+    for( std::size_t i=0 ; i<particles.size() ; ++i ) {
+      const auto p = particles.get( i ) ;
+      momenta.push_back( LorentzVector{ p._px, p._py, p._pz, p._e } ) ;
+      norm += momenta.back().P() ;
+    }
+    if( momenta.size() < 2 ) {
+      return momenta.empty() ? 0. : 1. ;
+    }
+    double best = 0. ;
+    for( std::size_t i=0 ; i<momenta.size() ; ++i ) {
+      for( std::size_t j=i+1 ; j<momenta.size() ; ++j ) {
+        const auto &a = momenta[i], &b = momenta[j] ;
+        const double nx = a._py*b._pz - a._pz*b._py, ny = a._pz*b._px - a._px*b._pz, nz = a._px*b._py - a._py*b._px ;
+        LorentzVector side ;
+        for( std::size_t k=0 ; k<momenta.size() ; ++k ) {
+          if( k == i || k == j ) {
+            continue ;
+          }
+          const auto &c = momenta[k] ;
+          if( c._px*nx + c._py*ny + c._pz*nz > 0. ) {
+            side += c ;
+          }
+          else {
+            side += LorentzVector{ -c._px, -c._py, -c._pz, -c._e } ;
+          }
+        }
+        for( const double si : { 1., -1. } ) {
+          for( const double sj : { 1., -1. } ) {
+            LorentzVector total = side ;
+            total += LorentzVector{ si*a._px, si*a._py, si*a._pz, 0. } ;
+            total += LorentzVector{ sj*b._px, sj*b._py, sj*b._pz, 0. } ;
+            best = std::max( best, total.P() ) ;
+          }
+        }
+      }
+    }
+    return best / norm ;
+  }
+
+  /// Naive Fox-Wolfram moments as found in analysis code: all the particle
+  /// pairs, with a Legendre polynomial call per pair and order
+  std::vector<double> naiveFoxWolfram( const kinematics::FourMomentumArray &particles, std::size_t lmax ) {
+    std::vector<double> moments( lmax+1, 0. ) ;
+    double evis = 0. ;
+    for( std::size_t i=0 ; i<particles.size() ; ++i ) {
+      evis += particles.get( i )._e ;
+    }
+    for( std::size_t i=0 ; i<particles.size() ; ++i ) {
+      for( std::size_t j=0 ; j<particles.size() ; ++j ) {
+        const auto a = particles.get( i ), b = particles.get( j ) ;
+        const double pa = a.p(), pb = b.p() ;
+        if( pa <= 0. || pb <= 0. ) {
+          continue ;
+        }
+        const double cosTheta = std::min( std::max( ( a._px*b._px + a._py*b._py + a._pz*b._pz ) / ( pa * pb ), -1. ), 1. ) ;
+        for( std::size_t l=0 ; l<=lmax ; ++l ) {
+          moments[l] += pa * pb * std::legendre( static_cast<unsigned int>( l ), cosTheta ) / ( evis * evis ) ;
+        }
+      }
+    }
+    return moments ;
+  }
+
+  /// Naive cone energies as found in analysis code: for each electron or muon,
+  /// the energy of all the other PFOs within each cone, O(candidates x N x cones).
+  /// Fills the candidates and their cone energies, cone by cone
+  void naiveConeEnergies( const bench::RecoEventSample &event, std::vector<uint32_t> &candidates, std::vector<double> &energies ) {
+    candidates.clear() ;
+    energies.clear() ;
+    for( uint32_t i=0 ; i<event.size() ; ++i ) {
+      const int type = std::abs( event[i]._type ) ;
+      if( 11 != type && 13 != type ) {
+        continue ;
+      }
+      candidates.push_back( i ) ;
+      const auto &lepton = event[i]._momentum ;
+      for( const double cosCone : IsolationCones ) {
+        double energy = 0. ;
+        for( uint32_t j=0 ; j<event.size() ; ++j ) {
+          const auto &p = event[j]._momentum ;
+          const double norm = lepton.p() * p.p() ;
+          if( j == i || norm <= 0. ) {
+            continue ;
+          }
+          if( ( lepton._px*p._px + lepton._py*p._py + lepton._pz*p._pz ) / norm >= cosCone ) {
+            energy += p._e ;
+          }
+        }
+        energies.push_back( energy ) ;
+      }
+    }
+  }
+
+  /**
+   *  @brief  NaiveBitField64 class
+   *
+   *  Cell id decoder as in LCIO: the encoding string is parsed per collection
+   *  into one heap allocated field object per field, found by name in a map
+   *  for each hit
+   */
+  class NaiveBitField64 {
+  public:
+    struct Field {
+      unsigned int _offset {0}, _width {0} ;
+      bool _signed {false} ;
+      long value( uint64_t cellID ) const {
+        const uint64_t mask = ( _width < 64 ? ( uint64_t(1) << _width ) - 1 : ~uint64_t(0) ) ;
+        uint64_t bits = ( cellID >> _offset ) & mask ;
+        if( _signed && ( bits & ( uint64_t(1) << ( _width - 1 ) ) ) ) {
+          bits |= ~mask ;
+        }
+        return static_cast<long>( bits ) ;
+      }
+    };
+
+    explicit NaiveBitField64( const std::string &encoding ) {
+      std::stringstream stream( encoding ) ;
+      std::string description ;
+      unsigned int offset = 0 ;
+      while( std::getline( stream, description, ',' ) ) {
+        std::vector<std::string> tokens ;
+        std::stringstream fieldStream( description ) ;
+        std::string token ;
+        while( std::getline( fieldStream, token, ':' ) ) {
+          tokens.push_back( token ) ;
+        }
+        auto field = std::make_unique<Field>() ;
+        if( 3 == tokens.size() ) {
+          offset = std::stoi( tokens[1] ) ;
+        }
+        const int width = std::stoi( tokens.back() ) ;
+        field->_offset = offset ;
+        field->_width = std::abs( width ) ;
+        field->_signed = width < 0 ;
+        offset += field->_width ;
+        _indices[ tokens[0] ] = _fields.size() ;
+        _fields.push_back( std::move( field ) ) ;
+      }
+    }
+
+    void setValue( uint64_t cellID ) { _value = cellID ; }
+
+    long operator[]( const std::string &name ) const { return _fields[ _indices.at( name ) ]->value( _value ) ; }
+
+  private:
+    std::vector<std::unique_ptr<Field>> _fields {} ;
+    std::map<std::string, std::size_t> _indices {} ;
+    uint64_t _value {0} ;
+  };
+
+  /// Naive energy sums per layer and per system as found in analysis code: a
+  /// decoder per collection, and a field lookup by name per hit
+  void naiveLayerEnergies( const bench::CalorimeterHitSample &hits, std::vector<double> &layers, std::vector<double> &systems ) {
+    NaiveBitField64 decoder( hits._encoding ) ;
+    layers.clear() ;
+    systems.clear() ;
+    for( std::size_t i=0 ; i<hits._cellIDs.size() ; ++i ) {
+      decoder.setValue( hits._cellIDs[i] ) ;
+      const auto layer = static_cast<std::size_t>( decoder["layer"] ) ;
+      const auto system = static_cast<std::size_t>( decoder["system"] ) ;
+      if( layer >= layers.size() ) {
+        layers.resize( layer+1, 0. ) ;
+      }
+      if( system >= systems.size() ) {
+        systems.resize( system+1, 0. ) ;
+      }
+      layers[layer] += hits._energies[i] ;
+      systems[system] += hits._energies[i] ;
+    }
+  }
+
+  /**
+   *  @brief  PrecompiledLayerEnergies struct
+   *
+   *  Energy sums per layer and per system with a CellIDDecoder: the encoding
+   *  is parsed once, the histograms are reused between collections
+   */
+  struct PrecompiledLayerEnergies {
+    hits::CellIDDecoder        _decoder {} ;
+    std::vector<double>        _layers {} ;
+    std::vector<double>        _systems {} ;
+
+    void operator()( const bench::CalorimeterHitSample &hits ) {
+      _decoder.setEncoding( hits._encoding ) ;
+      const auto layer = _decoder.index( "layer" ), system = _decoder.index( "system" ) ;
+      _layers.assign( _decoder.nBins( layer ), 0. ) ;
+      _systems.assign( _decoder.nBins( system ), 0. ) ;
+      _decoder.histogram( hits._cellIDs.data(), hits._energies.data(), hits._cellIDs.size(), layer, _layers.data() ) ;
+      _decoder.histogram( hits._cellIDs.data(), hits._energies.data(), hits._cellIDs.size(), system, _systems.data() ) ;
+    }
+  };
+
+  /// Get the four-momenta of the first n particles of events with n particles or more
+  std::vector<kinematics::FourMomentumArray> clusteringEvents( std::size_t n ) {
+    const auto nbase = bench::generateRecoEvents( 1 ).front().size() ;
+    const auto events = bench::generateRecoEvents( NClusteringEvents, n + n / 2 > nbase ? n + n / 2 - nbase : 0, n ) ;
+    std::vector<kinematics::FourMomentumArray> momenta( events.size() ) ;
+    for( std::size_t e=0 ; e<events.size() ; ++e ) {
+      for( std::size_t i=0 ; i<n && i<events[e].size() ; ++i ) {
+        momenta[e].push_back( events[e][i]._momentum ) ;
+      }
+    }
+    return momenta ;
+  }
+
+  /// Register the four-vector cases: AoS kinematics against the
+  /// FourMomentumArray kernels. One operation is one event
+  void addFourVectorCases( bench::BenchmarkHarness &harness ) {
+    const auto events = bench::generateRecoEvents( NEvents ) ;
+    std::size_t nparticles = 0 ;
+    SoAKinematics soaCheck ;
+    for( const auto &event : events ) {
+      const double aos = aosKinematics( event ) ;
+      const double soa = soaCheck( event ) ;
+      if( std::fabs( aos - soa ) > 1e-6 * std::fabs( aos ) ) {
+        throw std::runtime_error( "Four-vector kernel results differ from the AoS ones" ) ;
+      }
+      nparticles += event.size() ;
+    }
+    std::cout << "e+e- -> ZH -> mu+mu- bb: " << nparticles / static_cast<double>( events.size() ) << " PFOs per event" << std::endl ;
+    harness.add( "fourvector/aos", [events]( std::size_t n ) {
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        bench::doNotOptimize( aosKinematics( events[ i % events.size() ] ) ) ;
+      }
+    }) ;
+    harness.add( "fourvector/soa", [events]( std::size_t n ) {
+      SoAKinematics soa ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        bench::doNotOptimize( soa( events[ i % events.size() ] ) ) ;
+      }
+    }) ;
+  }
+
+  /// Register the D -> K pi (pi) candidate building cases, in events with
+  /// NOverlay overlay particles: nested loops against the CandidateBuilder.
+  /// One operation is one event
+  void addCandidateCases( bench::BenchmarkHarness &harness ) {
+    const auto overlayEvents = bench::generateRecoEvents( NEvents, NOverlay ) ;
+    std::size_t ncandidates = 0 ;
+    std::vector<NaiveCandidate> naiveCandidates ;
+    PrunedDCandidates prunedCheck ;
+    for( const auto &event : overlayEvents ) {
+      const auto nnaive = naiveDCandidates( event, naiveCandidates ) ;
+      if( nnaive != prunedCheck( event ) ) {
+        throw std::runtime_error( "Candidate count mismatch between the naive and pruned builders" ) ;
+      }
+      ncandidates += nnaive ;
+    }
+    std::cout << "D -> K pi (pi) with " << NOverlay << " overlay particles: " << ncandidates / static_cast<double>( overlayEvents.size() )
+      << " candidates per event" << std::endl ;
+    harness.add( "candidates/naive", [overlayEvents]( std::size_t n ) {
+      std::vector<NaiveCandidate> candidates ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        bench::doNotOptimize( naiveDCandidates( overlayEvents[ i % overlayEvents.size() ], candidates ) ) ;
+      }
+    }) ;
+    harness.add( "candidates/pruned", [overlayEvents]( std::size_t n ) {
+      PrunedDCandidates pruned ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        bench::doNotOptimize( pruned( overlayEvents[ i % overlayEvents.size() ] ) ) ;
+      }
+    }) ;
+  }
+
+  /// Register the Durham clustering cases for each multiplicity of
+  /// ClusteringMultiplicities: naive O(N^3) clustering against the
+  /// DurhamClustering. One operation is the clustering of an event in NJets jets
+  void addDurhamCases( bench::BenchmarkHarness &harness ) {
+    for( const auto multiplicity : ClusteringMultiplicities ) {
+      const auto clusteringSample = clusteringEvents( multiplicity ) ;
+      reco::DurhamClustering clusteringCheck ;
+      std::vector<double> naiveY ;
+      // the naive clustering is slow at high multiplicities: check the first events only
+      for( std::size_t e=0 ; e<std::min<std::size_t>( 10, clusteringSample.size() ) ; ++e ) {
+        const auto &particles = clusteringSample[e] ;
+        auto naiveJets = naiveDurham( particles, NJets, naiveY ) ;
+        clusteringCheck.clusterExclusive( particles, NJets ) ;
+        bool same = ( naiveJets.size() == clusteringCheck.nJets() ) ;
+        std::vector<double> naiveEnergies, energies ;
+        for( std::size_t j=0 ; same && j<naiveJets.size() ; ++j ) {
+          naiveEnergies.push_back( naiveJets[j]._e ) ;
+          energies.push_back( clusteringCheck.jets().get( j )._e ) ;
+        }
+        std::sort( naiveEnergies.begin(), naiveEnergies.end() ) ;
+        std::sort( energies.begin(), energies.end() ) ;
+        for( std::size_t j=0 ; same && j<energies.size() ; ++j ) {
+          same = std::fabs( naiveEnergies[j] - energies[j] ) < 1e-6 * energies[j] ;
+        }
+        for( std::size_t n=NJets ; same && n<naiveY.size() ; ++n ) {
+          same = std::fabs( naiveY[n] - clusteringCheck.y( n ) ) <= 1e-9 + 1e-6 * naiveY[n] ;
+        }
+        if( not same ) {
+          throw std::runtime_error( "Durham clustering differs from the naive one for " + std::to_string( multiplicity ) + " particles" ) ;
+        }
+      }
+      const auto suffix = "/" + std::to_string( multiplicity ) ;
+      harness.add( "durham/naive" + suffix, [clusteringSample]( std::size_t n ) {
+        std::vector<double> yValues ;
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          bench::doNotOptimize( naiveDurham( clusteringSample[ i % clusteringSample.size() ], NJets, yValues ).size() ) ;
+        }
+      }) ;
+      harness.add( "durham/nnh" + suffix, [clusteringSample]( std::size_t n ) {
+        reco::DurhamClustering clustering ;
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          clustering.clusterExclusive( clusteringSample[ i % clusteringSample.size() ], NJets ) ;
+          bench::doNotOptimize( clustering.y( NJets ) ) ;
+        }
+      }) ;
+    }
+  }
+
+  /// Register the overlay removal cases for each multiplicity of
+  /// OverlayMultiplicities: naive O(N^3) exclusive kt clustering against the
+  /// OverlayRemoval. One operation is the overlay removal of an event, for the
+  /// ZH event plus N overlay particles
+  void addOverlayCases( bench::BenchmarkHarness &harness ) {
+    for( const auto multiplicity : OverlayMultiplicities ) {
+      const auto sample = bench::generateRecoEvents( NClusteringEvents, multiplicity, multiplicity ) ;
+      std::vector<kinematics::FourMomentumArray> overlaySample( sample.size() ) ;
+      reco::OverlayRemoval removalCheck( OverlayR, OverlayJets ) ;
+      std::vector<uint32_t> naiveKept ;
+      std::size_t nparticles = 0, nremoved = 0, noverlayRemoved = 0, noverlay = 0 ;
+      for( std::size_t e=0 ; e<sample.size() ; ++e ) {
+        for( const auto &particle : sample[e] ) {
+          overlaySample[e].push_back( particle._momentum ) ;
+          noverlay += particle._overlay ? 1 : 0 ;
+        }
+        removalCheck.process( overlaySample[e] ) ;
+        nparticles += sample[e].size() ;
+        nremoved += removalCheck.removed().size() ;
+        for( const auto index : removalCheck.removed() ) {
+          noverlayRemoved += sample[e][index]._overlay ? 1 : 0 ;
+        }
+        // the naive removal is slow at high multiplicities: check the first events only
+        if( e < 10 ) {
+          naiveOverlayRemoval( overlaySample[e], naiveKept ) ;
+          if( naiveKept != removalCheck.kept() ) {
+            throw std::runtime_error( "Overlay removal differs from the naive one for " + std::to_string( multiplicity ) + " overlay particles" ) ;
+          }
+        }
+      }
+      std::cout << "Overlay removal with " << multiplicity << " overlay particles: " << nparticles / static_cast<double>( sample.size() )
+        << " PFOs per event, " << nremoved / static_cast<double>( sample.size() ) << " removed, "
+        << 100. * noverlayRemoved / std::max<std::size_t>( noverlay, 1 ) << "% of the overlay removed" << std::endl ;
+      const auto suffix = "/" + std::to_string( multiplicity ) ;
+      harness.add( "overlay/naive" + suffix, [overlaySample]( std::size_t n ) {
+        std::vector<uint32_t> kept ;
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          naiveOverlayRemoval( overlaySample[ i % overlaySample.size() ], kept ) ;
+          bench::doNotOptimize( kept.size() ) ;
+        }
+      }) ;
+      harness.add( "overlay/tiled" + suffix, [overlaySample]( std::size_t n ) {
+        reco::OverlayRemoval removal( OverlayR, OverlayJets ) ;
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          removal.process( overlaySample[ i % overlaySample.size() ] ) ;
+          bench::doNotOptimize( removal.kept().size() ) ;
+        }
+      }) ;
+    }
+  }
+
+  /// Register the thrust and Fox-Wolfram cases for each multiplicity of
+  /// ShapeMultiplicities: naive implementations against the EventShapes.
+  /// One operation is the event shape computation of an event, for the ZH
+  /// event plus N overlay particles
+  void addEventShapeCases( bench::BenchmarkHarness &harness ) {
+    for( const auto multiplicity : ShapeMultiplicities ) {
+      const auto sample = bench::generateRecoEvents( NClusteringEvents, multiplicity, multiplicity + 1 ) ;
+      std::vector<kinematics::FourMomentumArray> shapeSample( sample.size() ) ;
+      reco::EventShapes shapesCheck ;
+      double meanThrust = 0. ;
+      for( std::size_t e=0 ; e<sample.size() ; ++e ) {
+        for( const auto &particle : sample[e] ) {
+          shapeSample[e].push_back( particle._momentum ) ;
+        }
+        const auto exact = shapesCheck.thrust( shapeSample[e] ) ;
+        const auto approximate = shapesCheck.approximateThrust( shapeSample[e], ThrustMaxError ) ;
+        if( approximate._thrust > exact._thrust + 1e-12 || approximate._thrust + approximate._error < exact._thrust - 1e-12
+          || approximate._error > ThrustMaxError ) {
+          throw std::runtime_error( "Approximate thrust out of its error bound" ) ;
+        }
+        meanThrust += exact._thrust ;
+        const auto &moments = shapesCheck.foxWolframMoments( shapeSample[e], FoxWolframOrder ) ;
+        const auto naiveMoments = naiveFoxWolfram( shapeSample[e], FoxWolframOrder ) ;
+        for( std::size_t l=0 ; l<=FoxWolframOrder ; ++l ) {
+          if( std::fabs( moments[l] - naiveMoments[l] ) > 1e-9 ) {
+            throw std::runtime_error( "Fox-Wolfram moments differ from the naive ones" ) ;
+          }
+        }
+        // the naive thrust is slow at high multiplicities: check the first events only
+        if( e < 10 && std::fabs( naiveThrust( shapeSample[e] ) - exact._thrust ) > 1e-12 ) {
+          throw std::runtime_error( "Thrust differs from the naive one for " + std::to_string( multiplicity ) + " overlay particles" ) ;
+        }
+      }
+      std::cout << "Event shapes with " << multiplicity << " overlay particles: mean thrust " << meanThrust / sample.size() << std::endl ;
+      const auto suffix = "/" + std::to_string( multiplicity ) ;
+      harness.add( "thrust/naive" + suffix, [shapeSample]( std::size_t n ) {
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          bench::doNotOptimize( naiveThrust( shapeSample[ i % shapeSample.size() ] ) ) ;
+        }
+      }) ;
+      harness.add( "thrust/exact" + suffix, [shapeSample]( std::size_t n ) {
+        reco::EventShapes shapes ;
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          bench::doNotOptimize( shapes.thrust( shapeSample[ i % shapeSample.size() ] )._thrust ) ;
+        }
+      }) ;
+      harness.add( "thrust/approximate" + suffix, [shapeSample]( std::size_t n ) {
+        reco::EventShapes shapes ;
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          bench::doNotOptimize( shapes.approximateThrust( shapeSample[ i % shapeSample.size() ], ThrustMaxError )._thrust ) ;
+        }
+      }) ;
+      harness.add( "foxwolfram/naive" + suffix, [shapeSample]( std::size_t n ) {
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          bench::doNotOptimize( naiveFoxWolfram( shapeSample[ i % shapeSample.size() ], FoxWolframOrder ).back() ) ;
+        }
+      }) ;
+      harness.add( "foxwolfram/recursion" + suffix, [shapeSample]( std::size_t n ) {
+        reco::EventShapes shapes ;
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          bench::doNotOptimize( shapes.foxWolframMoments( shapeSample[ i % shapeSample.size() ], FoxWolframOrder ).back() ) ;
+        }
+      }) ;
+    }
+  }
+
+  /// Register the lepton isolation cases for each multiplicity of
+  /// IsolationMultiplicities: a loop over all the PFOs per lepton and cone
+  /// against the IsolatedLeptonFinder. One operation is the lepton isolation of
+  /// an event (all the cones), for the ZH event plus N overlay particles
+  void addIsolationCases( bench::BenchmarkHarness &harness ) {
+    for( const auto multiplicity : IsolationMultiplicities ) {
+      const auto sample = bench::generateRecoEvents( NClusteringEvents, multiplicity, multiplicity + 2 ) ;
+      std::vector<kinematics::FourMomentumArray> isolationSample( sample.size() ) ;
+      std::vector<std::vector<int>> types( sample.size() ) ;
+      reco::IsolatedLeptonFinder finderCheck( IsolationCones ) ;
+      std::vector<uint32_t> naiveCandidates, isolated ;
+      std::vector<double> naiveEnergies ;
+      std::size_t ncandidates = 0, nisolated = 0 ;
+      for( std::size_t e=0 ; e<sample.size() ; ++e ) {
+        for( const auto &particle : sample[e] ) {
+          isolationSample[e].push_back( particle._momentum ) ;
+          types[e].push_back( particle._type ) ;
+        }
+        finderCheck.process( isolationSample[e], types[e] ) ;
+        naiveConeEnergies( sample[e], naiveCandidates, naiveEnergies ) ;
+        if( naiveCandidates != finderCheck.candidates() ) {
+          throw std::runtime_error( "Lepton candidates differ from the naive ones" ) ;
+        }
+        for( std::size_t c=0 ; c<naiveCandidates.size() ; ++c ) {
+          for( std::size_t cone=0 ; cone<IsolationCones.size() ; ++cone ) {
+            if( std::fabs( finderCheck.coneEnergy( c, cone ) - naiveEnergies[ c * IsolationCones.size() + cone ] ) > 1e-9 ) {
+              throw std::runtime_error( "Cone energies differ from the naive ones for " + std::to_string( multiplicity ) + " overlay particles" ) ;
+            }
+          }
+        }
+        finderCheck.isolated( IsolationCone, IsolationMinEnergy, IsolationMaxFraction, isolated ) ;
+        ncandidates += naiveCandidates.size() ;
+        nisolated += isolated.size() ;
+      }
+      std::cout << "Lepton isolation with " << multiplicity << " overlay particles: " << ncandidates / static_cast<double>( sample.size() )
+        << " candidates, " << nisolated / static_cast<double>( sample.size() ) << " isolated per event" << std::endl ;
+      const auto suffix = "/" + std::to_string( multiplicity ) ;
+      harness.add( "isolation/naive" + suffix, [sample]( std::size_t n ) {
+        std::vector<uint32_t> candidates ;
+        std::vector<double> energies ;
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          naiveConeEnergies( sample[ i % sample.size() ], candidates, energies ) ;
+          bench::doNotOptimize( energies.size() ) ;
+        }
+      }) ;
+      harness.add( "isolation/binned" + suffix, [isolationSample, types]( std::size_t n ) {
+        reco::IsolatedLeptonFinder finder( IsolationCones ) ;
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          finder.process( isolationSample[ i % isolationSample.size() ], types[ i % types.size() ] ) ;
+          bench::doNotOptimize( finder.candidates().size() ) ;
+        }
+      }) ;
+    }
+  }
+
+  /// Register the calorimeter cell id cases: an LCIO-like BitField64 decoder
+  /// against the CellIDDecoder histograms. One operation is the energy sums
+  /// per layer and per system of a calorimeter hit collection
+  void addCellIDCases( bench::BenchmarkHarness &harness ) {
+    const auto hitSample = bench::generateCalorimeterHits( NClusteringEvents, NCalorimeterHits ) ;
+    PrecompiledLayerEnergies precompiledCheck ;
+    std::vector<double> naiveLayers, naiveSystems ;
+    for( const auto &hits : hitSample ) {
+      naiveLayerEnergies( hits, naiveLayers, naiveSystems ) ;
+      precompiledCheck( hits ) ;
+      const auto compare = []( const std::vector<double> &naive, const std::vector<double> &bins ) {
+        for( std::size_t b=0 ; b<bins.size() ; ++b ) {
+          const double expected = b < naive.size() ? naive[b] : 0. ;
+          if( std::fabs( bins[b] - expected ) > 1e-12 * std::max( 1., std::fabs( expected ) ) ) {
+            throw std::runtime_error( "Calorimeter energy sums differ from the naive ones" ) ;
+          }
+        }
+      } ;
+      compare( naiveLayers, precompiledCheck._layers ) ;
+      compare( naiveSystems, precompiledCheck._systems ) ;
+    }
+    std::cout << "Calorimeter hits: " << NCalorimeterHits << " hits per collection, " << naiveLayers.size() << " layers" << std::endl ;
+    harness.add( "cellid/bitfield", [hitSample]( std::size_t n ) {
+      std::vector<double> layers, systems ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        naiveLayerEnergies( hitSample[ i % hitSample.size() ], layers, systems ) ;
+        bench::doNotOptimize( layers.back() ) ;
+      }
+    }) ;
+    harness.add( "cellid/precompiled", [hitSample]( std::size_t n ) {
+      PrecompiledLayerEnergies precompiled ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        precompiled( hitSample[ i % hitSample.size() ] ) ;
+        bench::doNotOptimize( precompiled._layers.back() ) ;
+      }
+    }) ;
+  }
+
+}
+
+int main( int argc, char **argv ) {
+  try {
+    bench::BenchmarkHarness harness( "Reco", argc, argv ) ;
+    addFourVectorCases( harness ) ;
+    addCandidateCases( harness ) ;
+    addDurhamCases( harness ) ;
+    addOverlayCases( harness ) ;
+    addEventShapeCases( harness ) ;
+    addIsolationCases( harness ) ;
+    addCellIDCases( harness ) ;
+    return harness.run() ;
+  }
+  catch( const std::exception &e ) {
+    std::cerr << "Benchmark failed: " << e.what() << std::endl ;
+    return 1 ;
+  }
+}
@@ -0,0 +1,271 @@
+
+// -- LCAnalysisTools headers
+#include "BenchmarkHarness.h"
+
+// -- std headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// -- unix headers
+#include <dlfcn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef LCANALYSISTOOLS_LIBRARY
+#define LCANALYSISTOOLS_LIBRARY "libLCAnalysisTools.so"
+#endif
+
+namespace lc_analysis {
+  namespace pdg {
+    class ParticleData ;
+  }
+}
+
+using namespace lc_analysis ;
+
+//--------------------------------------------------------------------------------
+// Heap allocation counting. The executable is linked with exported symbols,
+// so that the operator new calls of the loaded libraries resolve here
+//--------------------------------------------------------------------------------
+
+namespace {
+  std::atomic<std::size_t> allocationCount {0} ;
+  std::atomic<std::size_t> allocatedBytes {0} ;
+
+  void *countedAllocation( std::size_t size ) {
+    allocationCount.fetch_add( 1, std::memory_order_relaxed ) ;
+    allocatedBytes.fetch_add( size, std::memory_order_relaxed ) ;
+    if( void *ptr = std::malloc( size ? size : 1 ) ) {
+      return ptr ;
+    }
+    throw std::bad_alloc() ;
+  }
+}
+
+void *operator new( std::size_t size ) {
+  return countedAllocation( size ) ;
+}
+
+void *operator new[]( std::size_t size ) {
+  return countedAllocation( size ) ;
+}
+
+void *operator new( std::size_t size, const std::nothrow_t & ) noexcept {
+  try {
+    return countedAllocation( size ) ;
+  }
+  catch( ... ) {
+    return nullptr ;
+  }
+}
+
+void *operator new[]( std::size_t size, const std::nothrow_t & ) noexcept {
+  try {
+    return countedAllocation( size ) ;
+  }
+  catch( ... ) {
+    return nullptr ;
+  }
+}
+
+void operator delete( void *ptr ) noexcept {
+  std::free( ptr ) ;
+}
+
+void operator delete[]( void *ptr ) noexcept {
+  std::free( ptr ) ;
+}
+
+void operator delete( void *ptr, std::size_t ) noexcept {
+  std::free( ptr ) ;
+}
+
+void operator delete[]( void *ptr, std::size_t ) noexcept {
+  std::free( ptr ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+namespace {
+
+  /// Mangled name of lc_analysis::pdg::PDGHelper::particle(int)
+  constexpr const char *ParticleSymbol = "_ZN11lc_analysis3pdg9PDGHelper8particleEi" ;
+
+  /// The lookup function signature. The library is loaded at run time,
+  /// so the returned particle is only used by address
+  using ParticleFunction = const pdg::ParticleData &(*)( int ) ;
+
+  /// The measurements of a single process start
+  struct StartupMeasurement {
+    double        _dlopenNs {0.} ;
+    double        _firstLookupNs {0.} ;
+    double        _totalNs {0.} ;
+    double        _residentBytes {0.} ;
+    double        _allocations {0.} ;
+    double        _allocatedBytes {0.} ;
+  };
+
+  /// Get the resident memory of the process in bytes
+  double residentMemory() {
+    long pages[2] = {0, 0} ;
+    if( FILE *statm = std::fopen( "/proc/self/statm", "r" ) ) {
+      if( std::fscanf( statm, "%ld %ld", &pages[0], &pages[1] ) != 2 ) {
+        pages[1] = 0 ;
+      }
+      std::fclose( statm ) ;
+    }
+    return static_cast<double>( pages[1] ) * ::sysconf( _SC_PAGESIZE ) ;
+  }
+
+  /// Load the library, run the first lookup and measure.
+  /// Must run in a fresh process, where the library is not yet loaded
+  StartupMeasurement measureStartup( const std::string &library ) {
+    using clock = std::chrono::steady_clock ;
+    StartupMeasurement measurement ;
+    const double residentBefore = residentMemory() ;
+    const std::size_t allocationsBefore = allocationCount.load() ;
+    const std::size_t bytesBefore = allocatedBytes.load() ;
+    const auto start = clock::now() ;
+    void *handle = ::dlopen( library.c_str(), RTLD_NOW | RTLD_LOCAL ) ;
+    const auto loaded = clock::now() ;
+    if( nullptr == handle ) {
+      throw std::runtime_error( std::string( "dlopen failed: " ) + ::dlerror() ) ;
+    }
+    const std::size_t allocationsAfter = allocationCount.load() ;
+    const std::size_t bytesAfter = allocatedBytes.load() ;
+    auto particle = reinterpret_cast<ParticleFunction>( ::dlsym( handle, ParticleSymbol ) ) ;
+    if( nullptr == particle ) {
+      throw std::runtime_error( std::string( "dlsym failed: " ) + ::dlerror() ) ;
+    }
+    bench::doNotOptimize( &particle( 22 ) ) ;
+    const auto firstLookup = clock::now() ;
+    measurement._dlopenNs = std::chrono::duration<double, std::nano>( loaded - start ).count() ;
+    measurement._firstLookupNs = std::chrono::duration<double, std::nano>( firstLookup - loaded ).count() ;
+    measurement._totalNs = std::chrono::duration<double, std::nano>( firstLookup - start ).count() ;
+    measurement._residentBytes = residentMemory() - residentBefore ;
+    measurement._allocations = static_cast<double>( allocationsAfter - allocationsBefore ) ;
+    measurement._allocatedBytes = static_cast<double>( bytesAfter - bytesBefore ) ;
+    return measurement ;
+  }
+
+  /// Run the measurement in a forked child process and read back the result
+  StartupMeasurement measureInChild( const std::string &library ) {
+    int fds[2] ;
+    if( ::pipe( fds ) != 0 ) {
+      throw std::runtime_error( "Couldn't create pipe" ) ;
+    }
+    const pid_t pid = ::fork() ;
+    if( pid < 0 ) {
+      throw std::runtime_error( "Couldn't fork" ) ;
+    }
+    if( 0 == pid ) {
+      ::close( fds[0] ) ;
+      int status = 0 ;
+      try {
+        const auto measurement = measureStartup( library ) ;
+        if( ::write( fds[1], &measurement, sizeof(measurement) ) != sizeof(measurement) ) {
+          status = 1 ;
+        }
+      }
+      catch( const std::exception &e ) {
+        std::cerr << "Startup measurement failed: " << e.what() << std::endl ;
+        status = 1 ;
+      }
+      ::close( fds[1] ) ;
+      ::_exit( status ) ;
+    }
+    ::close( fds[1] ) ;
+    StartupMeasurement measurement ;
+    const auto nread = ::read( fds[0], &measurement, sizeof(measurement) ) ;
+    ::close( fds[0] ) ;
+    int status = 0 ;
+    ::waitpid( pid, &status, 0 ) ;
+    if( nread != sizeof(measurement) || not WIFEXITED( status ) || WEXITSTATUS( status ) != 0 ) {
+      throw std::runtime_error( "Startup measurement failed in child process" ) ;
+    }
+    return measurement ;
+  }
+
+  /// Build a benchmark result from the samples of a measured quantity
+  bench::BenchmarkResult makeResult( const std::string &name, const std::string &unit, std::vector<double> samples ) {
+    bench::BenchmarkResult result ;
+    result._name = name ;
+    result._unit = unit ;
+    result._operations = 1 ;
+    result._nsPerOp = bench::median( samples ) ;
+    result._mad = bench::medianAbsoluteDeviation( samples ) ;
+    result._opsPerSecond = ( unit == "ns/op" && result._nsPerOp > 0. ) ? 1e9 / result._nsPerOp : 0. ;
+    result._samples = std::move( samples ) ;
+    return result ;
+  }
+
+  void usage( const char *program ) {
+    std::cout << "Usage: " << program << " [--library <path>] [--repetitions <n>] [--json <file>]" << std::endl ;
+    std::cout << "  Measures the dlopen-to-first-lookup time, the resident memory after load" << std::endl ;
+    std::cout << "  and the heap allocations during static initialization of the library." << std::endl ;
+    std::cout << "  Each repetition runs in a fresh forked process." << std::endl ;
+  }
+}
+
+int main( int argc, char **argv ) {
+  std::string library = LCANALYSISTOOLS_LIBRARY ;
+  std::string jsonFile ;
+  std::size_t repetitions = 10 ;
+  for( int i=1 ; i<argc ; ++i ) {
+    const std::string arg = argv[i] ;
+    const bool hasValue = ( i+1 < argc ) ;
+    if( arg == "--library" && hasValue ) {
+      library = argv[++i] ;
+    }
+    else if( arg == "--repetitions" && hasValue ) {
+      repetitions = std::max( 1, std::atoi( argv[++i] ) ) ;
+    }
+    else if( arg == "--json" && hasValue ) {
+      jsonFile = argv[++i] ;
+    }
+    else {
+      usage( argv[0] ) ;
+      return 1 ;
+    }
+  }
+  try {
+    std::vector<double> dlopenTimes, lookupTimes, totalTimes, resident, allocations, bytes ;
+    for( std::size_t r=0 ; r<repetitions ; ++r ) {
+      const auto measurement = measureInChild( library ) ;
+      dlopenTimes.push_back( measurement._dlopenNs ) ;
+      lookupTimes.push_back( measurement._firstLookupNs ) ;
+      totalTimes.push_back( measurement._totalNs ) ;
+      resident.push_back( measurement._residentBytes ) ;
+      allocations.push_back( measurement._allocations ) ;
+      bytes.push_back( measurement._allocatedBytes ) ;
+    }
+    std::vector<bench::BenchmarkResult> results ;
+    results.push_back( makeResult( "startup/dlopen", "ns/op", std::move(dlopenTimes) ) ) ;
+    results.push_back( makeResult( "startup/first_lookup", "ns/op", std::move(lookupTimes) ) ) ;
+    results.push_back( makeResult( "startup/dlopen_to_first_lookup", "ns/op", std::move(totalTimes) ) ) ;
+    results.push_back( makeResult( "startup/resident_memory", "bytes", std::move(resident) ) ) ;
+    results.push_back( makeResult( "startup/static_init_allocations", "allocations", std::move(allocations) ) ) ;
+    results.push_back( makeResult( "startup/static_init_allocated_bytes", "bytes", std::move(bytes) ) ) ;
+    for( const auto &result : results ) {
+      std::cout << std::left << std::setw(40) << result._name << std::right << std::fixed << std::setprecision(1)
+        << std::setw(16) << result._nsPerOp << " +/- " << std::setw(12) << result._mad << " " << result._unit << std::endl ;
+    }
+    if( not jsonFile.empty() ) {
+      bench::writeBenchmarkJSON( jsonFile, "Startup", results, { { "library", library } } ) ;
+    }
+  }
+  catch( const std::exception &e ) {
+    std::cerr << "Benchmark failed: " << e.what() << std::endl ;
+    return 1 ;
+  }
+  return 0 ;
+}
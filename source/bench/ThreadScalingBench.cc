@@ -0,0 +1,372 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/ParallelSIOReader.h>
+#include <LCAnalysisTools/PDGHelper.h>
+#include "BenchmarkHarness.h"
+#include "EventSample.h"
+
+// -- std headers
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -- system headers
+#include <unistd.h>
+
+// -- zlib headers
+#include <zlib.h>
+
+using namespace lc_analysis ;
+using namespace lc_analysis::pdg ;
+
+namespace {
+
+  /// Number of synthetic events, cycled over
+  constexpr std::size_t NEvents = 512 ;
+
+  /// Events handed to a worker at once
+  constexpr std::size_t EventChunk = 8 ;
+
+  /// A synthetic MC particle, standing for the LCIO object
+  struct SyntheticParticle {
+    int            _pdg {0} ;
+    double         _momentum[3] {0., 0., 0.} ;
+    double         _energy {0.} ;
+  };
+
+  /// A synthetic event: heap allocated particles, as in an LCIO collection
+  using SyntheticEvent = std::vector<std::unique_ptr<SyntheticParticle>> ;
+
+  /// Per-thread scratch state, as in a cloned processor. Aligned on a cache
+  /// line, so that the neighbouring states of the pool don't share one
+  struct alignas(64) WorkerState {
+    std::vector<int>           _pdgs {} ;
+    std::vector<Categories>    _categories {} ;
+    std::size_t                _nParticles {0} ;
+  };
+
+  /// Generate the synthetic events, with 100 to 1500 particles each
+  std::vector<SyntheticEvent> generateEvents() {
+    std::mt19937 generator( 42 ) ;
+    std::uniform_int_distribution<std::size_t> multiplicity( 100, 1500 ) ;
+    std::vector<SyntheticEvent> events( NEvents ) ;
+    unsigned int seed = 0 ;
+    for( auto &event : events ) {
+      const auto pdgs = bench::generatePdgSample( multiplicity( generator ), ++seed ) ;
+      for( const auto pdg : pdgs ) {
+        auto particle = std::make_unique<SyntheticParticle>() ;
+        particle->_pdg = pdg ;
+        event.push_back( std::move(particle) ) ;
+      }
+    }
+    return events ;
+  }
+
+  /// Process one event: gather the pdg ids, classify them and
+  /// publish the flags in a newly allocated output vector
+  void processEvent( const SyntheticEvent &event, WorkerState &state ) {
+    const auto nParticles = event.size() ;
+    state._pdgs.resize( nParticles ) ;
+    state._categories.resize( nParticles ) ;
+    for( std::size_t i=0 ; i<nParticles ; ++i ) {
+      state._pdgs[i] = event[i]->_pdg ;
+    }
+    PDGHelper::categories( state._pdgs.data(), state._categories.data(), nParticles ) ;
+    auto flags = std::make_unique<std::vector<int>>( state._categories.begin(), state._categories.end() ) ;
+    bench::doNotOptimize( flags->data() ) ;
+    state._nParticles += nParticles ;
+  }
+
+  /**
+   *  @brief  WorkerPool class
+   *
+   *  Processes the events with a given number of threads, the calling thread
+   *  included. The workers are started once, before the measurements, and
+   *  wait for work between them: the timed region holds the event processing
+   *  and the wake up of the workers, not the thread creation. The workers
+   *  pull chunks of events from a shared atomic counter, each with its own
+   *  scratch state
+   */
+  class WorkerPool {
+  public:
+    /// Constructor: start nthreads-1 workers, waiting for work
+    WorkerPool( const std::vector<SyntheticEvent> &events, std::size_t nthreads ) :
+      _events(events),
+      _states(nthreads) {
+      _threads.reserve( nthreads-1 ) ;
+      for( std::size_t t=1 ; t<nthreads ; ++t ) {
+        _threads.emplace_back( [this, t]() { workerLoop( _states[t] ) ; } ) ;
+      }
+    }
+
+    /// Destructor: stop and join the workers
+    ~WorkerPool() {
+      {
+        std::lock_guard<std::mutex> lock( _mutex ) ;
+        _stop = true ;
+      }
+      _startCondition.notify_all() ;
+      for( auto &thread : _threads ) {
+        thread.join() ;
+      }
+    }
+
+    WorkerPool( const WorkerPool & ) = delete ;
+    WorkerPool &operator=( const WorkerPool & ) = delete ;
+
+    /// Process n events, cycled over, and wait for all the workers to be done
+    void process( std::size_t n ) {
+      {
+        std::lock_guard<std::mutex> lock( _mutex ) ;
+        _nEvents = n ;
+        _next.store( 0, std::memory_order_relaxed ) ;
+        _pending = _threads.size() ;
+        ++_generation ;
+      }
+      _startCondition.notify_all() ;
+      processChunks( _states[0] ) ;
+      std::unique_lock<std::mutex> lock( _mutex ) ;
+      _doneCondition.wait( lock, [this]() { return 0 == _pending ; } ) ;
+    }
+
+  private:
+    /// Process chunks of events until all the events are claimed
+    void processChunks( WorkerState &state ) {
+      while( true ) {
+        const auto first = _next.fetch_add( EventChunk, std::memory_order_relaxed ) ;
+        if( first >= _nEvents ) {
+          break ;
+        }
+        const auto last = std::min( first + EventChunk, _nEvents ) ;
+        for( auto e=first ; e<last ; ++e ) {
+          processEvent( _events[ e % _events.size() ], state ) ;
+        }
+      }
+      bench::doNotOptimize( state._nParticles ) ;
+    }
+
+    /// The worker loop: wait for a new batch of events and process it
+    void workerLoop( WorkerState &state ) {
+      std::size_t generation = 0 ;
+      while( true ) {
+        {
+          std::unique_lock<std::mutex> lock( _mutex ) ;
+          _startCondition.wait( lock, [&]() { return _stop || _generation != generation ; } ) ;
+          if( _stop ) {
+            return ;
+          }
+          generation = _generation ;
+        }
+        processChunks( state ) ;
+        std::lock_guard<std::mutex> lock( _mutex ) ;
+        if( 0 == --_pending ) {
+          _doneCondition.notify_one() ;
+        }
+      }
+    }
+
+  private:
+    const std::vector<SyntheticEvent>   &_events ;
+    std::vector<WorkerState>             _states {} ;
+    std::vector<std::thread>             _threads {} ;
+    /// Guards the batch state, except the event counter
+    std::mutex                           _mutex {} ;
+    std::condition_variable              _startCondition {} ;
+    std::condition_variable              _doneCondition {} ;
+    std::atomic<std::size_t>             _next {0} ;
+    std::size_t                          _nEvents {0} ;
+    std::size_t                          _generation {0} ;
+    std::size_t                          _pending {0} ;
+    bool                                 _stop {false} ;
+  };
+
+  /// Number of events of the synthetic SIO file, and of elements per collection
+  constexpr std::size_t NSIOEvents = 128 ;
+  constexpr std::size_t NSIOElements = 1000 ;
+
+  /// Append a big endian 32 bits word
+  void writeUInt32( std::vector<uint8_t> &out, uint32_t value ) {
+    out.push_back( value >> 24 ) ; out.push_back( value >> 16 ) ; out.push_back( value >> 8 ) ; out.push_back( value ) ;
+  }
+
+  /// Append a name, padded to 4 bytes
+  void writeName( std::vector<uint8_t> &out, const std::string &name ) {
+    out.insert( out.end(), name.begin(), name.end() ) ;
+    out.resize( ( out.size() + 3 ) & ~std::size_t(3), 0 ) ;
+  }
+
+  /// Append an SIO block: header, name and padded payload
+  void writeBlock( std::vector<uint8_t> &out, const std::string &name, const std::vector<uint8_t> &payload ) {
+    const auto start = out.size() ;
+    writeUInt32( out, 0 ) ;
+    writeUInt32( out, 0xdeadbeef ) ;
+    writeUInt32( out, 0x00020010 ) ;
+    writeUInt32( out, name.size() ) ;
+    writeName( out, name ) ;
+    out.insert( out.end(), payload.begin(), payload.end() ) ;
+    const auto length = out.size() - start ;
+    out.resize( ( out.size() + 3 ) & ~std::size_t(3), 0 ) ;
+    out[start] = length >> 24 ; out[start+1] = length >> 16 ; out[start+2] = length >> 8 ; out[start+3] = length ;
+  }
+
+  /// Write a zlib compressed SIO record
+  void writeRecord( std::ofstream &file, const std::string &name, const std::vector<uint8_t> &data ) {
+    uLongf compressedLength = compressBound( data.size() ) ;
+    std::vector<uint8_t> compressed( compressedLength ) ;
+    if( Z_OK != compress2( compressed.data(), &compressedLength, data.data(), data.size(), Z_DEFAULT_COMPRESSION ) ) {
+      throw std::runtime_error( "can't compress the synthetic SIO record" ) ;
+    }
+    compressed.resize( ( compressedLength + 3 ) & ~uLongf(3), 0 ) ;
+    std::vector<uint8_t> header ;
+    writeUInt32( header, 24 + ( ( name.size() + 3 ) & ~std::size_t(3) ) ) ;
+    writeUInt32( header, 0xabadcafe ) ;
+    writeUInt32( header, 1 ) ;
+    writeUInt32( header, compressedLength ) ;
+    writeUInt32( header, data.size() ) ;
+    writeUInt32( header, name.size() ) ;
+    writeName( header, name ) ;
+    file.write( reinterpret_cast<const char*>( header.data() ), header.size() ) ;
+    file.write( reinterpret_cast<const char*>( compressed.data() ), compressed.size() ) ;
+  }
+
+  /// Write a synthetic LCIO file in a temporary file: compressed event header
+  /// and event records, with particle-like collections (type codes, quantized
+  /// momenta and energies, parent indices) that compress like real data.
+  /// Returns the file name
+  std::string writeSIOFile() {
+    std::string fileName = "/tmp/LCAnalysisToolsSIOBench.XXXXXX" ;
+    const int descriptor = ::mkstemp( &fileName[0] ) ;
+    if( descriptor < 0 ) {
+      throw std::runtime_error( "can't create the synthetic SIO file" ) ;
+    }
+    ::close( descriptor ) ;
+    std::ofstream file( fileName, std::ios::binary ) ;
+    std::mt19937 generator( 42 ) ;
+    std::exponential_distribution<float> momentum( 0.2f ) ;
+    std::uniform_int_distribution<int> type( 0, 15 ) ;
+    const std::vector<std::string> collections = { "MCParticle", "PandoraPFOs", "MarlinTrkTracks", "ECalBarrelCollection" } ;
+    std::vector<uint8_t> data, payload ;
+    for( std::size_t e=0 ; e<NSIOEvents ; ++e ) {
+      data.clear() ; payload.clear() ;
+      writeUInt32( payload, 1 ) ;
+      writeUInt32( payload, e ) ;
+      writeBlock( data, "EventHeader", payload ) ;
+      writeRecord( file, "LCEventHeader", data ) ;
+      data.clear() ;
+      for( const auto &name : collections ) {
+        payload.clear() ;
+        writeUInt32( payload, NSIOElements ) ;
+        for( std::size_t i=0 ; i<NSIOElements ; ++i ) {
+          writeUInt32( payload, type( generator ) ) ;
+          for( int c=0 ; c<4 ; ++c ) {
+            // 1 MeV precision: the low mantissa bits are zeros
+            const float value = std::round( momentum( generator ) * 1000.f ) / 1000.f ;
+            uint32_t bits = 0 ;
+            std::memcpy( &bits, &value, sizeof(bits) ) ;
+            writeUInt32( payload, bits ) ;
+          }
+          writeUInt32( payload, i / 4 ) ;
+        }
+        writeBlock( data, name, payload ) ;
+      }
+      writeRecord( file, "LCEvent", data ) ;
+    }
+    if( not file ) {
+      throw std::runtime_error( "can't write the synthetic SIO file" ) ;
+    }
+    return fileName ;
+  }
+
+  /// Consume an event: touch the first word of each collection
+  void consumeEvent( const uint8_t *data, const std::vector<io::SIOBlock> &blocks ) {
+    std::size_t sum = 0 ;
+    for( const auto &block : blocks ) {
+      sum += data[ block._offset ] + block._length ;
+    }
+    bench::doNotOptimize( sum ) ;
+  }
+
+  /// Read n events of the synthetic file, cycled over, inflating the records
+  /// on the reading thread as the LCIO reader does
+  void readEventsSerial( const io::SIOScanner &scanner, std::size_t n ) {
+    std::vector<uint8_t> buffer ;
+    std::vector<io::SIOBlock> blocks ;
+    for( std::size_t e=0 ; e<n ; ++e ) {
+      const auto data = scanner.collections( e % scanner.events().size(), buffer, blocks ) ;
+      consumeEvent( data, blocks ) ;
+    }
+  }
+
+  /// A ParallelSIOReader over the synthetic file, kept between the
+  /// measurements: the events in flight are not thrown away
+  struct ParallelReadState {
+    std::unique_ptr<io::ParallelSIOReader>   _reader {} ;
+    io::SIOEventData                         _event {} ;
+  };
+
+  /// Read n events of the synthetic file, cycled over, with a ParallelSIOReader
+  /// per pass over the file
+  void readEventsParallel( const io::SIOScanner &scanner, std::size_t n, std::size_t nthreads, ParallelReadState &state ) {
+    for( std::size_t e=0 ; e<n ; ++e ) {
+      if( nullptr == state._reader || not state._reader->next( state._event ) ) {
+        state._reader = std::make_unique<io::ParallelSIOReader>( scanner, nthreads ) ;
+        state._reader->next( state._event ) ;
+      }
+      consumeEvent( state._event._eventData, state._event._blocks ) ;
+    }
+  }
+}
+
+int main( int argc, char **argv ) {
+  try {
+    bench::BenchmarkHarness harness( "ThreadScaling", argc, argv ) ;
+    // build the shared index before measuring
+    PDGHelper::categories( 0 ) ;
+    const auto events = generateEvents() ;
+    std::cout << "classify/ cases: the MCParticleClassifier event loop replicated in this benchmark "
+      << "(not the MarlinMT processor), on a thread pool started before the measurements" << std::endl ;
+    // one operation is one event: ops/s are events/s. The pools are
+    // started after the harness, so that they inherit its perf counters
+    std::vector<std::unique_ptr<WorkerPool>> pools ;
+    for( const std::size_t nthreads : { 1, 2, 4, 8, 16 } ) {
+      pools.push_back( std::make_unique<WorkerPool>( events, nthreads ) ) ;
+      const auto pool = pools.back().get() ;
+      harness.add( "classify/threads:" + std::to_string( nthreads ), [pool]( std::size_t n ) {
+        pool->process( n ) ;
+      }) ;
+    }
+    // the file is mapped: it can be removed right away
+    const auto fileName = writeSIOFile() ;
+    const io::SIOScanner scanner( fileName ) ;
+    ::unlink( fileName.c_str() ) ;
+    harness.add( "sio/serial", [&scanner]( std::size_t n ) {
+      readEventsSerial( scanner, n ) ;
+    }) ;
+    // the readers are stopped before the scanner is destroyed
+    std::vector<std::unique_ptr<ParallelReadState>> readStates ;
+    for( const std::size_t nthreads : { 1, 2, 4, 8, 16 } ) {
+      readStates.push_back( std::make_unique<ParallelReadState>() ) ;
+      const auto state = readStates.back().get() ;
+      harness.add( "sio/threads:" + std::to_string( nthreads ), [&scanner, nthreads, state]( std::size_t n ) {
+        readEventsParallel( scanner, n, nthreads, *state ) ;
+      }) ;
+    }
+    return harness.run() ;
+  }
+  catch( const std::exception &e ) {
+    std::cerr << "Benchmark failed: " << e.what() << std::endl ;
+    return 1 ;
+  }
+}
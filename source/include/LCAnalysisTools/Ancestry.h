@@ -0,0 +1,134 @@
+
+#ifndef _LCANALYSISTOOLS_ANCESTRY_H
+#define _LCANALYSISTOOLS_ANCESTRY_H
+
+// -- std headers
+#include <cstdint>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/DecayTree.h>
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    /**
+     *  @brief  AncestorSelector struct
+     *
+     *  Selects decay tree nodes on their category and node flags.
+     *  A node matches if it has all the required flags and,
+     *  if any is given, at least one of the anyOf flags
+     */
+    struct AncestorSelector {
+      /// Category flags that must all be set
+      pdg::Categories            _requiredCategories {0} ;
+      /// Category flags of which one must be set (ignored if 0)
+      pdg::Categories            _anyOfCategories {0} ;
+      /// Node flags that must all be set
+      NodeFlags                  _requiredFlags {0} ;
+      /// Node flags that must not be set
+      NodeFlags                  _vetoedFlags {0} ;
+
+      /// Whether a node matches the selector
+      inline bool matches( pdg::Categories categories, NodeFlags flags ) const {
+        return ( ( categories & _requiredCategories ) == _requiredCategories )
+          && ( 0 == _anyOfCategories || 0 != ( categories & _anyOfCategories ) )
+          && ( ( flags & _requiredFlags ) == _requiredFlags )
+          && ( 0 == ( flags & _vetoedFlags ) ) ;
+      }
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  Ancestry class
+     *
+     *  Labels every node of a decay tree with its nearest ancestor
+     *  matching a selector, in a single pass over the nodes in topological
+     *  order. For each node, the answer is taken from its parents: a
+     *  matching parent, or the memoized nearest ancestor of a parent.
+     *  With several parents, the ancestor with the fewest generations in
+     *  between wins, then the one reached through the first parent.
+     *  Queries are then O(1). A node is not its own ancestor.
+     */
+    class Ancestry {
+    public:
+      /// Label the nodes of a tree
+      void build( const DecayTree &tree, const AncestorSelector &selector ) ;
+
+      /// Label the nodes of a tree, with a topological order computed beforehand
+      void build( const DecayTree &tree, const AncestorSelector &selector, const std::vector<NodeIndex> &order ) ;
+
+      /// Get the nearest matching ancestor of a node. NoNode if none
+      inline NodeIndex nearest( NodeIndex n ) const { return _nearest[n] ; }
+
+      /// Get the number of generations between a node and its nearest
+      /// matching ancestor (1 for a parent). 0 if there is none
+      inline uint16_t generations( NodeIndex n ) const { return _generations[n] ; }
+
+      /// Whether a node has a matching ancestor
+      inline bool hasAncestor( NodeIndex n ) const { return NoNode != _nearest[n] ; }
+
+      /// Get the number of labelled nodes
+      inline std::size_t size() const { return _nearest.size() ; }
+
+    private:
+      /// The nearest matching ancestor per node
+      std::vector<NodeIndex>     _nearest {} ;
+      /// The generations to the nearest matching ancestor per node
+      std::vector<uint16_t>      _generations {} ;
+      /// Build scratch: topological order
+      std::vector<NodeIndex>     _order {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  HeavyFlavourAncestry class
+     *
+     *  Tags every node of a decay tree with its nearest b-hadron and
+     *  c-hadron ancestors. Both labellings share one topological order.
+     */
+    class HeavyFlavourAncestry {
+    public:
+      /// The b-hadron selector: hadrons containing a b quark
+      static constexpr AncestorSelector BHadron = { pdg::category::Hadron | pdg::category::HasB, 0, 0, 0 } ;
+      /// The c-hadron selector: hadrons containing a c quark
+      static constexpr AncestorSelector CHadron = { pdg::category::Hadron | pdg::category::HasC, 0, 0, 0 } ;
+
+    public:
+      /// Tag the nodes of a tree
+      void build( const DecayTree &tree ) ;
+
+      /// Get the nearest b-hadron ancestor of a node. NoNode if none
+      inline NodeIndex bHadron( NodeIndex n ) const { return _bAncestry.nearest( n ) ; }
+
+      /// Get the nearest c-hadron ancestor of a node. NoNode if none
+      inline NodeIndex cHadron( NodeIndex n ) const { return _cAncestry.nearest( n ) ; }
+
+      /// Get the heavy flavour of a node origin: 5 if it descends from
+      /// a b-hadron, else 4 if it descends from a c-hadron, else 0
+      inline int flavour( NodeIndex n ) const {
+        return _bAncestry.hasAncestor( n ) ? 5 : ( _cAncestry.hasAncestor( n ) ? 4 : 0 ) ;
+      }
+
+      /// Get the b-hadron ancestry
+      inline const Ancestry &bAncestry() const { return _bAncestry ; }
+
+      /// Get the c-hadron ancestry
+      inline const Ancestry &cAncestry() const { return _cAncestry ; }
+
+    private:
+      Ancestry                   _bAncestry {} ;
+      Ancestry                   _cAncestry {} ;
+      std::vector<NodeIndex>     _order {} ;
+    };
+
+  }
+
+}
+
+#endif
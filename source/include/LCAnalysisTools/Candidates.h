@@ -0,0 +1,185 @@
+
+#ifndef _LCANALYSISTOOLS_CANDIDATES_H
+#define _LCANALYSISTOOLS_CANDIDATES_H
+
+// -- std headers
+#include <cstdint>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Kinematics.h>
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    /// A list of candidate daughters: indices of particles in the four-momentum
+    /// array of the event (e.g from PFOClassification::select()), pre-filtered
+    /// by category and charge, and an optional mass hypothesis
+    struct DaughterList {
+      /// The particle indices
+      const std::vector<uint32_t>       *_indices {nullptr} ;
+      /// The pdg id of the mass hypothesis. 0 to keep the particle energies
+      int                                _massHypothesis {0} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  CandidateArena class
+     *
+     *  Flat storage of the candidates built by a CandidateBuilder: the
+     *  daughter indices of all candidates in one array (one daughter per
+     *  list, in list order), the candidate four-momenta and masses in others.
+     *  Clearing keeps the memory, so an arena reused between events does not
+     *  allocate once it has grown to the largest event.
+     */
+    class CandidateArena {
+      friend class CandidateBuilder ;
+
+    public:
+      /// Remove all the candidates
+      void clear() ;
+
+      /// Get the number of candidates
+      inline std::size_t size() const { return _masses.size() ; }
+
+      /// Get the number of daughters per candidate
+      inline std::size_t nDaughters() const { return _nDaughters ; }
+
+      /// Get the daughter particle indices of a candidate, one per daughter list
+      inline const uint32_t *daughters( std::size_t i ) const { return _daughters.data() + i * _nDaughters ; }
+
+      /// Get the four-momentum of a candidate, with the daughter mass hypotheses
+      inline kinematics::FourMomentum momentum( std::size_t i ) const { return _momenta.get( i ) ; }
+
+      /// Get the mass of a candidate
+      inline double mass( std::size_t i ) const { return _masses[i] ; }
+
+      /// Get the four-momenta of the candidates
+      inline const kinematics::FourMomentumArray &momenta() const { return _momenta ; }
+
+      /// Get the masses of the candidates
+      inline const std::vector<double> &masses() const { return _masses ; }
+
+    private:
+      /// The number of daughters per candidate
+      std::size_t                        _nDaughters {0} ;
+      /// The daughter indices, nDaughters per candidate
+      std::vector<uint32_t>              _daughters {} ;
+      /// The candidate four-momenta
+      kinematics::FourMomentumArray      _momenta {} ;
+      /// The candidate masses
+      std::vector<double>                _masses {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  CandidateBuilder class
+     *
+     *  Builds the decay candidates with a mass in a window from k daughter
+     *  lists (Z -> l+ l-, D0 -> K- pi+, D+ -> K- pi+ pi+, ...), with pruning
+     *  instead of the O(N^k) scan of all combinations.
+     *  Each list is copied with its mass hypothesis and sorted by energy. The
+     *  first k-1 daughters are combined recursively, dropping the partial
+     *  combinations that can no longer reach the mass window: their mass plus
+     *  the lightest remaining daughters is above it, or their energy plus the
+     *  most energetic remaining daughters is below it. For the last daughter,
+     *  the mass bounds of a pair (P, q) as a function of the q energy,
+     *      m2 <= m2(P) + m2(q)max + 4 E(P) E(q)
+     *      m2 >= m2(P) + m2(q)min + 2 E(q) (E(P) - |p(P)|)
+     *  give the range of energies that can fall in the window, found by binary
+     *  search in the sorted list. The masses over that range are computed by a
+     *  vectorizable kernel, and the candidates in the window written to the arena.
+     *  A particle is used once per candidate. When the same list (same indices
+     *  and hypothesis) is given twice, the daughters from these lists are taken
+     *  in increasing particle index, so that each combination is built once.
+     */
+    class CandidateBuilder {
+    public:
+      /// Constructor with the candidate mass window, in GeV
+      CandidateBuilder( double minMass, double maxMass ) ;
+
+      /// Set the candidate mass window, in GeV
+      void setMassWindow( double minMass, double maxMass ) ;
+
+      /// Build the candidates from two or more daughter lists of the particles of an
+      /// event. The arena is cleared first. Returns the number of candidates
+      std::size_t build( const kinematics::FourMomentumArray &particles, const std::vector<DaughterList> &lists,
+        CandidateArena &candidates ) ;
+
+    private:
+      /**
+       *  @brief  SortedList struct
+       *
+       *  A daughter list with its mass hypothesis, sorted by increasing energy
+       */
+      struct SortedList {
+        /// The four-momenta, sorted by energy
+        kinematics::FourMomentumArray    _momenta {} ;
+        /// The particle indices, in the same order
+        std::vector<uint32_t>            _indices {} ;
+        /// The lowest and highest squared masses and the highest energy
+        double                           _minMass2 {0.} ;
+        double                           _maxMass2 {0.} ;
+        double                           _maxEnergy {0.} ;
+        /// The closest previous list with the same particles and hypothesis, itself if none
+        std::size_t                      _sameAs {0} ;
+      };
+
+      /// Sort a daughter list
+      void sortList( const kinematics::FourMomentumArray &particles, const DaughterList &list, SortedList &sorted ) ;
+
+      /// Combine a partial candidate with the daughters of a list, recursively,
+      /// writing the candidates in the window to the arena
+      void combine( std::size_t level, const kinematics::FourMomentum &partial, CandidateArena &candidates ) ;
+
+      /// Combine a partial candidate with the daughters of the last list
+      void combineLast( const kinematics::FourMomentum &partial, CandidateArena &candidates ) ;
+
+      /// Whether a particle can be the daughter of a level, given the partial candidate
+      inline bool accepts( std::size_t level, uint32_t index ) const ;
+
+    private:
+      /// The mass window
+      double                             _minMass {0.} ;
+      double                             _maxMass {0.} ;
+      /// The sorted daughter lists
+      std::vector<SortedList>            _lists {} ;
+      /// The number of lists of the current build
+      std::size_t                        _nlists {0} ;
+      /// Per level: the lightest mass and highest energy sums of the next levels
+      std::vector<double>                _remainingMinMass {} ;
+      std::vector<double>                _remainingMaxEnergy {} ;
+      /// The daughters of the current partial candidate
+      std::vector<uint32_t>              _current {} ;
+      /// Scratch: unsorted list, sort order and squared masses of the last level
+      kinematics::FourMomentumArray      _unsorted {} ;
+      std::vector<uint32_t>              _order {} ;
+      std::vector<double>                _mass2 {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    inline bool CandidateBuilder::accepts( std::size_t level, uint32_t index ) const {
+      const auto sameAs = _lists[level]._sameAs ;
+      if( sameAs != level && index <= _current[sameAs] ) {
+        return false ;
+      }
+      for( std::size_t l=0 ; l<level ; ++l ) {
+        if( _current[l] == index ) {
+          return false ;
+        }
+      }
+      return true ;
+    }
+
+  }
+
+}
+
+#endif
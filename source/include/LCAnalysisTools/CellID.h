@@ -0,0 +1,168 @@
+
+#ifndef _LCANALYSISTOOLS_CELLID_H
+#define _LCANALYSISTOOLS_CELLID_H
+
+// -- std headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace EVENT {
+  class LCCollection ;
+}
+
+namespace lc_analysis {
+
+  namespace hits {
+
+    /// Combine the two 32 bits words of an LCIO cell id
+    inline uint64_t cellID( int cellID0, int cellID1 ) {
+      return static_cast<uint32_t>( cellID0 ) | ( static_cast<uint64_t>( static_cast<uint32_t>( cellID1 ) ) << 32 ) ;
+    }
+
+    /**
+     *  @brief  CellIDField struct
+     *
+     *  A field of a cell id encoding: bits [offset, offset + width), signed
+     *  (two's complement) or not
+     */
+    struct CellIDField {
+      std::string                _name {} ;
+      uint32_t                   _offset {0} ;
+      uint32_t                   _width {0} ;
+      bool                       _signed {false} ;
+
+      /// Get the smallest value of the field
+      inline int64_t minValue() const { return _signed ? -( int64_t(1) << ( _width - 1 ) ) : 0 ; }
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  CellIDDecoder class
+     *
+     *  Decoder of 64 bits cell ids, with the LCIO (BitField64) encoding
+     *  strings, e.g "system:5,side:-2,layer:9,x:32:-16,y:-16": comma
+     *  separated fields "name:width" or "name:offset:width", following each
+     *  other when the offset is omitted, signed if the width is negative.
+     *  The encoding is parsed once, when it changes (e.g per collection), into
+     *  per field shift and mask tables. A field value is then two shifts and a
+     *  mask, with no string lookup or virtual call: the batch decoding and the
+     *  energy histograms are plain loops over caller provided arrays, without
+     *  allocation.
+     *  The histogram bins of a field are its values, from minValue(): a field
+     *  of width w has 2^w bins.
+     */
+    class CellIDDecoder {
+    public:
+      /// Default constructor, without fields
+      CellIDDecoder() = default ;
+
+      /// Constructor with an encoding string
+      explicit CellIDDecoder( const std::string &encoding ) ;
+
+      /// Set the encoding string. Only parsed if it differs from the current one.
+      /// Throws on invalid encodings
+      void setEncoding( const std::string &encoding ) ;
+
+      /// Set the encoding from the CellIDEncoding parameter of a hit collection.
+      /// Throws if the collection has none
+      void setEncoding( const EVENT::LCCollection *hits ) ;
+
+      /// Get the encoding string
+      inline const std::string &encoding() const { return _encoding ; }
+
+      /// Get the number of fields
+      inline std::size_t nFields() const { return _fields.size() ; }
+
+      /// Get a field
+      inline const CellIDField &field( std::size_t index ) const { return _fields[index] ; }
+
+      /// Get the index of a field from its name. Throws if not in the encoding
+      std::size_t index( const std::string &name ) const ;
+
+      /// Get the value of a field of a cell id
+      inline int64_t value( uint64_t cellID, std::size_t field ) const ;
+
+      /// Decode a field of n cell ids
+      void decode( const uint64_t *cellIDs, std::size_t n, std::size_t field, int64_t *values ) const ;
+
+      /// Get the number of histogram bins of a field, 2^width. Throws for
+      /// fields wider than MaxHistogramWidth bits
+      std::size_t nBins( std::size_t field ) const ;
+
+      /// Add the energies of n hits to the histogram of a field: the energy
+      /// of a hit goes to the bin of its field value. The nBins( field ) bins
+      /// are not reset
+      void histogram( const uint64_t *cellIDs, const double *energies, std::size_t n, std::size_t field, double *bins ) const ;
+
+      /// Get the field value of a histogram bin
+      inline int64_t binValue( std::size_t field, std::size_t bin ) const { return _fields[field].minValue() + static_cast<int64_t>( bin ) ; }
+
+      /// The widest field with a histogram (2^20 bins)
+      static constexpr uint32_t MaxHistogramWidth = 20 ;
+
+    private:
+      /// The encoding string and the fields
+      std::string                        _encoding {} ;
+      std::vector<CellIDField>           _fields {} ;
+      /// Per field: the mask of the field after a right shift by its offset,
+      /// and the sign bit (0 for unsigned fields)
+      std::vector<uint64_t>              _masks {} ;
+      std::vector<uint64_t>              _signBits {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  HitArray class
+     *
+     *  Cell ids and energies of a collection of hits, in structure of arrays
+     *  layout, reused between events
+     */
+    class HitArray {
+    public:
+      /// Fill the cell ids and energies (deposited energies for tracker hits) of
+      /// a CalorimeterHit, SimCalorimeterHit, TrackerHit or SimTrackerHit collection.
+      /// Throws for other collection types
+      void fill( const EVENT::LCCollection *hits ) ;
+
+      /// Add a hit
+      inline void push_back( uint64_t cellID, double energy ) { _cellIDs.push_back( cellID ) ; _energies.push_back( energy ) ; }
+
+      /// Remove all the hits
+      void clear() ;
+
+      /// Get the number of hits
+      inline std::size_t size() const { return _cellIDs.size() ; }
+
+      /// Get the arrays
+      inline const uint64_t *cellIDs() const { return _cellIDs.data() ; }
+      inline const double *energies() const { return _energies.data() ; }
+
+    private:
+      /// Fill the hits of a collection (typed), with their energy getter
+      template <typename T, float (T::*Energy)() const>
+      void fillElements( const EVENT::LCCollection *hits ) ;
+
+    private:
+      std::vector<uint64_t>      _cellIDs {} ;
+      std::vector<double>        _energies {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    inline int64_t CellIDDecoder::value( uint64_t cellID, std::size_t field ) const {
+      // sign extension without branch: (v ^ s) - s, with s the sign bit (0 if unsigned)
+      const uint64_t bits = ( cellID >> _fields[field]._offset ) & _masks[field] ;
+      return static_cast<int64_t>( ( bits ^ _signBits[field] ) - _signBits[field] ) ;
+    }
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,138 @@
+
+#ifndef _LCANALYSISTOOLS_COMMONANCESTOR_H
+#define _LCANALYSISTOOLS_COMMONANCESTOR_H
+
+// -- std headers
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/DecayTree.h>
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    /// The lowest common ancestor of two nodes, with its particle
+    struct CommonAncestor {
+      /// The ancestor node. NoNode if the nodes have no common ancestor
+      NodeIndex                  _node {NoNode} ;
+      /// The particle of the ancestor. Invalid if not in the PDG table
+      pdg::ParticleRef           _particle {} ;
+      /// The category flags of the ancestor
+      pdg::Categories            _categories {0} ;
+
+      /// Whether a common ancestor was found
+      inline bool valid() const { return NoNode != _node ; }
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  CommonAncestorIndex class
+     *
+     *  Lowest common ancestor queries on a decay tree. The decay graph is
+     *  reduced to the forest of first parents (see DecayTree::firstParent()),
+     *  which is walked once to record its Euler tour and the depth of each
+     *  visited node. A sparse table of range minima over the tour depths,
+     *  built in O(N log N), then answers queries in O(1): the common ancestor
+     *  of two nodes is the shallowest node visited between their first visits.
+     *  A node is an ancestor of itself. Nodes of different first parent trees,
+     *  or not reachable from a root (cycles), have no common ancestor.
+     *  The index keeps a pointer to the tree, which must outlive it.
+     */
+    class CommonAncestorIndex {
+    public:
+      /// Build the index of a tree
+      void build( const DecayTree &tree ) ;
+
+      /// Get the lowest common ancestor node of two nodes. NoNode if none
+      inline NodeIndex lca( NodeIndex u, NodeIndex v ) const ;
+
+      /// Get the lowest common ancestor of two nodes, with its particle
+      inline CommonAncestor find( NodeIndex u, NodeIndex v ) const ;
+
+      /// Get the depth of a node in its first parent tree (0 for roots).
+      /// Unreachable nodes have the maximum depth
+      inline uint32_t depth( NodeIndex n ) const { return _depths[n] ; }
+
+      /// Get the number of first parent generations between two nodes,
+      /// through their common ancestor. -1 if they have none
+      inline int distance( NodeIndex u, NodeIndex v ) const ;
+
+      /// Get the number of indexed nodes
+      inline std::size_t size() const { return _depths.size() ; }
+
+      /// Get the memory used by the index, in bytes
+      std::size_t memoryBytes() const ;
+
+    private:
+      /// Pack a depth and a node in a sparse table entry, ordered by depth
+      static inline uint64_t entry( uint32_t depth, NodeIndex n ) { return ( uint64_t(depth) << 32 ) | n ; }
+
+    private:
+      /// The indexed tree
+      const DecayTree           *_tree {nullptr} ;
+      /// The depth of each node
+      std::vector<uint32_t>      _depths {} ;
+      /// The root of the first parent tree of each node
+      std::vector<NodeIndex>     _roots {} ;
+      /// The position of the first visit of each node in the Euler tour
+      std::vector<uint32_t>      _firstVisits {} ;
+      /// The sparse table: level k holds the minimum entry of each tour range of size 2^k
+      std::vector<uint64_t>      _table {} ;
+      /// The offset of each level in the sparse table
+      std::vector<std::size_t>   _levelOffsets {} ;
+      /// Floor of log2, for range sizes up to the tour length
+      std::vector<uint8_t>       _log2 {} ;
+      /// Build scratch: first parent children, in CSR layout, and DFS stack
+      std::vector<NodeIndex>     _childOffsets {} ;
+      std::vector<NodeIndex>     _children {} ;
+      std::vector<std::pair<NodeIndex, NodeIndex>> _stack {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    inline NodeIndex CommonAncestorIndex::lca( NodeIndex u, NodeIndex v ) const {
+      if( NoNode == _roots[u] || _roots[u] != _roots[v] ) {
+        return NoNode ;
+      }
+      auto first = _firstVisits[u] ;
+      auto last = _firstVisits[v] ;
+      if( first > last ) {
+        std::swap( first, last ) ;
+      }
+      const auto level = _log2[ last - first + 1 ] ;
+      const uint64_t *row = _table.data() + _levelOffsets[level] ;
+      const auto lhs = row[first] ;
+      const auto rhs = row[ last + 1 - ( std::size_t(1) << level ) ] ;
+      return static_cast<NodeIndex>( ( lhs < rhs ? lhs : rhs ) & 0xffffffffu ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline CommonAncestor CommonAncestorIndex::find( NodeIndex u, NodeIndex v ) const {
+      CommonAncestor ancestor ;
+      ancestor._node = lca( u, v ) ;
+      if( NoNode != ancestor._node ) {
+        ancestor._particle = _tree->particle( ancestor._node ) ;
+        ancestor._categories = _tree->categories( ancestor._node ) ;
+      }
+      return ancestor ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline int CommonAncestorIndex::distance( NodeIndex u, NodeIndex v ) const {
+      const auto ancestor = lca( u, v ) ;
+      return ( NoNode == ancestor ) ? -1 : static_cast<int>( _depths[u] + _depths[v] - 2 * _depths[ancestor] ) ;
+    }
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,170 @@
+
+#ifndef _LCANALYSISTOOLS_DECAYCENSUS_H
+#define _LCANALYSISTOOLS_DECAYCENSUS_H
+
+// -- std headers
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/DecayTree.h>
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    /// Id of a decay mode in a DecayModeTable
+    using DecayModeId = uint32_t ;
+
+    /// The id returned for decay modes not in a table
+    static constexpr DecayModeId NoDecayMode = std::numeric_limits<DecayModeId>::max() ;
+
+    /**
+     *  @brief  DecayModeTable class
+     *
+     *  Hash-consing table of canonical decay signatures. Each distinct
+     *  signature (parent pdg id and sorted daughter pdg ids) is stored once,
+     *  flat, and gets a compact id, in insertion order. Lookups go through
+     *  an open addressing hash table of ids.
+     */
+    class DecayModeTable {
+    public:
+      /// Canonicalize a decay in place: the daughters are sorted and the decay
+      /// is replaced by its charge conjugate if the conjugate comes first. The
+      /// first one has a positive parent id, or, for self-conjugate parents,
+      /// the lower sorted daughter list. Returns whether the decay was conjugated
+      static bool canonicalize( int &parent, std::vector<int> &daughters ) ;
+
+      /// Get the id of a canonical decay, inserting it if new
+      DecayModeId intern( int parent, const std::vector<int> &daughters ) ;
+
+      /// Get the id of a canonical decay. NoDecayMode if not in the table
+      DecayModeId find( int parent, const std::vector<int> &daughters ) const ;
+
+      /// Get the number of decay modes
+      inline std::size_t size() const { return _hashes.size() ; }
+
+      /// Get the parent pdg id of a decay mode
+      inline int parent( DecayModeId id ) const { return _pdgs[ _offsets[id] ] ; }
+
+      /// Get the number of daughters of a decay mode
+      inline std::size_t nDaughters( DecayModeId id ) const { return _offsets[id+1] - _offsets[id] - 1 ; }
+
+      /// Get the sorted daughter pdg ids of a decay mode
+      inline const int *daughters( DecayModeId id ) const { return _pdgs.data() + _offsets[id] + 1 ; }
+
+      /// Get a printable form of a decay mode, e.g "B0 -> D- pi+ [cc]"
+      std::string str( DecayModeId id ) const ;
+
+      /// Remove all the decay modes
+      void clear() ;
+
+      /// Get the memory used by the table, in bytes
+      std::size_t memoryBytes() const ;
+
+    private:
+      /// Get the hash of a decay
+      static uint64_t hash( int parent, const int *daughters, std::size_t n ) ;
+
+      /// Whether a decay mode equals a decay
+      bool equals( DecayModeId id, int parent, const int *daughters, std::size_t n ) const ;
+
+      /// Get the slot of a decay in the hash table, empty or holding the decay
+      std::size_t slot( uint64_t h, int parent, const int *daughters, std::size_t n ) const ;
+
+      /// Resize the hash table and re-insert all the ids
+      void rehash( std::size_t nslots ) ;
+
+    private:
+      /// The decay modes, flat: parent pdg id followed by the daughters
+      std::vector<int>           _pdgs {} ;
+      /// The offsets of the decay modes in _pdgs, plus the end offset
+      std::vector<uint32_t>      _offsets {0} ;
+      /// The hash of each decay mode
+      std::vector<uint64_t>      _hashes {} ;
+      /// The hash table slots, holding ids or NoDecayMode. Power of 2 size
+      std::vector<DecayModeId>   _slots {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  DecayCensus class
+     *
+     *  Counts the exclusive decay modes of the particles over many events.
+     *  Each thread fills its own Shard without locking and merges it into
+     *  the census, e.g at the end of its event loop. The merge is thread
+     *  safe, the accessors must only be called once all merges are done.
+     */
+    class DecayCensus {
+    public:
+      /**
+       *  @brief  Shard class
+       *
+       *  Per-thread part of a census: its own decay mode table and counts
+       */
+      class Shard {
+      public:
+        /// Count the decays of a tree. A decay is counted for each node with
+        /// daughters and none of the vetoed flags. Daughters created in the
+        /// simulation are not part of the decay. Counts one event
+        void add( const DecayTree &tree, NodeFlags vetoed = node::CreatedInSimulation | node::UnknownParticle ) ;
+
+        /// Count one decay, canonicalized first. Returns its id
+        DecayModeId add( int parent, const std::vector<int> &daughters, uint64_t count = 1 ) ;
+
+        /// Get the decay modes
+        inline const DecayModeTable &modes() const { return _modes ; }
+
+        /// Get the count of a decay mode
+        inline uint64_t count( DecayModeId id ) const { return _counts[id] ; }
+
+        /// Get the number of counted events
+        inline uint64_t nEvents() const { return _nEvents ; }
+
+        /// Reset the shard
+        void clear() ;
+
+      private:
+        friend class DecayCensus ;
+        DecayModeTable             _modes {} ;
+        std::vector<uint64_t>      _counts {} ;
+        uint64_t                   _nEvents {0} ;
+        /// Scratch daughter list
+        std::vector<int>           _daughters {} ;
+      };
+
+    public:
+      /// Merge a shard in the census. Thread safe
+      void merge( const Shard &shard ) ;
+
+      /// Get the decay modes
+      inline const DecayModeTable &modes() const { return _total._modes ; }
+
+      /// Get the count of a decay mode
+      inline uint64_t count( DecayModeId id ) const { return _total._counts[id] ; }
+
+      /// Get the number of counted events
+      inline uint64_t nEvents() const { return _total._nEvents ; }
+
+      /// Get the decay mode ids sorted by parent (absolute pdg id), then by decreasing count
+      std::vector<DecayModeId> sortedModes() const ;
+
+      /// Print the decay modes with their count and branching fraction per parent
+      void print( std::ostream &stream ) const ;
+
+    private:
+      Shard                      _total {} ;
+      std::mutex                 _mutex {} ;
+    };
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+
+#ifndef _LCANALYSISTOOLS_DECAYPATTERN_H
+#define _LCANALYSISTOOLS_DECAYPATTERN_H
+
+// -- std headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/DecayTree.h>
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    /**
+     *  @brief  DecayPattern class
+     *
+     *  A decay chain pattern, parsed once and compiled to a flat array of
+     *  pdg ids, then matched against decay trees. The syntax is:
+     *
+     *    "B0 -> (D- -> K+ pi- pi-) pi+"
+     *    "[B- -> D0 pi- ...]cc"
+     *
+     *  Tokens are separated by spaces. Particles are given by their name in
+     *  the PDG table or by their pdg id. A sub-decay goes in parentheses.
+     *  "..." allows additional daughters, otherwise the daughter lists must
+     *  match exactly. Daughters are unordered. The "[...]cc" wrapper also
+     *  matches the charge conjugate chain.
+     *
+     *  Tree nodes are first pruned on the category flags of the pattern
+     *  particles (shared by a particle and its conjugate) and on their
+     *  number of daughters, then matched by backtracking over the daughters.
+     *  A tree node gives at most one match, the first one found.
+     */
+    class DecayPattern {
+    public:
+      /// A particle of the compiled pattern
+      struct Node {
+        /// The pdg id, for the pattern and for its charge conjugate
+        int                        _pdgs[2] {0, 0} ;
+        /// The category flags a matching tree node must have
+        pdg::Categories            _categories {0} ;
+        /// The index of the first daughter in the daughter array
+        uint16_t                   _firstDaughter {0} ;
+        /// The number of daughters. 0 matches any decay
+        uint16_t                   _nDaughters {0} ;
+        /// Whether additional daughters are allowed
+        bool                       _inclusive {false} ;
+      };
+
+    public:
+      /// Default constructor, empty pattern matching nothing
+      DecayPattern() = default ;
+
+      /// Constructor, compiles a pattern. Throws std::runtime_error on syntax errors
+      explicit DecayPattern( const std::string &pattern ) ;
+
+      /// Compile a pattern. Throws std::runtime_error on syntax errors
+      void compile( const std::string &pattern ) ;
+
+      /// Find the matches of the pattern in a tree. For each match, size() node
+      /// indices are appended to matches, in the order of the particles in the
+      /// pattern string. Returns the number of matches
+      std::size_t match( const DecayTree &tree, std::vector<NodeIndex> &matches ) const ;
+
+      /// Whether the pattern matches a tree node, as root of the chain
+      bool matches( const DecayTree &tree, NodeIndex n ) const ;
+
+      /// Get the pattern string
+      inline const std::string &str() const { return _pattern ; }
+
+      /// Get the number of particles in the pattern
+      inline std::size_t size() const { return _nodes.size() ; }
+
+      /// Get a particle of the compiled pattern, in pattern string order
+      inline const Node &node( std::size_t i ) const { return _nodes[i] ; }
+
+      /// Whether the charge conjugate chain is matched too
+      inline bool chargeConjugate() const { return _chargeConjugate ; }
+
+    private:
+      /// Match a tree node against a pattern node, filling the assigned nodes
+      bool matchNode( const DecayTree &tree, NodeIndex n, std::size_t p, std::size_t variant, NodeIndex *assigned ) const ;
+
+      /// Match the daughters of a pattern node, from the i-th one on
+      bool matchDaughters( const DecayTree &tree, NodeSpan daughters, const Node &node, std::size_t i, uint64_t used, std::size_t variant, NodeIndex *assigned ) const ;
+
+    private:
+      /// The pattern string
+      std::string                _pattern {} ;
+      /// The particles, in pattern string order
+      std::vector<Node>          _nodes {} ;
+      /// The daughters of each particle, contiguous, sub-decays first
+      std::vector<uint16_t>      _daughters {} ;
+      /// The number of pdg id variants to try (2 for charge conjugate patterns)
+      std::size_t                _nVariants {1} ;
+      /// Whether the pattern was given within "[...]cc"
+      bool                       _chargeConjugate {false} ;
+    };
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,198 @@
+
+#ifndef _LCANALYSISTOOLS_DECAYTREE_H
+#define _LCANALYSISTOOLS_DECAYTREE_H
+
+// -- std headers
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/PDGIndex.h>
+
+namespace EVENT {
+  class LCCollection ;
+  class LCEvent ;
+  class MCParticle ;
+}
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    /// Index of a node in a decay tree, same as the index in the MCParticle collection
+    using NodeIndex = uint32_t ;
+
+    /// The index returned for particles not in the tree
+    static constexpr NodeIndex NoNode = std::numeric_limits<NodeIndex>::max() ;
+
+    /// Node flags, combined in a bit mask
+    using NodeFlags = uint16_t ;
+
+    /// The decay tree node flags, from the graph structure and the MCParticle status
+    namespace node {
+      static constexpr NodeFlags Root                 = 1u << 0 ;   ///< no parent
+      static constexpr NodeFlags Leaf                 = 1u << 1 ;   ///< no daughter
+      static constexpr NodeFlags GeneratorStable      = 1u << 2 ;   ///< generator status 1
+      static constexpr NodeFlags GeneratorDecayed     = 1u << 3 ;   ///< generator status 2
+      static constexpr NodeFlags GeneratorDocumentation = 1u << 4 ; ///< generator status 3
+      static constexpr NodeFlags CreatedInSimulation  = 1u << 5 ;   ///< created by the detector simulation
+      static constexpr NodeFlags Backscatter          = 1u << 6 ;   ///< backscattered from a calorimeter shower
+      static constexpr NodeFlags DecayedInTracker     = 1u << 7 ;   ///< decayed in the tracking region
+      static constexpr NodeFlags DecayedInCalorimeter = 1u << 8 ;   ///< decayed in the calorimeter
+      static constexpr NodeFlags LeftDetector         = 1u << 9 ;   ///< left the world volume
+      static constexpr NodeFlags Stopped              = 1u << 10 ;  ///< stopped in the detector
+      static constexpr NodeFlags Overlay              = 1u << 11 ;  ///< from an overlaid background event
+      static constexpr NodeFlags UnknownParticle      = 1u << 12 ;  ///< pdg id not in the PDG table
+    }
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  NodeSpan class
+     *
+     *  A contiguous, read-only range of node indices
+     */
+    class NodeSpan {
+    public:
+      NodeSpan( const NodeIndex *b, const NodeIndex *e ) : _begin(b), _end(e) {}
+      inline const NodeIndex *begin() const { return _begin ; }
+      inline const NodeIndex *end() const { return _end ; }
+      inline std::size_t size() const { return _end - _begin ; }
+      inline bool empty() const { return _begin == _end ; }
+      inline NodeIndex operator[]( std::size_t i ) const { return _begin[i] ; }
+
+    private:
+      const NodeIndex           *_begin {nullptr} ;
+      const NodeIndex           *_end {nullptr} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  DecayTree class
+     *
+     *  Flat representation of the MC truth decay graph of an event.
+     *  Node i is particle i of the MCParticle collection. The parents
+     *  and daughters of all nodes are stored in two contiguous arrays
+     *  in compressed sparse row (CSR) layout, indexed by offset arrays.
+     *  Each node carries its pdg id, a reference to the PDG table, the
+     *  particle category flags and the node flags, in separate arrays.
+     *  The daughters of a node are sorted by node index, the parents
+     *  keep the MCParticle order.
+     *  The arrays keep their memory between builds, so that a tree
+     *  object can be reused from event to event without allocating.
+     */
+    class DecayTree {
+    public:
+      /// A (parent, daughter) edge of the decay graph
+      using Edge = std::pair<NodeIndex, NodeIndex> ;
+
+    public:
+      /// Get the decay tree of an MCParticle collection in an event, cached
+      /// per thread: the tree is built on the first call for a given event
+      /// and collection, and shared by the subsequent calls (e.g. from other
+      /// processors) in the same thread. The reference is valid until the
+      /// same collection is requested for another event in this thread
+      static const DecayTree &eventTree( const EVENT::LCEvent *event, const std::string &collectionName ) ;
+
+      /// Build the tree from an MCParticle collection
+      void build( const EVENT::LCCollection *mcParticles ) ;
+
+      /// Build the tree from pdg ids, node status flags and (parent, daughter)
+      /// edges. The Root, Leaf and UnknownParticle flags are set by the builder.
+      /// Edges pointing outside the tree are ignored
+      void build( const std::vector<int> &pdgs, const std::vector<NodeFlags> &flags, const std::vector<Edge> &edges ) ;
+
+      /// Remove all nodes. The memory is kept
+      void clear() ;
+
+      /// Get the number of nodes
+      inline std::size_t size() const { return _pdgs.size() ; }
+
+      /// Whether the tree has no node
+      inline bool empty() const { return _pdgs.empty() ; }
+
+      /// Get the pdg id of a node
+      inline int pdg( NodeIndex n ) const { return _pdgs[n] ; }
+
+      /// Get the PDG table reference of a node. Invalid if not in the table
+      inline pdg::ParticleRef particle( NodeIndex n ) const { return _particles[n] ; }
+
+      /// Get the particle category flags of a node
+      inline pdg::Categories categories( NodeIndex n ) const { return _categories[n] ; }
+
+      /// Get the node flags
+      inline NodeFlags flags( NodeIndex n ) const { return _flags[n] ; }
+
+      /// Get the parents of a node
+      inline NodeSpan parents( NodeIndex n ) const {
+        return NodeSpan( _parents.data() + _parentOffsets[n], _parents.data() + _parentOffsets[n+1] ) ;
+      }
+
+      /// Get the daughters of a node
+      inline NodeSpan daughters( NodeIndex n ) const {
+        return NodeSpan( _daughters.data() + _daughterOffsets[n], _daughters.data() + _daughterOffsets[n+1] ) ;
+      }
+
+      /// Get the first parent of a node. NoNode for roots
+      inline NodeIndex firstParent( NodeIndex n ) const {
+        return ( _parentOffsets[n] == _parentOffsets[n+1] ) ? NoNode : _parents[ _parentOffsets[n] ] ;
+      }
+
+      /// Get the root nodes, sorted by index
+      inline const std::vector<NodeIndex> &roots() const { return _roots ; }
+
+      /// Get the whole category flag array, one entry per node
+      inline const std::vector<pdg::Categories> &categoryArray() const { return _categories ; }
+
+      /// Get the whole node flag array, one entry per node
+      inline const std::vector<NodeFlags> &flagArray() const { return _flags ; }
+
+      /// Get the nodes in topological order: each node comes after all its parents.
+      /// Nodes on a cycle of the graph (invalid MC history) are appended at the end
+      void topologicalOrder( std::vector<NodeIndex> &order ) const ;
+
+      /// Get the MCParticle of a node. nullptr if not built from a collection
+      inline const EVENT::MCParticle *mcParticle( NodeIndex n ) const {
+        return _mcParticles.empty() ? nullptr : _mcParticles[n] ;
+      }
+
+      /// Get the node of an MCParticle. NoNode if not in the tree
+      NodeIndex node( const EVENT::MCParticle *mcParticle ) const ;
+
+      /// Get the memory used by the tree arrays, in bytes
+      std::size_t memoryBytes() const ;
+
+    private:
+      /// Fill the per-node arrays from the pdg ids and the CSR arrays from the edges
+      void buildArrays() ;
+
+    private:
+      /// Per-node arrays
+      std::vector<int>                          _pdgs {} ;
+      std::vector<pdg::ParticleRef>             _particles {} ;
+      std::vector<pdg::Categories>              _categories {} ;
+      std::vector<NodeFlags>                    _flags {} ;
+      /// CSR parent and daughter arrays, with n+1 offsets
+      std::vector<NodeIndex>                    _parentOffsets {} ;
+      std::vector<NodeIndex>                    _parents {} ;
+      std::vector<NodeIndex>                    _daughterOffsets {} ;
+      std::vector<NodeIndex>                    _daughters {} ;
+      std::vector<NodeIndex>                    _roots {} ;
+      /// The MCParticles of the nodes, and the MCParticle to node map sorted by address
+      std::vector<const EVENT::MCParticle*>     _mcParticles {} ;
+      std::vector<std::pair<const EVENT::MCParticle*, NodeIndex>> _sortedMCParticles {} ;
+      /// Build scratch: the graph edges
+      std::vector<Edge>                         _edges {} ;
+    };
+
+  }
+
+}
+
+#endif
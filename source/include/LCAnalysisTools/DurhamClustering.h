@@ -0,0 +1,139 @@
+
+#ifndef _LCANALYSISTOOLS_DURHAMCLUSTERING_H
+#define _LCANALYSISTOOLS_DURHAMCLUSTERING_H
+
+// -- std headers
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Kinematics.h>
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    /**
+     *  @brief  DurhamClustering class
+     *
+     *  Exclusive Durham (e+e- kt) jet clustering, with the E recombination
+     *  scheme. The distance of two pseudo-jets is
+     *      y_ij = 2 min( E_i^2, E_j^2 ) ( 1 - cos theta_ij ) / E_vis^2
+     *  Each clustering step merges the closest pair, found with the nearest
+     *  neighbour heuristic: the closest pair (i, j) with E_i <= E_j always has
+     *  j as the angular nearest neighbour of i. The angular nearest neighbour
+     *  of each pseudo-jet and its distance are cached, so a step only searches
+     *  the minimum of the cached distances and updates the neighbours of the
+     *  merged pair: O(N^2) overall instead of O(N^3). Pseudo-jets are kept in
+     *  structure of arrays layout (momenta, unit directions), compacted at each
+     *  step, so that the neighbour searches are vectorizable loops.
+     *  The clustering always runs down to one jet to record all the y values,
+     *  the jets are taken at the requested step. The buffers are reused
+     *  between events.
+     */
+    class DurhamClustering {
+    public:
+      /// Cluster particles into exactly njets jets (into one jet per
+      /// particle if there are not enough particles)
+      void clusterExclusive( const kinematics::FourMomentumArray &particles, std::size_t njets ) ;
+
+      /// Cluster particles until the y values of all jet pairs are above ycut
+      void clusterYcut( const kinematics::FourMomentumArray &particles, double ycut ) ;
+
+      /// Get the jets
+      inline const kinematics::FourMomentumArray &jets() const { return _jets ; }
+
+      /// Get the number of jets
+      inline std::size_t nJets() const { return _jets.size() ; }
+
+      /// Get the jet index of each particle
+      inline const std::vector<uint32_t> &particleJets() const { return _particleJets ; }
+
+      /// Get y_{n,n+1}, the y value at which the event goes from n+1 to n jets.
+      /// 0 if the event has no more than n particles
+      inline double y( std::size_t n ) const { return ( n > 0 && n < _yValues.size() ) ? _yValues[n] : 0. ; }
+
+      /// Get the y values: y_{n,n+1} at index n, from 1 to the number of particles - 1
+      inline const std::vector<double> &yValues() const { return _yValues ; }
+
+    private:
+      /// Cluster down to one jet, keeping the jets of the step with njets jets,
+      /// or of the first step with all y values above ycut if njets is 0
+      void cluster( const kinematics::FourMomentumArray &particles, std::size_t njets, double ycut ) ;
+
+      /// Add a pseudo-jet in a slot
+      inline void setSlot( std::size_t slot, double px, double py, double pz, double e, uint32_t id ) ;
+
+      /// Compute the angular distances of a slot to all the slots, in the scratch
+      void angularDistances( std::size_t slot ) ;
+
+      /// Find the nearest neighbour of a slot, from the distances in the scratch
+      void updateNeighbour( std::size_t slot ) ;
+
+      /// Compute the Durham distance of a slot to its nearest neighbour (without normalization)
+      inline void updateDistance( std::size_t slot ) ;
+
+      /// Keep the current pseudo-jets as the clustering result
+      void keepJets() ;
+
+      /// Assign the particles to the kept jets, from the merging history
+      void assignParticles( std::size_t nparticles ) ;
+
+    private:
+      /// The pseudo-jets, in slots 0 to _nslots-1
+      std::size_t                        _nslots {0} ;
+      std::vector<double>                _px {}, _py {}, _pz {}, _e {} ;
+      /// The unit directions
+      std::vector<double>                _nx {}, _ny {}, _nz {} ;
+      /// The cluster id of each slot in the merging history
+      std::vector<uint32_t>              _ids {} ;
+      /// The nearest neighbour slot, its angular distance (1 - cos theta)
+      /// and the Durham distance to it
+      std::vector<uint32_t>              _neighbours {} ;
+      std::vector<double>                _angles {} ;
+      std::vector<double>                _distances {} ;
+      /// Scratch: angular distances of a slot to all the slots, and
+      /// whether the nearest neighbour of a slot must be searched again
+      std::vector<double>                _scratch {} ;
+      std::vector<uint8_t>               _rescan {} ;
+      /// The merging history: the parent id of each cluster id. Ids below
+      /// the number of particles are the particles, merged clusters follow
+      std::vector<uint32_t>              _parents {} ;
+      std::size_t                        _nclusters {0} ;
+      /// The cluster ids of the kept jets and the number of clusters at that step
+      std::vector<uint32_t>              _jetIds {} ;
+      std::size_t                        _nclustersAtJets {0} ;
+      /// The y values
+      std::vector<double>                _yValues {} ;
+      /// The jets and the jet index of each particle
+      kinematics::FourMomentumArray      _jets {} ;
+      std::vector<uint32_t>              _particleJets {} ;
+      /// Scratch: jet index of each cluster id
+      std::vector<uint32_t>              _labels {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    inline void DurhamClustering::setSlot( std::size_t slot, double px, double py, double pz, double e, uint32_t id ) {
+      const double p = std::sqrt( px*px + py*py + pz*pz ) ;
+      const double norm = p > 0. ? 1. / p : 0. ;
+      _px[slot] = px ; _py[slot] = py ; _pz[slot] = pz ; _e[slot] = e ;
+      _nx[slot] = px * norm ; _ny[slot] = py * norm ; _nz[slot] = pz * norm ;
+      _ids[slot] = id ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline void DurhamClustering::updateDistance( std::size_t slot ) {
+      const auto neighbour = _neighbours[slot] ;
+      const double e = std::min( _e[slot], _e[neighbour] ) ;
+      _distances[slot] = 2. * e * e * _angles[slot] ;
+    }
+
+  }
+
+}
+
+#endif
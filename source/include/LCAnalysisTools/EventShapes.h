@@ -0,0 +1,156 @@
+
+#ifndef _LCANALYSISTOOLS_EVENTSHAPES_H
+#define _LCANALYSISTOOLS_EVENTSHAPES_H
+
+// -- std headers
+#include <cstdint>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Kinematics.h>
+#include <LCAnalysisTools/PFOClassification.h>
+
+namespace EVENT {
+  class LCCollection ;
+}
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    /// The thrust of an event and its axis
+    struct Thrust {
+      /// The thrust value, in [0.5, 1] for events of two particles or more
+      double                     _thrust {0.} ;
+      /// The thrust axis, a unit vector with z >= 0
+      double                     _x {0.}, _y {0.}, _z {0.} ;
+      /// Upper bound of the difference to the exact thrust value (0 for the exact algorithm)
+      double                     _error {0.} ;
+    };
+
+    /// The eigenvalues of a momentum tensor, normalized to a unit trace
+    struct MomentumTensor {
+      /// The eigenvalues, in decreasing order
+      double                     _lambda1 {0.}, _lambda2 {0.}, _lambda3 {0.} ;
+
+      /// The sphericity (of the quadratic tensor)
+      inline double sphericity() const { return 1.5 * ( _lambda2 + _lambda3 ) ; }
+
+      /// The aplanarity (of the quadratic tensor)
+      inline double aplanarity() const { return 1.5 * _lambda3 ; }
+
+      /// The C parameter (of the linearized tensor)
+      inline double cParameter() const { return 3. * ( _lambda1*_lambda2 + _lambda1*_lambda3 + _lambda2*_lambda3 ) ; }
+
+      /// The D parameter (of the linearized tensor)
+      inline double dParameter() const { return 27. * _lambda1*_lambda2*_lambda3 ; }
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  EventShapes class
+     *
+     *  Event shape variables of a set of particles: thrust, momentum tensors
+     *  (sphericity, aplanarity, C and D parameters) and Fox-Wolfram moments.
+     *  The particles can be selected from a PFO collection by the category
+     *  flags of their type code (see PFOClassification).
+     *
+     *  The exact thrust is found in O(N^2 log N): the optimal partition of
+     *  the particles is cut by a plane containing two of them. For each
+     *  particle, the planes containing it are swept around it, the other
+     *  particles being sorted by the angle at which they change side, so
+     *  that the partition is updated one particle at a time.
+     *  The approximate thrust is a branch and bound search of the axis over
+     *  cells of the half sphere. Most particles stay on one side of the plane
+     *  orthogonal to the axis over a cell: their contribution is bounded by
+     *  the largest projection of their signed sum on the axes of the cell,
+     *  the others one by one. Cells are split until no cell can improve the
+     *  thrust by more than the requested error.
+     *  The Fox-Wolfram moments are computed for all the particle pairs at once
+     *  with the Legendre recursion, in vectorizable loops over the particles.
+     *  The buffers are reused between events.
+     */
+    class EventShapes {
+    public:
+      /// Select the PFOs of a ReconstructedParticle collection passing a
+      /// selection on their category flags. Returns their four-momenta
+      const kinematics::FourMomentumArray &select( const EVENT::LCCollection *pfos, const PFOSelection &selection ) ;
+
+      /// Select the PFOs of a ReconstructedParticle collection passing all the
+      /// standard selections of a mask (see the pfo namespace). Returns their four-momenta
+      const kinematics::FourMomentumArray &select( const EVENT::LCCollection *pfos, SelectionMask mask ) ;
+
+      /// Get the indices of the PFOs of the last selection
+      inline const std::vector<uint32_t> &selected() const { return _selected ; }
+
+      /// Get the exact thrust
+      Thrust thrust( const kinematics::FourMomentumArray &particles ) ;
+
+      /// Get the thrust with an error below maxError (> 0). The returned thrust
+      /// is never above the exact one, the actual error bound is in Thrust::_error
+      Thrust approximateThrust( const kinematics::FourMomentumArray &particles, double maxError ) ;
+
+      /// Get the eigenvalues of the quadratic momentum (sphericity) tensor
+      ///     S^ab = sum p^a p^b / sum |p|^2
+      MomentumTensor sphericityTensor( const kinematics::FourMomentumArray &particles ) ;
+
+      /// Get the eigenvalues of the linearized momentum tensor
+      ///     Theta^ab = sum p^a p^b / |p| / sum |p|
+      MomentumTensor linearizedTensor( const kinematics::FourMomentumArray &particles ) ;
+
+      /// Get the Fox-Wolfram moments H_0 to H_lmax, normalized to the squared visible energy
+      ///     H_l = sum_ij |p_i| |p_j| P_l( cos theta_ij ) / E_vis^2
+      const std::vector<double> &foxWolframMoments( const kinematics::FourMomentumArray &particles, std::size_t lmax ) ;
+
+    private:
+      /// A cell of the half sphere, in (theta, phi), and the upper bound of the thrust in it
+      struct Cell {
+        double                   _theta0 {0.}, _theta1 {0.}, _phi0 {0.}, _phi1 {0.} ;
+        double                   _bound {0.} ;
+        /// Order for a max heap with the std heap algorithms
+        inline bool operator<( const Cell &rhs ) const { return _bound < rhs._bound ; }
+      };
+
+      /// Fill the momenta, their magnitudes and directions. Returns the sum of the magnitudes
+      double setMomenta( const kinematics::FourMomentumArray &particles ) ;
+
+      /// Get sum |p.n| for a unit vector n
+      double projection( double nx, double ny, double nz ) ;
+
+      /// Get an upper bound of sum |p.n| for the unit vectors n of a cell
+      double cellBound( const Cell &cell ) ;
+
+      /// Improve an axis by iterating n = sum sign(p.n) p until the partition
+      /// no longer changes. Returns sum |p.n| for the final axis
+      double improveAxis( double &nx, double &ny, double &nz ) ;
+
+      /// Get the eigenvalues of a momentum tensor, normalized by its trace
+      static MomentumTensor eigenvalues( double xx, double yy, double zz, double xy, double xz, double yz ) ;
+
+    private:
+      /// Selection: the classification of the PFOs, the selected PFOs and their four-momenta
+      PFOClassification                  _classification {} ;
+      std::vector<uint32_t>              _selected {} ;
+      kinematics::FourMomentumArray      _particles {} ;
+      /// The momenta, their magnitudes and unit directions
+      std::vector<double>                _px {}, _py {}, _pz {}, _p {} ;
+      std::vector<double>                _nx {}, _ny {}, _nz {} ;
+      /// Scratch: sweep angles, sides and order of the exact thrust, projections
+      std::vector<double>                _angles {}, _sides {}, _scratch {} ;
+      std::vector<uint32_t>              _order {} ;
+      /// Scratch: the cell heap of the approximate thrust
+      std::vector<Cell>                  _cells {} ;
+      /// Scratch: Fox-Wolfram moments, the per particle sums of the Legendre
+      /// terms of each order and the Legendre recursion arrays
+      std::vector<double>                _moments {} ;
+      std::vector<double>                _legendreSums {} ;
+      std::vector<double>                _cosines {}, _weights {}, _previous {}, _current {} ;
+    };
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,211 @@
+
+#ifndef _LCANALYSISTOOLS_INSTRUMENTATION_H
+#define _LCANALYSISTOOLS_INSTRUMENTATION_H
+
+// -- std headers
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+
+/// Sampling period of the latency measurements. Must be a power of two
+#ifndef LCANALYSISTOOLS_INSTRUMENTATION_SAMPLING_PERIOD
+#define LCANALYSISTOOLS_INSTRUMENTATION_SAMPLING_PERIOD 1024
+#endif
+
+#ifdef LCANALYSISTOOLS_INSTRUMENTATION
+/// Count a call of a public entry point and sample its latency, for the
+/// enclosing scope. Calls nested in another entry point are not counted
+#define LCANALYSISTOOLS_ENTRY_POINT( counter ) \
+  lc_analysis::instrumentation::EntryPoint lcanalysistoolsEntryPoint( lc_analysis::instrumentation::Counter::counter )
+/// Record a pdg id missing in the particle table. Must follow
+/// LCANALYSISTOOLS_ENTRY_POINT in the same scope
+#define LCANALYSISTOOLS_RECORD_MISS( pdg ) \
+  lc_analysis::instrumentation::recordMiss( lcanalysistoolsEntryPoint, pdg )
+/// Suspend the counting in the enclosing scope
+#define LCANALYSISTOOLS_SUSPEND_COUNTING() \
+  lc_analysis::instrumentation::CountingSuspension lcanalysistoolsCountingSuspension
+#else
+#define LCANALYSISTOOLS_ENTRY_POINT( counter ) static_cast<void>( 0 )
+#define LCANALYSISTOOLS_RECORD_MISS( pdg ) static_cast<void>( 0 )
+#define LCANALYSISTOOLS_SUSPEND_COUNTING() static_cast<void>( 0 )
+#endif
+
+namespace lc_analysis {
+
+  /**
+   *  Instrumentation of the lookup and classification hot paths.
+   *
+   *  Only active when compiled with LCANALYSISTOOLS_INSTRUMENTATION
+   *  (CMake option INSTRUMENTATION=ON), otherwise the instrumentation
+   *  macros expand to nothing. Only the outermost call of the public entry
+   *  points is counted and timed: the predicates calling each other (e.g.
+   *  isHadron calling isMeson) count once, and the counting is suspended
+   *  while building the PDGIndex. Each thread fills its own counters, miss
+   *  histogram and latency histograms without locking. The data of all
+   *  threads are merged and dumped at job end, on std::cerr or in the file
+   *  given by the LCANALYSISTOOLS_INSTRUMENTATION_OUTPUT environment variable.
+   */
+  namespace instrumentation {
+
+    /// The instrumented entry points
+    enum class Counter : std::size_t {
+      ParticleLookup,
+      ParticleMiss,
+      IsQuark,
+      IsLepton,
+      IsHadron,
+      IsMeson,
+      IsBaryon,
+      IsDiQuark,
+      IsNucleus,
+      IsPentaQuark,
+      IsGaugeBosonOrHiggs,
+      IsSMGaugeBosonOrHiggs,
+      IsGeneratorSpecific,
+      IsSpecialParticle,
+      IsRHadron,
+      IsQBall,
+      IsDyon,
+      IsSUSY,
+      IsTechnicolor,
+      IsCompositeQuarkOrLepton,
+      HasQuark,
+      HasFundamentalAnti,
+      NCounters
+    };
+
+    /// Number of instrumented entry points
+    static constexpr std::size_t NCounters = static_cast<std::size_t>( Counter::NCounters ) ;
+
+    /// Number of latency histogram bins. Bin i holds latencies in [2^i, 2^(i+1)[ ns
+    static constexpr std::size_t NLatencyBins = 32 ;
+
+    /// Get the name of an instrumented entry point
+    const char *counterName( Counter counter ) ;
+
+    //--------------------------------------------------------------------------
+    //--------------------------------------------------------------------------
+
+    /**
+     *  @brief  ThreadData struct
+     *
+     *  Instrumentation data of a single thread. Only the owning
+     *  thread writes in it, counters are atomics with relaxed
+     *  single-writer updates so that they can be read anytime.
+     */
+    struct ThreadData {
+      using LatencyHistogram = std::array<std::atomic<uint64_t>, NLatencyBins> ;
+      std::array<std::atomic<uint64_t>, NCounters>    _counters {} ;
+      std::array<LatencyHistogram, NCounters>         _latencies {} ;
+      std::unordered_map<int, uint64_t>               _misses {} ;
+      uint64_t                                        _samplingClock {0} ;
+      /// Number of entry points and suspensions in the call stack
+      uint32_t                                        _depth {0} ;
+    };
+
+    /// Allocate and register the instrumentation data of the calling thread
+    ThreadData *registerThread() ;
+
+    /// Get the instrumentation data of the calling thread
+    inline ThreadData &threadData() {
+      thread_local ThreadData *data = registerThread() ;
+      return *data ;
+    }
+
+    /// Increment a counter of the calling thread
+    inline void count( ThreadData &data, Counter counter ) {
+      auto &value = data._counters[ static_cast<std::size_t>( counter ) ] ;
+      value.store( value.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed ) ;
+    }
+
+    /// Record a latency measurement (in ns) of an entry point
+    void recordLatency( Counter counter, uint64_t nanoseconds ) ;
+
+    /// Merge the data of all threads and write a report.
+    /// The instrumented threads should be idle when calling it
+    void dump( std::ostream &out ) ;
+
+    //--------------------------------------------------------------------------
+    //--------------------------------------------------------------------------
+
+    /**
+     *  @brief  EntryPoint class
+     *
+     *  Counts a call of an entry point if it is the outermost one of the
+     *  calling thread (not nested in another entry point, nor suspended),
+     *  and measures its lifetime once every LCANALYSISTOOLS_INSTRUMENTATION_SAMPLING_PERIOD
+     *  counted calls of the thread
+     */
+    class EntryPoint {
+      using clock = std::chrono::steady_clock ;
+      static_assert( ( LCANALYSISTOOLS_INSTRUMENTATION_SAMPLING_PERIOD & ( LCANALYSISTOOLS_INSTRUMENTATION_SAMPLING_PERIOD - 1 ) ) == 0,
+        "LCANALYSISTOOLS_INSTRUMENTATION_SAMPLING_PERIOD must be a power of two" ) ;
+    public:
+      /// Constructor. Counts the call and starts the clock if this call is sampled
+      EntryPoint( Counter counter ) :
+        _data(threadData()),
+        _counter(counter),
+        _counted( 0 == _data._depth++ ) {
+        if( _counted ) {
+          count( _data, _counter ) ;
+          _sampled = ( ++_data._samplingClock & ( LCANALYSISTOOLS_INSTRUMENTATION_SAMPLING_PERIOD - 1 ) ) == 0 ;
+          if( _sampled ) {
+            _start = clock::now() ;
+          }
+        }
+      }
+
+      /// Destructor. Records the latency if this call is sampled
+      ~EntryPoint() {
+        if( _sampled ) {
+          recordLatency( _counter, std::chrono::duration_cast<std::chrono::nanoseconds>( clock::now() - _start ).count() ) ;
+        }
+        --_data._depth ;
+      }
+
+      EntryPoint( const EntryPoint & ) = delete ;
+      EntryPoint &operator=( const EntryPoint & ) = delete ;
+
+      /// Whether this call is counted
+      inline bool counted() const { return _counted ; }
+
+    private:
+      ThreadData          &_data ;
+      Counter              _counter ;
+      bool                 _counted {false} ;
+      bool                 _sampled {false} ;
+      clock::time_point    _start {} ;
+    };
+
+    /// Record a missing pdg id in the calling thread miss histogram,
+    /// if the lookup entry point is counted
+    void recordMiss( const EntryPoint &lookup, int pdg ) ;
+
+    //--------------------------------------------------------------------------
+    //--------------------------------------------------------------------------
+
+    /**
+     *  @brief  CountingSuspension class
+     *
+     *  Suspends the counting of the calling thread during its lifetime
+     */
+    class CountingSuspension {
+    public:
+      CountingSuspension() : _data(threadData()) { ++_data._depth ; }
+      ~CountingSuspension() { --_data._depth ; }
+
+      CountingSuspension( const CountingSuspension & ) = delete ;
+      CountingSuspension &operator=( const CountingSuspension & ) = delete ;
+
+    private:
+      ThreadData          &_data ;
+    };
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,161 @@
+
+#ifndef _LCANALYSISTOOLS_ISOLATEDLEPTONS_H
+#define _LCANALYSISTOOLS_ISOLATEDLEPTONS_H
+
+// -- std headers
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Kinematics.h>
+#include <LCAnalysisTools/PFOClassification.h>
+
+namespace EVENT {
+  class LCCollection ;
+}
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    /**
+     *  @brief  IsolatedLeptonFinder class
+     *
+     *  Cone energies of the lepton candidates of an event, for several cone
+     *  sizes at once, and selection of the isolated leptons.
+     *  The PFOs are binned once per event in (cos theta, phi), with bins about
+     *  half as large as the largest cone, and stored bin by bin (directions
+     *  and energies in structure of arrays layout). The phi bins are uniform
+     *  in the pseudo-angle y / (|x| + |y|), monotonic in phi and cheaper than
+     *  atan2, so that the binning loops vectorize. A cone query only visits
+     *  the bins overlapping the largest cone, row by row in cos theta, and
+     *  tests the angle of their PFOs once for all the cones: the energy of a
+     *  PFO is added to the smallest cone containing it, and a running sum
+     *  gives the larger cones. O(N + candidates x PFOs per cone) instead of
+     *  O(candidates x N x cones).
+     *  The lepton candidates are the PFOs of the ChargedLepton selection,
+     *  i.e. with the Lepton and Charged category flags of their type.
+     *  The cone energy of a PFO excludes its own energy. The buffers are
+     *  reused between events.
+     */
+    class IsolatedLeptonFinder {
+    public:
+      /// Constructor with the cosines of the cone half angles, in (0, 1) and
+      /// in decreasing order (increasing cone sizes)
+      explicit IsolatedLeptonFinder( const std::vector<double> &cosConeAngles ) ;
+
+      /// Process the PFOs of a ReconstructedParticle collection
+      void process( const EVENT::LCCollection *pfos ) ;
+
+      /// Process PFOs given by their four-momenta and type codes
+      void process( const kinematics::FourMomentumArray &particles, const std::vector<int> &types ) ;
+
+      /// Bin particles for cone queries, without lepton candidates
+      void setParticles( const kinematics::FourMomentumArray &particles ) ;
+
+      /// Get the energies in the cones around a direction (unit vector), excluding
+      /// a particle (e.g. the one along the direction). Fills nCones() energies
+      void coneEnergies( double x, double y, double z, uint32_t excluded, double *energies ) const ;
+
+      /// Get the number of cones
+      inline std::size_t nCones() const { return _cosConeAngles.size() ; }
+
+      /// Get the cosine of the half angle of a cone
+      inline double cosConeAngle( std::size_t cone ) const { return _cosConeAngles[cone] ; }
+
+      /// Get the indices of the lepton candidates
+      inline const std::vector<uint32_t> &candidates() const { return _candidates ; }
+
+      /// Get the energy of a lepton candidate
+      inline double energy( std::size_t candidate ) const { return _candidateEnergies[candidate] ; }
+
+      /// Get the energy in a cone around a lepton candidate
+      inline double coneEnergy( std::size_t candidate, std::size_t cone ) const { return _coneEnergies[ candidate * nCones() + cone ] ; }
+
+      /// Get the indices of the isolated leptons: candidates with an energy of
+      /// at least minEnergy and an energy in the cone of at most maxConeEnergyFraction
+      /// times their energy
+      void isolated( std::size_t cone, double minEnergy, double maxConeEnergyFraction, std::vector<uint32_t> &indices ) const ;
+
+    private:
+      /// Select the lepton candidates of the classified PFOs and compute their cone energies
+      void processCandidates( const kinematics::FourMomentumArray &particles ) ;
+
+      /// Get the (unclamped) bin of a cos theta value
+      inline long cosThetaBin( double cosTheta ) const ;
+
+      /// Get the phi bin of a transverse direction, from its pseudo-angle in [0, 4)
+      inline long phiBin( double x, double y ) const ;
+
+      /// Add the energies of the entries [begin, end) to the smallest cone containing them
+      inline void addEnergies( double x, double y, double z, uint32_t excluded, uint32_t begin, uint32_t end, double *energies ) const ;
+
+    private:
+      /// The cosines of the cone half angles, in decreasing order, and the
+      /// largest angle and its sine
+      std::vector<double>                _cosConeAngles {} ;
+      double                             _maxConeAngle {0.} ;
+      double                             _sinMaxConeAngle {0.} ;
+      /// The binning: number of bins and bin sizes
+      std::size_t                        _nCosThetaBins {1} ;
+      std::size_t                        _nPhiBins {1} ;
+      double                             _cosThetaBinSize {2.} ;
+      double                             _phiBinSize {4.} ;
+      /// The binned particles: first entry of each bin, then the directions,
+      /// energies and particle indices, bin by bin
+      std::vector<uint32_t>              _binOffsets {} ;
+      std::vector<double>                _x {}, _y {}, _z {}, _e {} ;
+      std::vector<uint32_t>              _indices {} ;
+      /// Scratch: the direction and bin of each particle, and the fill positions
+      std::vector<double>                _ux {}, _uy {}, _uz {} ;
+      std::vector<uint32_t>              _bins {} ;
+      std::vector<uint32_t>              _positions {} ;
+      /// Scratch: the four-momenta and the classification of the PFOs
+      kinematics::FourMomentumArray      _momenta {} ;
+      PFOClassification                  _classification {} ;
+      /// The candidates, their energies and cone energies (nCones() per candidate)
+      std::vector<uint32_t>              _candidates {} ;
+      std::vector<double>                _candidateEnergies {} ;
+      std::vector<double>                _coneEnergies {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    inline long IsolatedLeptonFinder::cosThetaBin( double cosTheta ) const {
+      return static_cast<long>( std::floor( ( cosTheta + 1. ) / _cosThetaBinSize ) ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline long IsolatedLeptonFinder::phiBin( double x, double y ) const {
+      // null directions get the first bin
+      const double norm = std::fabs( x ) + std::fabs( y ) ;
+      const double t = y / ( norm + ( 0. == norm ) ) ;
+      const double pseudoAngle = x < 0. ? 2. - t : ( y < 0. ? 4. + t : t ) ;
+      return std::min( static_cast<long>( pseudoAngle / _phiBinSize ), static_cast<long>( _nPhiBins ) - 1 ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline void IsolatedLeptonFinder::addEnergies( double x, double y, double z, uint32_t excluded, uint32_t begin, uint32_t end, double *energies ) const {
+      const auto ncones = _cosConeAngles.size() ;
+      for( uint32_t k=begin ; k<end ; ++k ) {
+        const double cosAngle = x*_x[k] + y*_y[k] + z*_z[k] ;
+        std::size_t cone = 0 ;
+        while( cone < ncones && cosAngle < _cosConeAngles[cone] ) {
+          ++cone ;
+        }
+        if( cone < ncones && _indices[k] != excluded ) {
+          energies[cone] += _e[k] ;
+        }
+      }
+    }
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,245 @@
+
+#ifndef _LCANALYSISTOOLS_KINEMATICS_H
+#define _LCANALYSISTOOLS_KINEMATICS_H
+
+// -- std headers
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace EVENT {
+  class LCCollection ;
+}
+
+namespace lc_analysis {
+
+  namespace kinematics {
+
+    /// Conversion of the PDG table masses (MeV) to the LCIO units (GeV)
+    static constexpr double MeVToGeV = 1e-3 ;
+
+    /// Get the mass of a particle from the PDG table, in GeV.
+    /// 0 if the pdg id is not in the table or has no mass
+    double mass( int pdg ) ;
+
+    /// Get the masses of particles from the PDG table, in GeV, in a batch
+    void masses( const std::vector<int> &pdgs, std::vector<double> &masses ) ;
+
+    /// Get a signed invariant mass from a squared mass: negative
+    /// squared masses (resolution effects) give negative masses
+    inline double signedSqrt( double m2 ) {
+      return std::copysign( std::sqrt( std::fabs( m2 ) ), m2 ) ;
+    }
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  FourMomentum struct
+     *
+     *  A single four-momentum (px, py, pz, E), in GeV
+     */
+    struct FourMomentum {
+      double                     _px {0.} ;
+      double                     _py {0.} ;
+      double                     _pz {0.} ;
+      double                     _e {0.} ;
+
+      /// The initial state of a collider, from its nominal center of mass energy
+      /// (twice the beam energy) and the beam crossing angle in the x-z plane
+      /// (in rad, e.g 0.014 at the ILC)
+      static inline FourMomentum initialState( double sqrtS, double crossingAngle = 0. ) ;
+
+      inline FourMomentum &operator+=( const FourMomentum &rhs ) ;
+      inline FourMomentum &operator-=( const FourMomentum &rhs ) ;
+      inline FourMomentum operator+( const FourMomentum &rhs ) const { return FourMomentum(*this) += rhs ; }
+      inline FourMomentum operator-( const FourMomentum &rhs ) const { return FourMomentum(*this) -= rhs ; }
+
+      /// Get the squared momentum
+      inline double p2() const { return _px*_px + _py*_py + _pz*_pz ; }
+      /// Get the momentum
+      inline double p() const { return std::sqrt( p2() ) ; }
+      /// Get the transverse momentum
+      inline double pt() const { return std::sqrt( _px*_px + _py*_py ) ; }
+      /// Get the squared invariant mass
+      inline double m2() const { return _e*_e - p2() ; }
+      /// Get the invariant mass (negative if m2 < 0)
+      inline double mass() const { return signedSqrt( m2() ) ; }
+      /// Get the cosine of the polar angle. 1 for a null momentum
+      inline double cosTheta() const { const auto pp = p() ; return pp > 0. ? _pz / pp : 1. ; }
+      /// Get the azimuthal angle, in [-pi, pi]
+      inline double phi() const { return std::atan2( _py, _px ) ; }
+      /// Get the recoil mass against this four-momentum, for an initial state
+      inline double recoilMass( const FourMomentum &initial ) const { return ( initial - *this ).mass() ; }
+
+      /// Boost by a velocity (in units of c)
+      inline void boost( double bx, double by, double bz ) ;
+      /// Boost to the rest frame of a four-momentum
+      inline void boostToRestFrame( const FourMomentum &frame ) { boost( -frame._px/frame._e, -frame._py/frame._e, -frame._pz/frame._e ) ; }
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  FourMomentumArray class
+     *
+     *  Four-momenta of a collection of particles, in structure of arrays
+     *  layout: one contiguous array per component. The kinematic quantities
+     *  are computed for all particles at once by kernels written as plain
+     *  branchless loops over these arrays, that the compiler turns into SIMD
+     *  code. Results are written in caller provided vectors, reused between
+     *  events, as are the component arrays.
+     */
+    class FourMomentumArray {
+    public:
+      /// Fill the four-momenta of an MCParticle or ReconstructedParticle collection.
+      /// Throws for other collection types
+      void fill( const EVENT::LCCollection *particles ) ;
+
+      /// Fill the four-momenta of a subset of an MCParticle or
+      /// ReconstructedParticle collection, e.g a PFO selection
+      void fill( const EVENT::LCCollection *particles, const std::vector<uint32_t> &indices ) ;
+
+      /// Add a four-momentum
+      inline void push_back( double px, double py, double pz, double e ) ;
+
+      /// Add a four-momentum
+      inline void push_back( const FourMomentum &p ) { push_back( p._px, p._py, p._pz, p._e ) ; }
+
+      /// Remove all the four-momenta
+      void clear() ;
+
+      /// Reserve space for n four-momenta
+      void reserve( std::size_t n ) ;
+
+      /// Get the number of four-momenta
+      inline std::size_t size() const { return _px.size() ; }
+
+      /// Get the i-th four-momentum
+      inline FourMomentum get( std::size_t i ) const { return FourMomentum{ _px[i], _py[i], _pz[i], _e[i] } ; }
+
+      /// Get the component arrays
+      inline const double *px() const { return _px.data() ; }
+      inline const double *py() const { return _py.data() ; }
+      inline const double *pz() const { return _pz.data() ; }
+      inline const double *e() const { return _e.data() ; }
+
+      /// Get the sum of all the four-momenta
+      FourMomentum sum() const ;
+
+      /// Get the sum of a subset of the four-momenta
+      FourMomentum sum( const std::vector<uint32_t> &indices ) const ;
+
+      /// Set the energies from a common mass hypothesis (in GeV), keeping the momenta
+      void setMass( double mass ) ;
+
+      /// Set the energies from per particle masses (in GeV), keeping the momenta
+      void setMasses( const std::vector<double> &masses ) ;
+
+      /// Set the energies from a common mass hypothesis, given by a pdg id
+      void setMassHypothesis( int pdg ) ;
+
+      /// Set the energies from per particle mass hypotheses given by pdg ids,
+      /// e.g the PFO types. Ids not in the PDG table get a null mass
+      void setMassHypotheses( const std::vector<int> &pdgs ) ;
+
+      /// Boost all the four-momenta by a velocity (in units of c)
+      void boost( double bx, double by, double bz ) ;
+
+      /// Boost all the four-momenta to the rest frame of a four-momentum
+      void boostToRestFrame( const FourMomentum &frame ) ;
+
+      /// Get the invariant masses (negative if m2 < 0)
+      void masses( std::vector<double> &out ) const ;
+
+      /// Get the momenta
+      void momenta( std::vector<double> &out ) const ;
+
+      /// Get the transverse momenta
+      void transverseMomenta( std::vector<double> &out ) const ;
+
+      /// Get the cosines of the polar angles. 1 for null momenta
+      void cosThetas( std::vector<double> &out ) const ;
+
+      /// Get the azimuthal angles, in [-pi, pi]
+      void phis( std::vector<double> &out ) const ;
+
+      /// Get the cosines of the angles to a direction, given by
+      /// the momentum of a four-momentum (e.g a jet or the thrust axis)
+      void cosAngles( const FourMomentum &axis, std::vector<double> &out ) const ;
+
+      /// Get the recoil masses against each four-momentum, for an initial state
+      void recoilMasses( const FourMomentum &initial, std::vector<double> &out ) const ;
+
+      /// Get the invariant masses of the pairs (this[i], other[i]).
+      /// Throws if the arrays have different sizes
+      void pairMasses( const FourMomentumArray &other, std::vector<double> &out ) const ;
+
+    private:
+      /// Fill the four-momenta of collection elements (typed)
+      template <typename T>
+      void fillElements( const EVENT::LCCollection *particles, const uint32_t *indices, std::size_t n ) ;
+
+      /// Fill the four-momenta of collection elements
+      void fillCollection( const EVENT::LCCollection *particles, const uint32_t *indices, std::size_t n ) ;
+
+    private:
+      /// The four-momentum components
+      std::vector<double>        _px {} ;
+      std::vector<double>        _py {} ;
+      std::vector<double>        _pz {} ;
+      std::vector<double>        _e {} ;
+      /// Scratch: masses of the mass hypotheses
+      std::vector<double>        _masses {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    inline FourMomentum FourMomentum::initialState( double sqrtS, double crossingAngle ) {
+      // beams with opposite z momenta, each tilted by half the crossing angle
+      return FourMomentum{ sqrtS * std::sin( crossingAngle / 2. ), 0., 0., sqrtS } ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline FourMomentum &FourMomentum::operator+=( const FourMomentum &rhs ) {
+      _px += rhs._px ; _py += rhs._py ; _pz += rhs._pz ; _e += rhs._e ;
+      return *this ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline FourMomentum &FourMomentum::operator-=( const FourMomentum &rhs ) {
+      _px -= rhs._px ; _py -= rhs._py ; _pz -= rhs._pz ; _e -= rhs._e ;
+      return *this ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline void FourMomentum::boost( double bx, double by, double bz ) {
+      const double b2 = bx*bx + by*by + bz*bz ;
+      const double gamma = 1. / std::sqrt( 1. - b2 ) ;
+      const double bp = bx*_px + by*_py + bz*_pz ;
+      const double gamma2 = b2 > 0. ? ( gamma - 1. ) / b2 : 0. ;
+      _px += gamma2*bp*bx + gamma*bx*_e ;
+      _py += gamma2*bp*by + gamma*by*_e ;
+      _pz += gamma2*bp*bz + gamma*bz*_e ;
+      _e = gamma * ( _e + bp ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline void FourMomentumArray::push_back( double px, double py, double pz, double e ) {
+      _px.push_back( px ) ;
+      _py.push_back( py ) ;
+      _pz.push_back( pz ) ;
+      _e.push_back( e ) ;
+    }
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+
+#ifndef _LCANALYSISTOOLS_OVERLAYREMOVAL_H
+#define _LCANALYSISTOOLS_OVERLAYREMOVAL_H
+
+// -- std headers
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Kinematics.h>
+
+namespace EVENT {
+  class LCCollection ;
+}
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    /**
+     *  @brief  OverlayRemoval class
+     *
+     *  Removal of the gamma gamma -> hadrons overlay with the exclusive,
+     *  longitudinally invariant kt algorithm, as done with FastJet in the
+     *  CLIC and ILC analyses. The distances are
+     *      d_ij = min( pT_i^2, pT_j^2 ) dR_ij^2 / R^2 ,  d_iB = pT_i^2
+     *  with dR^2 = dy^2 + dphi^2. The particles are clustered until njets
+     *  jets remain: the particles of these jets are kept, the ones merged
+     *  with the beam are removed.
+     *  The clustering follows the FastJet tiled strategy: the (y, phi) plane
+     *  is divided in tiles of size at least R. A pseudo-jet can only have a
+     *  pair distance below its beam distance with pseudo-jets closer than R,
+     *  so its nearest neighbour is searched in its tile and the 8 neighbouring
+     *  ones only. The distances are kept in a min heap, with lazy deletion of
+     *  the outdated entries, and each step updates the pseudo-jets of the
+     *  tiles around the merged pair only: O(N log N) in the typical regime,
+     *  where the particles are spread over many tiles.
+     *  The buffers are reused between events.
+     */
+    class OverlayRemoval {
+    public:
+      /// Constructor with the kt radius and the number of exclusive jets
+      OverlayRemoval( double R, std::size_t njets ) ;
+
+      /// Process the PFOs of a ReconstructedParticle collection
+      void process( const EVENT::LCCollection *pfos ) ;
+
+      /// Process particles given by their four-momenta
+      void process( const kinematics::FourMomentumArray &particles ) ;
+
+      /// Get the indices of the kept particles, in increasing order
+      inline const std::vector<uint32_t> &kept() const { return _kept ; }
+
+      /// Get the indices of the removed particles, in increasing order
+      inline const std::vector<uint32_t> &removed() const { return _removed ; }
+
+      /// Get the exclusive jets
+      inline const kinematics::FourMomentumArray &jets() const { return _jets ; }
+
+    private:
+      /// Rapidity range of the tiling: the first and last rapidity tiles extend to infinity
+      static constexpr double MaxRapidity = 5. ;
+      static constexpr double TwoPi = 6.283185307179586 ;
+
+      /**
+       *  @brief  PseudoJet struct
+       *
+       *  A pseudo-jet of the clustering, in a doubly linked list of its tile
+       */
+      struct PseudoJet {
+        double                   _px {0.}, _py {0.}, _pz {0.}, _e {0.} ;
+        double                   _pt2 {0.}, _rapidity {0.}, _phi {0.} ;  // phi in [0, 2pi)
+        /// The nearest neighbour (NoJet if none closer than R) and the squared distance to it (R^2 if none)
+        uint32_t                 _neighbour {0} ;
+        double                   _dr2 {0.} ;
+        /// The tile, and the previous and next pseudo-jets of the tile
+        uint32_t                 _tile {0} ;
+        uint32_t                 _previous {0}, _next {0} ;
+        /// Incremented at each change, to invalidate the heap entries
+        uint32_t                 _version {0} ;
+        bool                     _active {false} ;
+      };
+
+      /// A heap entry: a distance, its pseudo-jet and version
+      struct HeapEntry {
+        double                   _distance {0.} ;
+        uint32_t                 _jet {0} ;
+        uint32_t                 _version {0} ;
+        /// Order for a min heap with the std heap algorithms
+        inline bool operator<( const HeapEntry &rhs ) const { return _distance > rhs._distance ; }
+      };
+
+      /// Add a pseudo-jet, in its tile. Returns its index
+      uint32_t addJet( double px, double py, double pz, double e ) ;
+
+      /// Remove a pseudo-jet from its tile
+      void removeJet( uint32_t jet ) ;
+
+      /// Get the tile of a (rapidity, phi) point
+      inline uint32_t tileIndex( double rapidity, double phi ) const ;
+
+      /// Get the tiles around a tile, itself included (9 at most). Returns the number of tiles
+      std::size_t neighbourTiles( uint32_t tile, uint32_t *tiles ) const ;
+
+      /// Add the tiles around a tile to the scratch, without duplicates
+      void addNeighbourTiles( uint32_t tile ) ;
+
+      /// Get the squared (rapidity, phi) distance between two pseudo-jets
+      inline double deltaR2( const PseudoJet &lhs, const PseudoJet &rhs ) const ;
+
+      /// Find the nearest neighbour of a pseudo-jet in the tiles around it
+      void findNeighbour( uint32_t jet ) ;
+
+      /// Push the current distance of a pseudo-jet in the heap
+      void pushDistance( uint32_t jet ) ;
+
+    private:
+      /// The squared kt radius
+      double                             _R2 {1.} ;
+      /// The number of exclusive jets
+      std::size_t                        _njets {2} ;
+      /// The pseudo-jets: the particles, then the merged pseudo-jets
+      std::vector<PseudoJet>             _pseudoJets {} ;
+      /// The merging history: the parent of each pseudo-jet. NoJet if not
+      /// merged, BeamJet if merged with the beam
+      std::vector<uint32_t>              _parents {} ;
+      std::size_t                        _nactive {0} ;
+      /// The tiling: number of rapidity and phi tiles, tile sizes, lower
+      /// rapidity bound and the first pseudo-jet of each tile
+      std::size_t                        _nRapidityTiles {0} ;
+      std::size_t                        _nPhiTiles {0} ;
+      double                             _rapidityTileSize {1.} ;
+      double                             _phiTileSize {1.} ;
+      double                             _minRapidity {0.} ;
+      std::vector<uint32_t>              _tileHeads {} ;
+      /// The distance heap, with the shortest distance on top
+      std::vector<HeapEntry>             _heap {} ;
+      /// Scratch: tiles around the merged pair, and the pseudo-jets to update
+      std::vector<uint32_t>              _tiles {} ;
+      std::vector<uint32_t>              _updates {} ;
+      /// The results
+      std::vector<uint32_t>              _kept {} ;
+      std::vector<uint32_t>              _removed {} ;
+      kinematics::FourMomentumArray      _jets {} ;
+      /// Scratch: whether each pseudo-jet ends up in a kept jet
+      std::vector<uint8_t>               _labels {} ;
+      /// Scratch: the four-momenta of the PFO collection
+      kinematics::FourMomentumArray      _momenta {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    inline uint32_t OverlayRemoval::tileIndex( double rapidity, double phi ) const {
+      const double y = ( rapidity - _minRapidity ) / _rapidityTileSize ;
+      const auto iy = y <= 0. ? std::size_t(0) : std::min( static_cast<std::size_t>( y ), _nRapidityTiles-1 ) ;
+      const auto iphi = std::min( static_cast<std::size_t>( phi / _phiTileSize ), _nPhiTiles-1 ) ;
+      return static_cast<uint32_t>( iy * _nPhiTiles + iphi ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline double OverlayRemoval::deltaR2( const PseudoJet &lhs, const PseudoJet &rhs ) const {
+      const double dy = lhs._rapidity - rhs._rapidity ;
+      double dphi = std::fabs( lhs._phi - rhs._phi ) ;
+      dphi = std::min( dphi, TwoPi - dphi ) ;
+      return dy*dy + dphi*dphi ;
+    }
+
+  }
+
+}
+
+#endif
@@ -4,9 +4,13 @@
 
 // -- std headers
 #include <array>
+#include <cstdint>
 #include <optional>
+#include <ostream>
+#include <string>
 
 // -- LCAnalysisTools headers
+#include <LCAnalysisTools/Instrumentation.h>
 #include <LCAnalysisTools/Utilities.h>
 
 namespace lc_analysis {
@@ -46,6 +50,48 @@ namespace lc_analysis {
       t
     };
     
+    //----------------------------------------------------------------------------
+    
+    /// Particle category flags, combined in a bit mask
+    using Categories = uint32_t ;
+    
+    /// The particle category flags, as computed by the PDGHelper
+    /// classification functions. See PDGHelper::categories()
+    namespace category {
+      static constexpr Categories Known                  = 1u << 0 ;   ///< the particle is in the PDG table
+      static constexpr Categories Quark                  = 1u << 1 ;   ///< see PDGHelper::isQuark()
+      static constexpr Categories Lepton                 = 1u << 2 ;   ///< see PDGHelper::isLepton()
+      static constexpr Categories Hadron                 = 1u << 3 ;   ///< see PDGHelper::isHadron()
+      static constexpr Categories Meson                  = 1u << 4 ;   ///< see PDGHelper::isMeson()
+      static constexpr Categories Baryon                 = 1u << 5 ;   ///< see PDGHelper::isBaryon()
+      static constexpr Categories DiQuark                = 1u << 6 ;   ///< see PDGHelper::isDiQuark()
+      static constexpr Categories Nucleus                = 1u << 7 ;   ///< see PDGHelper::isNucleus()
+      static constexpr Categories PentaQuark             = 1u << 8 ;   ///< see PDGHelper::isPentaQuark()
+      static constexpr Categories GaugeBosonOrHiggs      = 1u << 9 ;   ///< see PDGHelper::isGaugeBosonOrHiggs()
+      static constexpr Categories SMGaugeBosonOrHiggs    = 1u << 10 ;  ///< see PDGHelper::isSMGaugeBosonOrHiggs()
+      static constexpr Categories GeneratorSpecific      = 1u << 11 ;  ///< see PDGHelper::isGeneratorSpecific()
+      static constexpr Categories SpecialParticle        = 1u << 12 ;  ///< see PDGHelper::isSpecialParticle()
+      static constexpr Categories RHadron                = 1u << 13 ;  ///< see PDGHelper::isRHadron()
+      static constexpr Categories QBall                  = 1u << 14 ;  ///< see PDGHelper::isQBall()
+      static constexpr Categories Dyon                   = 1u << 15 ;  ///< see PDGHelper::isDyon()
+      static constexpr Categories SUSY                   = 1u << 16 ;  ///< see PDGHelper::isSUSY()
+      static constexpr Categories Technicolor            = 1u << 17 ;  ///< see PDGHelper::isTechnicolor()
+      static constexpr Categories CompositeQuarkOrLepton = 1u << 18 ;  ///< see PDGHelper::isCompositeQuarkOrLepton()
+      static constexpr Categories FundamentalAnti        = 1u << 19 ;  ///< see PDGHelper::hasFundamentalAnti()
+      static constexpr Categories HasU                   = 1u << 20 ;  ///< see PDGHelper::hasQuark()
+      static constexpr Categories HasD                   = 1u << 21 ;  ///< see PDGHelper::hasQuark()
+      static constexpr Categories HasS                   = 1u << 22 ;  ///< see PDGHelper::hasQuark()
+      static constexpr Categories HasC                   = 1u << 23 ;  ///< see PDGHelper::hasQuark()
+      static constexpr Categories HasB                   = 1u << 24 ;  ///< see PDGHelper::hasQuark()
+      static constexpr Categories HasT                   = 1u << 25 ;  ///< see PDGHelper::hasQuark()
+      static constexpr Categories Charged                = 1u << 26 ;  ///< non-zero charge
+      /// The number of category flags
+      static constexpr std::size_t NCategories = 27 ;
+      
+      /// Get the name of a category flag from its bit number ("Known", "Quark", ...)
+      const char *name( std::size_t bit ) ;
+    }
+    
     //----------------------------------------------------------------------------
     //----------------------------------------------------------------------------
     
@@ -73,18 +119,24 @@ namespace lc_analysis {
         std::optional<float>       _widthLower {0.} ;
         std::optional<float>       _isospin {0} ;
         std::optional<int>         _gParity {0} ;
-        float                      _charge {0.} ;
+        std::optional<int>         _cParity {0} ;
         Digits                     _digits {} ;
         std::string                _name {} ;
+        int16_t                    _threeCharge {0} ;
       };
       
     public:
-      /// Constructor with particle data
-      ParticleData( const Data &d ) : _data(d) {} 
+      /// Constructor with particle data.
+      /// The charge is not part of the generated table,
+      /// it is computed from the pdg id digits
+      inline ParticleData( const Data &d ) ;
       
       /// Get the particle PDG id
       inline int pdg() const ;
       
+      /// Whether the particle has a mass in the table
+      inline bool hasMass() const ;
+      
       /// Get the particle mass (if applicable)
       inline float mass() const ;
       
@@ -109,9 +161,15 @@ namespace lc_analysis {
       /// Get the G parity (if applicable)
       inline int gParity() const ;
       
+      /// Get the C parity (if applicable)
+      inline int cParity() const ;
+      
       /// Get the charge
       inline float charge() const ;
       
+      /// Get three times the charge, as an integer
+      inline int threeCharge() const ;
+      
       /// Get the particle name
       inline const std::string &name() const ;
       
@@ -152,16 +210,62 @@ namespace lc_analysis {
         return ( digits[digitIndex<d>()] >= 0 ) ;
       }
       
-      /// Get the digit value. Returns -1 if not set
+      /// Get the digit value. Returns 0 if not set, as the 
+      /// leading digits of a pdg id are zeros in the numbering scheme
       template <Digit d>
       static constexpr auto digit( const Digits &digits ) {
-        return digits[digitIndex<d>()] ;
+        return digitSet<d>( digits ) ? digits[digitIndex<d>()] : int8_t(0) ;
       }
     };
     
     //----------------------------------------------------------------------------
     //----------------------------------------------------------------------------
     
+    /**
+     *  @brief  MemoryReport struct
+     *
+     *  Memory footprint of the particle table and its lookup indices.
+     *  The resident and shared sizes are measured on the pages holding 
+     *  the particle records, using /proc/self/pagemap (Linux only).
+     *  Shared pages are the resident pages mapped by other processes too,
+     *  which only happens when the table lives in a file mapping.
+     */
+    struct MemoryReport {
+      /// Number of particle records
+      std::size_t                _records {0} ;
+      /// Bytes used by the particle records (table capacity)
+      std::size_t                _recordBytes {0} ;
+      /// Bytes used by the optional fields in the records (included in _recordBytes)
+      std::size_t                _optionalBytes {0} ;
+      /// Bytes of the optional fields spent on flags and padding (included in _optionalBytes)
+      std::size_t                _optionalOverheadBytes {0} ;
+      /// Heap bytes used by the particle names not fitting in the string small buffer
+      std::size_t                _nameHeapBytes {0} ;
+      /// Bytes used by the lookup indices
+      std::size_t                _indexBytes {0} ;
+      /// The mapping holding the particle records (file path, [heap], ...)
+      std::string                _mapping {} ;
+      /// Whether the particle records live in a file mapping
+      bool                       _fileMapped {false} ;
+      /// Resident bytes of the pages holding the particle records
+      std::size_t                _residentBytes {0} ;
+      /// Resident bytes of the pages holding the particle records, shared with other processes
+      std::size_t                _sharedBytes {0} ;
+      /// Whether the resident and shared sizes could be measured
+      bool                       _residencyAvailable {false} ;
+      
+      /// Total bytes used by the table, names and indices
+      inline std::size_t totalBytes() const {
+        return _recordBytes + _nameHeapBytes + _indexBytes ;
+      }
+    };
+    
+    /// Print a memory report
+    std::ostream &operator<<( std::ostream &out, const MemoryReport &report ) ;
+    
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+    
     /**
      *  @brief  PDGHelper class
      *
@@ -178,6 +282,17 @@ namespace lc_analysis {
       /// Get the particle with the given pdg id
       static const ParticleData &particle( int pdg ) ;
       
+      /// Get the memory footprint of the particle table and lookup indices
+      static MemoryReport memoryReport() ;
+      
+      /// Get the category flags of a particle (see the category namespace).
+      /// Returns 0 if the pdg id is not in the PDG table
+      static Categories categories( int pdg ) ;
+      
+      /// Batch version of categories(int). Fills the n first 
+      /// entries of categories from the n first pdg ids
+      static void categories( const int *pdgids, Categories *categories, std::size_t n ) ;
+      
       /// Whether the pdg is from a quark ( 1 -> 6 )
       static bool isQuark( const ParticleData &p ) ;
       
@@ -275,6 +390,17 @@ namespace lc_analysis {
       /// Based on the current list of defined particles/concepts
       static bool hasFundamentalAnti( const ParticleData &p ) ;
       
+      /// Get three times the charge of a particle, computed 
+      /// arithmetically from the pdg id digits. Does not 
+      /// require the particle to be in the PDG table. 
+      /// Returns 0 for pdg ids with no defined charge
+      static int threeCharge( int pdgid ) ;
+      
+      /// Batch version of threeCharge(int). Fills the n first 
+      /// entries of threeCharges from the n first pdg ids.
+      /// 16 bits: nuclei (3 Z) and Q-balls exceed the int8 range
+      static void threeCharge( const int *pdgids, int16_t *threeCharges, std::size_t n ) ;
+      
     private:
       // private helper methods
       static int extraBits( int pdgid ) ;
@@ -286,12 +412,25 @@ namespace lc_analysis {
     //----------------------------------------------------------------------------
     //----------------------------------------------------------------------------
     
+    inline ParticleData::ParticleData( const Data &d ) : 
+      _data(d) {
+      _data._threeCharge = static_cast<int16_t>( PDGHelper::threeCharge( d._pdgid ) ) ;
+    }
+    
+    //----------------------------------------------------------------------------
+    
     inline int ParticleData::pdg() const { 
       return _data._pdgid ; 
     }
     
     //----------------------------------------------------------------------------
     
+    inline bool ParticleData::hasMass() const { 
+      return _data._mass.has_value() ; 
+    }
+    
+    //----------------------------------------------------------------------------
+    
     inline float ParticleData::mass() const { 
       return _data._mass.value() ; 
     }
@@ -340,8 +479,20 @@ namespace lc_analysis {
     
     //----------------------------------------------------------------------------
     
+    inline int ParticleData::cParity() const { 
+      return _data._cParity.value() ; 
+    }
+    
+    //----------------------------------------------------------------------------
+    
     inline float ParticleData::charge() const { 
-      return _data._charge ; 
+      return _data._threeCharge / 3.f ; 
+    }
+    
+    //----------------------------------------------------------------------------
+    
+    inline int ParticleData::threeCharge() const { 
+      return _data._threeCharge ; 
     }
     
     //----------------------------------------------------------------------------
@@ -362,11 +513,12 @@ namespace lc_analysis {
 
     template <Quark q>
     inline bool PDGHelper::hasQuark( const ParticleData &p ) {
+      LCANALYSISTOOLS_ENTRY_POINT( HasQuark ) ;
       if ( isNucleus( p ) ) {
         if( Quark::u == q || Quark::d == q ) {
           return true ;
         }
-        else if ( Quark::s == q && contains( {2112, 2212}, p.pdg() ) ) {
+        else if ( Quark::s == q && ! contains( {2112, 2212}, p.pdg() ) ) {
           return ( p.digit<Digit::N8>() > 0 ) ; 
         }
       }
@@ -379,7 +531,9 @@ namespace lc_analysis {
       if ( isDyon( p ) ) {
         return false ;
       }
-      const auto qint = static_cast<int>( q ) ;
+      // pdg id digit of each quark flavor, in Quark enum order
+      constexpr int quarkDigits[] = { 2, 1, 3, 4, 5, 6 } ;
+      const auto qint = quarkDigits[ static_cast<int>( q ) ] ;
       if ( isRHadron( p ) ) {        
         auto iz = 7 ;
         for ( auto loc : {6, 5, 4, 3, 2, 1} ) {
@@ -0,0 +1,176 @@
+
+#ifndef _LCANALYSISTOOLS_PDGINDEX_H
+#define _LCANALYSISTOOLS_PDGINDEX_H
+
+// -- std headers
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/PDGHelper.h>
+
+namespace lc_analysis {
+
+  namespace pdg {
+
+    /**
+     *  @brief  PDGIndex class
+     *
+     *  Immutable lookup index over the PDG table. Holds the pdg ids
+     *  sorted for binary search together with their row in pdgTable,
+     *  and the category flags of every row, computed once with the
+     *  PDGHelper classification functions. The index is built on first
+     *  use (thread safe) and shared by all threads afterwards.
+     */
+    class PDGIndex {
+    public:
+      /// The row type, index of a particle in pdgTable
+      using Row = uint32_t ;
+
+      /// The row returned for pdg ids not in the table
+      static constexpr Row NoRow = std::numeric_limits<Row>::max() ;
+
+    public:
+      /// Get the index instance. Built on first call
+      static const PDGIndex &instance() ;
+
+      /// Get the row of a pdg id in pdgTable. Returns NoRow if not found
+      inline Row row( int pdg ) const ;
+
+      /// Get the particle of a given pdg id. Returns nullptr if not found
+      inline const ParticleData *find( int pdg ) const ;
+
+      /// Get the row of a particle name in pdgTable ("pi+", "K(S)0", ...).
+      /// Returns NoRow if not found
+      Row rowFromName( const std::string &name ) const ;
+
+      /// Get the category flags of a table row
+      inline Categories rowCategories( Row r ) const ;
+
+      /// Get the category flags of a pdg id. Returns 0 if not found
+      inline Categories categories( int pdg ) const ;
+
+      /// Get the number of indexed particles
+      inline std::size_t size() const ;
+
+      /// Get the memory used by the index, in bytes
+      std::size_t memoryBytes() const ;
+
+    private:
+      /// Constructor, builds the index from pdgTable
+      PDGIndex() ;
+
+      /// Compute the category flags of a particle
+      static Categories computeCategories( const ParticleData &p ) ;
+
+    private:
+      /// The pdg ids, sorted
+      std::vector<int>           _sortedPdgs {} ;
+      /// The table rows, in the same order as _sortedPdgs
+      std::vector<Row>           _sortedRows {} ;
+      /// The category flags, per table row
+      std::vector<Categories>    _categories {} ;
+      /// The table rows, sorted by particle name
+      std::vector<Row>           _nameSortedRows {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  ParticleRef class
+     *
+     *  Lightweight reference to a particle of the PDG table,
+     *  stored as its row in pdgTable. A default constructed 
+     *  reference, or one built from an unknown pdg id, is invalid.
+     */
+    class ParticleRef {
+    public:
+      /// Default constructor, invalid reference
+      ParticleRef() = default ;
+
+      /// Constructor from a table row
+      explicit ParticleRef( PDGIndex::Row r ) : _row(r) {}
+
+      /// Get the reference of a pdg id. Invalid if not in the table
+      static inline ParticleRef fromPdg( int pdg ) ;
+
+      /// Whether the reference points to a particle of the table
+      inline bool valid() const { return PDGIndex::NoRow != _row ; }
+
+      /// Get the table row
+      inline PDGIndex::Row row() const { return _row ; }
+
+      /// Get the particle data. The reference must be valid
+      inline const ParticleData &data() const { return pdgTable[_row] ; }
+
+      /// Get the category flags. 0 if the reference is invalid
+      inline Categories categories() const {
+        return valid() ? PDGIndex::instance().rowCategories( _row ) : 0 ;
+      }
+
+      /// Comparison operators
+      inline bool operator==( const ParticleRef &rhs ) const { return _row == rhs._row ; }
+      inline bool operator!=( const ParticleRef &rhs ) const { return _row != rhs._row ; }
+
+    private:
+      PDGIndex::Row              _row {PDGIndex::NoRow} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    inline PDGIndex::Row PDGIndex::row( int pdg ) const {
+      // branchless lower bound
+      const int *base = _sortedPdgs.data() ;
+      std::size_t n = _sortedPdgs.size() ;
+      if( 0 == n ) {
+        return NoRow ;
+      }
+      while( n > 1 ) {
+        const std::size_t half = n / 2 ;
+        base = ( base[half] <= pdg ) ? base + half : base ;
+        n -= half ;
+      }
+      return ( *base == pdg ) ? _sortedRows[ base - _sortedPdgs.data() ] : NoRow ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline const ParticleData *PDGIndex::find( int pdg ) const {
+      const auto r = row( pdg ) ;
+      return ( NoRow == r ) ? nullptr : &pdgTable[r] ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline Categories PDGIndex::rowCategories( Row r ) const {
+      return _categories[r] ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline Categories PDGIndex::categories( int pdg ) const {
+      const auto r = row( pdg ) ;
+      return ( NoRow == r ) ? 0 : _categories[r] ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline std::size_t PDGIndex::size() const {
+      return _categories.size() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline ParticleRef ParticleRef::fromPdg( int pdg ) {
+      return ParticleRef( PDGIndex::instance().row( pdg ) ) ;
+    }
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,134 @@
+
+#ifndef _LCANALYSISTOOLS_PFOCLASSIFICATION_H
+#define _LCANALYSISTOOLS_PFOCLASSIFICATION_H
+
+// -- std headers
+#include <cstdint>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/PDGHelper.h>
+
+namespace EVENT {
+  class LCCollection ;
+}
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    /// Selection bits of a PFO, combined in a bit mask
+    using SelectionMask = uint32_t ;
+
+    /**
+     *  @brief  PFOSelection struct
+     *
+     *  Selects PFOs on the category flags of their type code:
+     *  all the required flags must be set, none of the vetoed flags
+     */
+    struct PFOSelection {
+      /// The selection name
+      const char                *_name {""} ;
+      /// Category flags that must all be set
+      pdg::Categories            _requiredCategories {0} ;
+      /// Category flags that must not be set
+      pdg::Categories            _vetoedCategories {0} ;
+
+      /// Whether category flags pass the selection
+      inline bool matches( pdg::Categories categories ) const {
+        return ( ( categories & _requiredCategories ) == _requiredCategories )
+          && ( 0 == ( categories & _vetoedCategories ) ) ;
+      }
+    };
+
+    /// The standard PFO selections, one bit each in the selection masks
+    namespace pfo {
+      static constexpr PFOSelection ChargedHadron = { "ChargedHadron", pdg::category::Hadron | pdg::category::Charged, 0 } ;
+      static constexpr PFOSelection NeutralHadron = { "NeutralHadron", pdg::category::Hadron, pdg::category::Charged } ;
+      /// the only neutral gauge boson type found in PFO collections
+      static constexpr PFOSelection Photon        = { "Photon", pdg::category::SMGaugeBosonOrHiggs, pdg::category::Charged } ;
+      static constexpr PFOSelection ChargedLepton = { "ChargedLepton", pdg::category::Lepton | pdg::category::Charged, 0 } ;
+      static constexpr PFOSelection Charged       = { "Charged", pdg::category::Charged, 0 } ;
+      static constexpr PFOSelection Neutral       = { "Neutral", pdg::category::Known, pdg::category::Charged } ;
+      /// type codes not in the PDG table (e.g 0)
+      static constexpr PFOSelection Unknown       = { "Unknown", 0, pdg::category::Known } ;
+
+      /// The selections, in bit order
+      static constexpr PFOSelection Selections[] = {
+        ChargedHadron, NeutralHadron, Photon, ChargedLepton, Charged, Neutral, Unknown
+      };
+
+      /// The number of standard selections
+      static constexpr std::size_t NSelections = sizeof(Selections) / sizeof(PFOSelection) ;
+
+      /// The selection mask bits
+      static constexpr SelectionMask ChargedHadronBit = 1u << 0 ;
+      static constexpr SelectionMask NeutralHadronBit = 1u << 1 ;
+      static constexpr SelectionMask PhotonBit        = 1u << 2 ;
+      static constexpr SelectionMask ChargedLeptonBit = 1u << 3 ;
+      static constexpr SelectionMask ChargedBit       = 1u << 4 ;
+      static constexpr SelectionMask NeutralBit       = 1u << 5 ;
+      static constexpr SelectionMask UnknownBit       = 1u << 6 ;
+    }
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  PFOClassification class
+     *
+     *  Batch classification of the PFOs of a ReconstructedParticle collection.
+     *  The type codes (ReconstructedParticle::getType(), pdg-like) are read
+     *  once into a contiguous buffer and classified in one batch call to
+     *  PDGHelper::categories(). Each PFO then gets its category flags and a
+     *  mask of the standard selections it passes (see the pfo namespace),
+     *  so that the next steps select PFOs without going back to LCIO.
+     *  The buffers are reused between events.
+     */
+    class PFOClassification {
+    public:
+      /// Classify the PFOs of a ReconstructedParticle collection
+      void classify( const EVENT::LCCollection *pfos ) ;
+
+      /// Classify PFOs given by their type codes
+      void classify( const std::vector<int> &types ) ;
+
+      /// Get the number of classified PFOs
+      inline std::size_t size() const { return _types.size() ; }
+
+      /// Get the type codes, per PFO
+      inline const std::vector<int> &types() const { return _types ; }
+
+      /// Get the category flags, per PFO
+      inline const std::vector<pdg::Categories> &categories() const { return _categories ; }
+
+      /// Get the standard selection masks, per PFO
+      inline const std::vector<SelectionMask> &selections() const { return _selections ; }
+
+      /// Get the indices of the PFOs passing all the selections of a mask
+      void select( SelectionMask mask, std::vector<uint32_t> &indices ) const ;
+
+      /// Get the indices of the PFOs passing a custom selection
+      void select( const PFOSelection &selection, std::vector<uint32_t> &indices ) const ;
+
+      /// Count the PFOs passing all the selections of a mask
+      std::size_t count( SelectionMask mask ) const ;
+
+    private:
+      /// Classify the type codes in the buffer
+      void classifyTypes() ;
+
+    private:
+      /// The type codes
+      std::vector<int>                 _types {} ;
+      /// The category flags
+      std::vector<pdg::Categories>     _categories {} ;
+      /// The standard selection masks
+      std::vector<SelectionMask>       _selections {} ;
+    };
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+
+#ifndef _LCANALYSISTOOLS_PARALLELSIOREADER_H
+#define _LCANALYSISTOOLS_PARALLELSIOREADER_H
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/SIOScanner.h>
+
+// -- std headers
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lc_analysis {
+
+  namespace io {
+
+    /**
+     *  @brief  SIOEventData struct
+     *
+     *  The (inflated) header and event records of an event and their blocks.
+     *  The record data are views of the file mapping for uncompressed records,
+     *  else point to the buffers: the struct owns them, and swapping it keeps
+     *  the data pointers valid
+     */
+    struct SIOEventData {
+      /// The index of the event in the file (see SIOScanner::events())
+      std::size_t                _index {0} ;
+      int                        _runNumber {0} ;
+      int                        _eventNumber {0} ;
+      /// The LCEventHeader record data and blocks
+      const uint8_t             *_headerData {nullptr} ;
+      std::vector<SIOBlock>      _headerBlocks {} ;
+      /// The LCEvent record data and blocks (the collections)
+      const uint8_t             *_eventData {nullptr} ;
+      std::vector<SIOBlock>      _blocks {} ;
+      /// The buffers of the inflated records
+      std::vector<uint8_t>       _headerBuffer {} ;
+      std::vector<uint8_t>       _eventBuffer {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  ParallelSIOReader class
+     *
+     *  Reads the events of a scanned file, inflating their records on a pool
+     *  of worker threads. The record boundaries are known ahead of time from
+     *  the SIOScanner index: the workers claim the next events in file order
+     *  and inflate them concurrently, in a ring of slots (the events in
+     *  flight). The events are handed to the consumer in file order by next(),
+     *  which waits for the oldest slot only. A slot is given back to the
+     *  workers once consumed, bounding the memory to nSlots events.
+     *  next() swaps the event with the consumer's one: the buffers go round
+     *  the ring and are reused, without allocation once warmed up.
+     */
+    class ParallelSIOReader {
+    public:
+      /// Constructor: start nThreads workers on the events of a scanner, with
+      /// nSlots events in flight (default 0: 4 per thread). The scanner must
+      /// outlive the reader. Throws if nThreads is 0
+      ParallelSIOReader( const SIOScanner &scanner, unsigned int nThreads, std::size_t nSlots = 0 ) ;
+
+      /// Destructor: stop and join the workers, even if not all the events were read
+      ~ParallelSIOReader() ;
+
+      ParallelSIOReader( const ParallelSIOReader & ) = delete ;
+      ParallelSIOReader &operator=( const ParallelSIOReader & ) = delete ;
+
+      /// Get the next event, in file order. Returns false after the last event.
+      /// Throws if the records of the event are invalid (the event is skipped)
+      bool next( SIOEventData &event ) ;
+
+      /// Get the number of worker threads and of slots
+      inline std::size_t nThreads() const { return _threads.size() ; }
+      inline std::size_t nSlots() const { return _slots.size() ; }
+
+      /// Inflate the records of an event of a scanner and list their blocks
+      static void decode( const SIOScanner &scanner, std::size_t index, SIOEventData &event ) ;
+
+    private:
+      /// An event in flight: ready once inflated, or failed
+      struct Slot {
+        SIOEventData             _event {} ;
+        std::exception_ptr       _error {} ;
+        bool                     _ready {false} ;
+      };
+
+      /// The worker loop
+      void work() ;
+
+      /// Stop and join the workers
+      void stop() ;
+
+    private:
+      const SIOScanner                  &_scanner ;
+      std::vector<Slot>                  _slots {} ;
+      std::vector<std::thread>           _threads {} ;
+      /// Guards the slot states and the counters
+      std::mutex                         _mutex {} ;
+      std::condition_variable            _readyCondition {} ;
+      std::condition_variable            _freeCondition {} ;
+      /// The next event to inflate, and to hand to the consumer
+      std::size_t                        _nextTask {0} ;
+      std::size_t                        _nextEvent {0} ;
+      bool                               _stop {false} ;
+    };
+
+  }
+
+}
+
+#endif
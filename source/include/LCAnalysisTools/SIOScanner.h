@@ -0,0 +1,122 @@
+
+#ifndef _LCANALYSISTOOLS_SIOSCANNER_H
+#define _LCANALYSISTOOLS_SIOSCANNER_H
+
+// -- std headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lc_analysis {
+
+  namespace io {
+
+    /// A record of an SIO file
+    struct SIORecord {
+      /// The record name, e.g LCEventHeader, LCEvent, LCRunHeader
+      std::string                _name {} ;
+      /// The offset of the record header in the file
+      uint64_t                   _offset {0} ;
+      /// The offset of the record data in the file, and its length in the file
+      uint64_t                   _dataOffset {0} ;
+      uint32_t                   _dataLength {0} ;
+      /// The length of the data once inflated (_dataLength if not compressed)
+      uint32_t                   _uncompressedLength {0} ;
+      /// Whether the data is zlib compressed
+      bool                       _compressed {false} ;
+    };
+
+    /// A block of an SIO record, e.g a collection of an LCEvent record
+    struct SIOBlock {
+      /// The block name, e.g the collection name
+      std::string                _name {} ;
+      /// The block version
+      uint32_t                   _version {0} ;
+      /// The offset of the block payload in the (inflated) record data, and its length
+      uint32_t                   _offset {0} ;
+      uint32_t                   _length {0} ;
+    };
+
+    /// An event of an LCIO file: its numbers and records
+    struct SIOEvent {
+      int                        _runNumber {0} ;
+      int                        _eventNumber {0} ;
+      /// The indices of the LCEventHeader and LCEvent records
+      uint32_t                   _headerRecord {0} ;
+      uint32_t                   _eventRecord {0} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  SIOScanner class
+     *
+     *  Read-only scanner of LCIO (.slcio) files. The file is memory mapped
+     *  and its SIO records are indexed by walking the record headers (big
+     *  endian: header length, 0xabadcafe marker, options, data length,
+     *  inflated data length, name length and padded name), without reading
+     *  the record data: nothing is copied or allocated per collection.
+     *  The events are indexed from the LCEventHeader records (run and event
+     *  numbers, the only inflated payloads) and the following LCEvent record.
+     *  The blocks of a record (the collections of an LCEvent record, header
+     *  0xdeadbeef marker) are listed on request, as byte ranges of the record
+     *  data: a view of the mapping for uncompressed records, else inflated in
+     *  a caller provided buffer.
+     */
+    class SIOScanner {
+    public:
+      /// Constructor: map and index a file. Throws if it can not be mapped or
+      /// is not a valid SIO file
+      explicit SIOScanner( const std::string &fileName ) ;
+
+      /// Destructor: unmap the file
+      ~SIOScanner() ;
+
+      SIOScanner( const SIOScanner & ) = delete ;
+      SIOScanner &operator=( const SIOScanner & ) = delete ;
+
+      /// Get the file name
+      inline const std::string &fileName() const { return _fileName ; }
+
+      /// Get the mapped file and its size
+      inline const uint8_t *data() const { return _data ; }
+      inline std::size_t size() const { return _size ; }
+
+      /// Get the records, in file order
+      inline const std::vector<SIORecord> &records() const { return _records ; }
+
+      /// Get the events, in file order
+      inline const std::vector<SIOEvent> &events() const { return _events ; }
+
+      /// Get the data of a record, _uncompressedLength bytes: in the mapping if
+      /// the record is not compressed, else inflated in the buffer
+      const uint8_t *recordData( const SIORecord &record, std::vector<uint8_t> &buffer ) const ;
+
+      /// Get the collection blocks of an event, from its LCEvent record. Returns
+      /// the record data, that the block offsets refer to (see recordData())
+      const uint8_t *collections( std::size_t event, std::vector<uint8_t> &buffer, std::vector<SIOBlock> &blocks ) const ;
+
+      /// Get the blocks of record data. Throws on invalid block headers
+      static void blocks( const uint8_t *data, std::size_t length, std::vector<SIOBlock> &blocks ) ;
+
+      /// Inflate zlib compressed record data into exactly outLength bytes. Throws on errors
+      static void inflate( const uint8_t *data, std::size_t length, uint8_t *out, std::size_t outLength ) ;
+
+    private:
+      /// Index the records and the events
+      void scan() ;
+
+    private:
+      std::string                        _fileName {} ;
+      const uint8_t                     *_data {nullptr} ;
+      std::size_t                        _size {0} ;
+      std::vector<SIORecord>             _records {} ;
+      std::vector<SIOEvent>              _events {} ;
+    };
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,188 @@
+
+#ifndef _LCANALYSISTOOLS_TRUTHLINKS_H
+#define _LCANALYSISTOOLS_TRUTHLINKS_H
+
+// -- std headers
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/DecayTree.h>
+
+namespace EVENT {
+  class LCCollection ;
+  class LCObject ;
+}
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    /// Index of an object in its collection
+    using ObjectIndex = uint32_t ;
+
+    /// The index returned for objects without link
+    static constexpr ObjectIndex NoObject = std::numeric_limits<ObjectIndex>::max() ;
+
+    /// A truth link, seen from one of its ends: the linked object index and the weight
+    struct TruthLink {
+      ObjectIndex                _index {NoObject} ;
+      float                      _weight {0.f} ;
+    };
+
+    /// How the LCRelation weights are read
+    enum class LinkWeight {
+      Raw,        ///< the weight as stored
+      Track,      ///< the track weight of combined weights: (int(w) % 10000) / 1000
+      Cluster     ///< the cluster weight of combined weights: (int(w) / 10000) / 1000
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  LinkSpan class
+     *
+     *  A contiguous, read-only range of truth links
+     */
+    class LinkSpan {
+    public:
+      LinkSpan( const TruthLink *b, const TruthLink *e ) : _begin(b), _end(e) {}
+      inline const TruthLink *begin() const { return _begin ; }
+      inline const TruthLink *end() const { return _end ; }
+      inline std::size_t size() const { return _end - _begin ; }
+      inline bool empty() const { return _begin == _end ; }
+      inline const TruthLink &operator[]( std::size_t i ) const { return _begin[i] ; }
+
+    private:
+      const TruthLink           *_begin {nullptr} ;
+      const TruthLink           *_end {nullptr} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    /**
+     *  @brief  TruthLinkIndex class
+     *
+     *  Flat, per-event index of the links between reconstructed objects and
+     *  MC particles, replacing LCRelationNavigator lookups. The relation
+     *  collection is read once and both ends are turned into collection
+     *  indices. The links of each reco object and of each MC particle are
+     *  then stored contiguously (CSR layout), sorted by decreasing weight, so
+     *  the best match is the first link: an O(1) lookup with no allocation.
+     *  MC particle indices are DecayTree node indices, so the truth category
+     *  and node flags of a match come from the decay tree of the event.
+     *  The buffers are reused between events.
+     */
+    class TruthLinkIndex {
+    public:
+      /// A link given by the collection indices of its ends
+      struct Link {
+        ObjectIndex                _reco {NoObject} ;
+        ObjectIndex                _mc {NoObject} ;
+        float                      _weight {0.f} ;
+      };
+
+    public:
+      /// Build the index from a relation collection between the reco objects
+      /// and the MC particles, in either direction (from the "FromType"
+      /// collection parameter). Links to objects not in the given collections
+      /// are ignored
+      void build( const EVENT::LCCollection *relations, const EVENT::LCCollection *recoObjects,
+        const EVENT::LCCollection *mcParticles, LinkWeight weight = LinkWeight::Raw ) ;
+
+      /// Build the index from links given by collection indices.
+      /// Links with an index out of range are ignored
+      void build( std::size_t nrecoObjects, std::size_t nmcParticles, const std::vector<Link> &links ) ;
+
+      /// Get the MC links of a reco object, by decreasing weight
+      inline LinkSpan mcLinks( ObjectIndex reco ) const ;
+
+      /// Get the reco links of an MC particle, by decreasing weight
+      inline LinkSpan recoLinks( ObjectIndex mc ) const ;
+
+      /// Get the MC particle with the highest weight for a reco object. NoObject if none
+      inline ObjectIndex bestMC( ObjectIndex reco ) const ;
+
+      /// Get the reco object with the highest weight for an MC particle. NoObject if none
+      inline ObjectIndex bestReco( ObjectIndex mc ) const ;
+
+      /// Get the truth category flags of a reco object: the category flags of
+      /// its best MC match in the decay tree of the event. 0 if unmatched
+      inline pdg::Categories truthCategories( const DecayTree &tree, ObjectIndex reco ) const ;
+
+      /// Get the truth category flags of all reco objects, in a batch
+      void truthCategories( const DecayTree &tree, std::vector<pdg::Categories> &categories ) const ;
+
+      /// Get the number of reco objects
+      inline std::size_t nRecoObjects() const { return _recoOffsets.empty() ? 0 : _recoOffsets.size()-1 ; }
+
+      /// Get the number of MC particles
+      inline std::size_t nMCParticles() const { return _mcOffsets.empty() ? 0 : _mcOffsets.size()-1 ; }
+
+      /// Get the number of links
+      inline std::size_t nLinks() const { return _recoLinks.size() ; }
+
+      /// Get the memory used by the index, in bytes
+      std::size_t memoryBytes() const ;
+
+    private:
+      /// Fill one side of the index: offsets and links sorted by weight
+      static void fillSide( std::size_t nobjects, const std::vector<Link> &links, bool recoSide,
+        std::vector<uint32_t> &offsets, std::vector<TruthLink> &sideLinks ) ;
+
+    private:
+      /// The link offsets of each reco object, plus the end offset
+      std::vector<uint32_t>      _recoOffsets {} ;
+      /// The MC links of the reco objects
+      std::vector<TruthLink>     _recoLinks {} ;
+      /// The link offsets of each MC particle, plus the end offset
+      std::vector<uint32_t>      _mcOffsets {} ;
+      /// The reco links of the MC particles
+      std::vector<TruthLink>     _mcLinks {} ;
+      /// Build scratch: links, and sorted objects with their index
+      std::vector<Link>          _links {} ;
+      std::vector<std::pair<const EVENT::LCObject*, ObjectIndex>> _sortedRecoObjects {} ;
+      std::vector<std::pair<const EVENT::LCObject*, ObjectIndex>> _sortedMCParticles {} ;
+    };
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    inline LinkSpan TruthLinkIndex::mcLinks( ObjectIndex reco ) const {
+      return LinkSpan( _recoLinks.data() + _recoOffsets[reco], _recoLinks.data() + _recoOffsets[reco+1] ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline LinkSpan TruthLinkIndex::recoLinks( ObjectIndex mc ) const {
+      return LinkSpan( _mcLinks.data() + _mcOffsets[mc], _mcLinks.data() + _mcOffsets[mc+1] ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline ObjectIndex TruthLinkIndex::bestMC( ObjectIndex reco ) const {
+      return ( _recoOffsets[reco] != _recoOffsets[reco+1] ) ? _recoLinks[ _recoOffsets[reco] ]._index : NoObject ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline ObjectIndex TruthLinkIndex::bestReco( ObjectIndex mc ) const {
+      return ( _mcOffsets[mc] != _mcOffsets[mc+1] ) ? _mcLinks[ _mcOffsets[mc] ]._index : NoObject ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    inline pdg::Categories TruthLinkIndex::truthCategories( const DecayTree &tree, ObjectIndex reco ) const {
+      const auto mc = bestMC( reco ) ;
+      return ( NoObject != mc && mc < tree.size() ) ? tree.categories( mc ) : 0 ;
+    }
+
+  }
+
+}
+
+#endif
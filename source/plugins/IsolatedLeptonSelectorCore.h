@@ -0,0 +1,130 @@
+
+#ifndef _LCANALYSISTOOLS_ISOLATEDLEPTONSELECTORCORE_H
+#define _LCANALYSISTOOLS_ISOLATEDLEPTONSELECTORCORE_H
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCEvent.h>
+#include <Exceptions.h>
+
+// -- LCAnalysisTools headers
+#include "PFOSubset.h"
+#include <LCAnalysisTools/IsolatedLeptons.h>
+
+// -- std headers
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace lc_analysis {
+
+  /**
+   *  @brief  IsolatedLeptonSelectorCore class
+   *
+   *  The event processing of the IsolatedLeptonSelector processor, shared by
+   *  the Marlin and MarlinMT versions: selects the isolated electrons and
+   *  muons of a PFO collection with reco::IsolatedLeptonFinder, writes them
+   *  in a subset collection and keeps the statistics. The processors only
+   *  read their parameters and write the log messages
+   */
+  class IsolatedLeptonSelectorCore {
+  public:
+    /// Set the collection names and the isolation cuts: the cosine of the
+    /// cone half angle, the minimum lepton energy and the maximum cone
+    /// energy fraction
+    inline void init( const std::string &pfoCollectionName, const std::string &outputCollectionName,
+      double cosConeAngle, double minEnergy, double maxConeEnergyFraction ) ;
+
+    /// Select the isolated leptons of an event and add the output collection.
+    /// Returns false if the event has no PFO collection
+    inline bool processEvent( EVENT::LCEvent &event ) ;
+
+    /// Get a description of the last processed event
+    inline std::string eventSummary() const ;
+
+    /// Get the end of job summary lines. The scope (e.g. " in this thread")
+    /// is appended to the number of events
+    inline std::vector<std::string> summary( const std::string &scope ) const ;
+
+  private:
+    /// The collection names
+    std::string                _pfoCollectionName {} ;
+    std::string                _outputCollectionName {} ;
+    /// The isolation cuts
+    double                     _minEnergy {0.} ;
+    double                     _maxConeEnergyFraction {0.} ;
+    /// The isolation buffers, reused between events
+    std::unique_ptr<reco::IsolatedLeptonFinder> _finder {} ;
+    std::vector<uint32_t>      _isolated {} ;
+    /// The time of the last event, in us
+    double                     _lastTime {0.} ;
+    /// The statistics
+    std::size_t                _nEvents {0} ;
+    std::size_t                _nCandidates {0} ;
+    std::size_t                _nIsolated {0} ;
+    double                     _totalTime {0.} ;
+  };
+
+  //--------------------------------------------------------------------------------
+  //--------------------------------------------------------------------------------
+
+  inline void IsolatedLeptonSelectorCore::init( const std::string &pfoCollectionName, const std::string &outputCollectionName,
+    double cosConeAngle, double minEnergy, double maxConeEnergyFraction ) {
+    _pfoCollectionName = pfoCollectionName ;
+    _outputCollectionName = outputCollectionName ;
+    _minEnergy = minEnergy ;
+    _maxConeEnergyFraction = maxConeEnergyFraction ;
+    _finder = std::make_unique<reco::IsolatedLeptonFinder>( std::vector<double>{ cosConeAngle } ) ;
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline bool IsolatedLeptonSelectorCore::processEvent( EVENT::LCEvent &event ) {
+    EVENT::LCCollection *pfos = nullptr ;
+    try {
+      pfos = event.getCollection( _pfoCollectionName ) ;
+    }
+    catch( const EVENT::DataNotAvailableException & ) {
+      return false ;
+    }
+    const auto start = std::chrono::steady_clock::now() ;
+    _finder->process( pfos ) ;
+    _finder->isolated( 0, _minEnergy, _maxConeEnergyFraction, _isolated ) ;
+    const double elapsed = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count() ;
+    event.addCollection( pfoSubset( pfos, _isolated, _pfoCollectionName ), _outputCollectionName ) ;
+
+    _lastTime = elapsed ;
+    ++_nEvents ;
+    _nCandidates += _finder->candidates().size() ;
+    _nIsolated += _isolated.size() ;
+    _totalTime += elapsed ;
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline std::string IsolatedLeptonSelectorCore::eventSummary() const {
+    std::stringstream ss ;
+    ss << "Selected " << _isolated.size() << " of " << _finder->candidates().size()
+      << " lepton candidates in " << _lastTime << " us" ;
+    return ss.str() ;
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline std::vector<std::string> IsolatedLeptonSelectorCore::summary( const std::string &scope ) const {
+    if( 0 == _nEvents ) {
+      return { "No event processed" + scope } ;
+    }
+    std::stringstream ss ;
+    ss << "Selected " << _nIsolated << " of " << _nCandidates << " lepton candidates in " << _nEvents << " events" << scope << ", "
+      << _totalTime / _nEvents << " us per event" ;
+    return { ss.str() } ;
+  }
+
+}
+
+#endif
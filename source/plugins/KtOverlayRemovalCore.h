@@ -0,0 +1,129 @@
+
+#ifndef _LCANALYSISTOOLS_KTOVERLAYREMOVALCORE_H
+#define _LCANALYSISTOOLS_KTOVERLAYREMOVALCORE_H
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCEvent.h>
+#include <Exceptions.h>
+
+// -- LCAnalysisTools headers
+#include "PFOSubset.h"
+#include <LCAnalysisTools/OverlayRemoval.h>
+
+// -- std headers
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lc_analysis {
+
+  /**
+   *  @brief  KtOverlayRemovalCore class
+   *
+   *  The event processing of the KtOverlayRemoval processor, shared by the
+   *  Marlin and MarlinMT versions: removes the overlay from a PFO collection
+   *  with reco::OverlayRemoval, writes the kept and removed PFOs in two
+   *  subset collections and keeps the statistics. The processors only read
+   *  their parameters and write the log messages
+   */
+  class KtOverlayRemovalCore {
+  public:
+    /// Set the collection names and build the clustering for the kt radius
+    /// and the number of exclusive jets, which must be positive
+    inline void init( const std::string &pfoCollectionName, const std::string &keptCollectionName,
+      const std::string &removedCollectionName, double R, int nJets ) ;
+
+    /// Remove the overlay from the PFOs of an event and add the output collections.
+    /// Returns false if the event has no PFO collection
+    inline bool processEvent( EVENT::LCEvent &event ) ;
+
+    /// Get a description of the last processed event
+    inline std::string eventSummary() const ;
+
+    /// Get the end of job summary lines. The scope (e.g. " in this thread")
+    /// is appended to the number of events
+    inline std::vector<std::string> summary( const std::string &scope ) const ;
+
+  private:
+    /// The collection names
+    std::string                _pfoCollectionName {} ;
+    std::string                _keptCollectionName {} ;
+    std::string                _removedCollectionName {} ;
+    /// The clustering buffers, reused between events
+    std::unique_ptr<reco::OverlayRemoval> _removal {} ;
+    /// The number of PFOs and the time of the last event, in us
+    std::size_t                _lastPFOs {0} ;
+    double                     _lastTime {0.} ;
+    /// The statistics
+    std::size_t                _nEvents {0} ;
+    std::size_t                _nPFOs {0} ;
+    std::size_t                _nRemoved {0} ;
+    double                     _totalTime {0.} ;
+  };
+
+  //--------------------------------------------------------------------------------
+  //--------------------------------------------------------------------------------
+
+  inline void KtOverlayRemovalCore::init( const std::string &pfoCollectionName, const std::string &keptCollectionName,
+    const std::string &removedCollectionName, double R, int nJets ) {
+    if( nJets < 1 ) {
+      throw std::runtime_error( "KtOverlayRemoval: NJets must be positive" ) ;
+    }
+    _pfoCollectionName = pfoCollectionName ;
+    _keptCollectionName = keptCollectionName ;
+    _removedCollectionName = removedCollectionName ;
+    _removal = std::make_unique<reco::OverlayRemoval>( R, static_cast<std::size_t>( nJets ) ) ;
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline bool KtOverlayRemovalCore::processEvent( EVENT::LCEvent &event ) {
+    EVENT::LCCollection *pfos = nullptr ;
+    try {
+      pfos = event.getCollection( _pfoCollectionName ) ;
+    }
+    catch( const EVENT::DataNotAvailableException & ) {
+      return false ;
+    }
+    const auto start = std::chrono::steady_clock::now() ;
+    _removal->process( pfos ) ;
+    const double elapsed = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count() ;
+    event.addCollection( pfoSubset( pfos, _removal->kept(), _pfoCollectionName ), _keptCollectionName ) ;
+    event.addCollection( pfoSubset( pfos, _removal->removed(), _pfoCollectionName ), _removedCollectionName ) ;
+
+    _lastPFOs = pfos->getNumberOfElements() ;
+    _lastTime = elapsed ;
+    ++_nEvents ;
+    _nPFOs += _lastPFOs ;
+    _nRemoved += _removal->removed().size() ;
+    _totalTime += elapsed ;
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline std::string KtOverlayRemovalCore::eventSummary() const {
+    std::stringstream ss ;
+    ss << "Removed " << _removal->removed().size() << " of " << _lastPFOs << " PFOs in " << _lastTime << " us" ;
+    return ss.str() ;
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline std::vector<std::string> KtOverlayRemovalCore::summary( const std::string &scope ) const {
+    if( 0 == _nEvents ) {
+      return { "No event processed" + scope } ;
+    }
+    std::stringstream ss ;
+    ss << "Removed " << _nRemoved << " of " << _nPFOs << " PFOs in " << _nEvents << " events" << scope << ", "
+      << _totalTime / _nEvents << " us per event" ;
+    return { ss.str() } ;
+  }
+
+}
+
+#endif
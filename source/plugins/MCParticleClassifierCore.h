@@ -0,0 +1,156 @@
+
+#ifndef _LCANALYSISTOOLS_MCPARTICLECLASSIFIERCORE_H
+#define _LCANALYSISTOOLS_MCPARTICLECLASSIFIERCORE_H
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCEvent.h>
+#include <EVENT/LCIntVec.h>
+#include <EVENT/LCIO.h>
+#include <EVENT/MCParticle.h>
+#include <IMPL/LCCollectionVec.h>
+#include <Exceptions.h>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/PDGHelper.h>
+
+// -- std headers
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace lc_analysis {
+
+  /**
+   *  @brief  MCParticleClassifierCore class
+   *
+   *  The event processing of the MCParticleClassifier processor, shared by
+   *  the Marlin and MarlinMT versions: classifies the particles of an
+   *  MCParticle collection in a single batch pass, publishes their category
+   *  flags in an LCIntVec collection and keeps the timing statistics.
+   *  The processors only read their parameters and write the log messages
+   */
+  class MCParticleClassifierCore {
+  public:
+    /// Set the collection names and build the shared particle index
+    /// and the flag names before the event loop
+    inline void init( const std::string &mcParticleCollectionName, const std::string &outputCollectionName ) ;
+
+    /// Classify the particles of an event and add the output collection.
+    /// Returns false if the event has no MCParticle collection
+    inline bool processEvent( EVENT::LCEvent &event ) ;
+
+    /// Get a description of the last processed event
+    inline std::string eventSummary() const ;
+
+    /// Get the end of job summary lines. The scope (e.g. " in this thread")
+    /// is appended to the number of events
+    inline std::vector<std::string> summary( const std::string &scope ) const ;
+
+  private:
+    /// The collection names
+    std::string                _mcParticleCollectionName {} ;
+    std::string                _outputCollectionName {} ;
+    /// The flag names, written with each output collection
+    std::vector<std::string>   _categoryNames {} ;
+    /// Scratch buffers, reused between events
+    std::vector<int>           _pdgs {} ;
+    std::vector<pdg::Categories> _categories {} ;
+    /// The number of particles and the time of the last event, in us
+    std::size_t                _lastParticles {0} ;
+    double                     _lastTime {0.} ;
+    /// The timing statistics
+    std::size_t                _nEvents {0} ;
+    std::size_t                _nParticles {0} ;
+    double                     _totalTime {0.} ;
+    double                     _minTime {std::numeric_limits<double>::max()} ;
+    double                     _maxTime {0.} ;
+  };
+
+  //--------------------------------------------------------------------------------
+  //--------------------------------------------------------------------------------
+
+  inline void MCParticleClassifierCore::init( const std::string &mcParticleCollectionName, const std::string &outputCollectionName ) {
+    _mcParticleCollectionName = mcParticleCollectionName ;
+    _outputCollectionName = outputCollectionName ;
+    // build the shared particle index before the event loop
+    pdg::PDGHelper::categories( 0 ) ;
+    _categoryNames.clear() ;
+    for( std::size_t bit=0 ; bit<pdg::category::NCategories ; ++bit ) {
+      _categoryNames.push_back( pdg::category::name( bit ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline bool MCParticleClassifierCore::processEvent( EVENT::LCEvent &event ) {
+    EVENT::LCCollection *mcParticles = nullptr ;
+    try {
+      mcParticles = event.getCollection( _mcParticleCollectionName ) ;
+    }
+    catch( const EVENT::DataNotAvailableException & ) {
+      return false ;
+    }
+    const auto start = std::chrono::steady_clock::now() ;
+    const std::size_t nParticles = mcParticles->getNumberOfElements() ;
+    _pdgs.resize( nParticles ) ;
+    _categories.resize( nParticles ) ;
+    for( std::size_t i=0 ; i<nParticles ; ++i ) {
+      _pdgs[i] = static_cast<EVENT::MCParticle*>( mcParticles->getElementAt( i ) )->getPDG() ;
+    }
+    pdg::PDGHelper::categories( _pdgs.data(), _categories.data(), nParticles ) ;
+    auto flags = new EVENT::LCIntVec() ;
+    flags->assign( _categories.begin(), _categories.end() ) ;
+    const double elapsed = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count() ;
+
+    auto outputCollection = new IMPL::LCCollectionVec( EVENT::LCIO::LCINTVEC ) ;
+    outputCollection->addElement( flags ) ;
+    outputCollection->parameters().setValues( "CategoryNames", _categoryNames ) ;
+    outputCollection->parameters().setValue( "MCParticleCollection", _mcParticleCollectionName ) ;
+    event.addCollection( outputCollection, _outputCollectionName ) ;
+
+    _lastParticles = nParticles ;
+    _lastTime = elapsed ;
+    ++_nEvents ;
+    _nParticles += nParticles ;
+    _totalTime += elapsed ;
+    _minTime = std::min( _minTime, elapsed ) ;
+    _maxTime = std::max( _maxTime, elapsed ) ;
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline std::string MCParticleClassifierCore::eventSummary() const {
+    std::stringstream ss ;
+    ss << "Classified " << _lastParticles << " particles in " << _lastTime << " us" ;
+    return ss.str() ;
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline std::vector<std::string> MCParticleClassifierCore::summary( const std::string &scope ) const {
+    if( 0 == _nEvents ) {
+      return { "No event processed" + scope } ;
+    }
+    std::vector<std::string> lines ;
+    std::stringstream ss ;
+    ss << "Classified " << _nParticles << " particles in " << _nEvents << " events" << scope ;
+    lines.push_back( ss.str() ) ;
+    ss.str( "" ) ;
+    ss << "Time per event (us): mean " << _totalTime / _nEvents << ", min " << _minTime << ", max " << _maxTime ;
+    lines.push_back( ss.str() ) ;
+    if( _nParticles > 0 ) {
+      ss.str( "" ) ;
+      ss << "Time per particle (ns): " << 1000. * _totalTime / _nParticles ;
+      lines.push_back( ss.str() ) ;
+    }
+    return lines ;
+  }
+
+}
+
+#endif
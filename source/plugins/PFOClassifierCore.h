@@ -0,0 +1,151 @@
+
+#ifndef _LCANALYSISTOOLS_PFOCLASSIFIERCORE_H
+#define _LCANALYSISTOOLS_PFOCLASSIFIERCORE_H
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCEvent.h>
+#include <EVENT/LCIntVec.h>
+#include <EVENT/LCIO.h>
+#include <IMPL/LCCollectionVec.h>
+#include <Exceptions.h>
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/PFOClassification.h>
+
+// -- std headers
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace lc_analysis {
+
+  /**
+   *  @brief  PFOClassifierCore class
+   *
+   *  The event processing of the PFOClassifier processor, shared by the
+   *  Marlin and MarlinMT versions: classifies the PFOs of a collection with
+   *  reco::PFOClassification, publishes their category flags and selection
+   *  masks in an LCIntVec collection and counts the PFOs per selection.
+   *  The processors only read their parameters and write the log messages
+   */
+  class PFOClassifierCore {
+  public:
+    /// Set the collection names and build the shared particle index
+    /// and the flag and selection names before the event loop
+    inline void init( const std::string &pfoCollectionName, const std::string &outputCollectionName ) ;
+
+    /// Classify the PFOs of an event and add the output collection.
+    /// Returns false if the event has no PFO collection
+    inline bool processEvent( EVENT::LCEvent &event ) ;
+
+    /// Get a description of the last processed event
+    inline std::string eventSummary() const ;
+
+    /// Get the end of job summary lines. The scope (e.g. " in this thread")
+    /// is appended to the number of events
+    inline std::vector<std::string> summary( const std::string &scope ) const ;
+
+  private:
+    /// The collection names
+    std::string                _pfoCollectionName {} ;
+    std::string                _outputCollectionName {} ;
+    /// The flag and selection names, written with each output collection
+    std::vector<std::string>   _categoryNames {} ;
+    std::vector<std::string>   _selectionNames {} ;
+    /// The classification buffers, reused between events
+    reco::PFOClassification    _classification {} ;
+    /// The time of the last event, in us
+    double                     _lastTime {0.} ;
+    /// The statistics
+    std::size_t                _nEvents {0} ;
+    std::size_t                _nPFOs {0} ;
+    std::size_t                _selectionCounts[reco::pfo::NSelections] {} ;
+    double                     _totalTime {0.} ;
+  };
+
+  //--------------------------------------------------------------------------------
+  //--------------------------------------------------------------------------------
+
+  inline void PFOClassifierCore::init( const std::string &pfoCollectionName, const std::string &outputCollectionName ) {
+    _pfoCollectionName = pfoCollectionName ;
+    _outputCollectionName = outputCollectionName ;
+    // build the shared particle index before the event loop
+    pdg::PDGHelper::categories( 0 ) ;
+    _categoryNames.clear() ;
+    for( std::size_t bit=0 ; bit<pdg::category::NCategories ; ++bit ) {
+      _categoryNames.push_back( pdg::category::name( bit ) ) ;
+    }
+    _selectionNames.clear() ;
+    for( const auto &selection : reco::pfo::Selections ) {
+      _selectionNames.push_back( selection._name ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline bool PFOClassifierCore::processEvent( EVENT::LCEvent &event ) {
+    EVENT::LCCollection *pfos = nullptr ;
+    try {
+      pfos = event.getCollection( _pfoCollectionName ) ;
+    }
+    catch( const EVENT::DataNotAvailableException & ) {
+      return false ;
+    }
+    const auto start = std::chrono::steady_clock::now() ;
+    _classification.classify( pfos ) ;
+    auto categories = new EVENT::LCIntVec() ;
+    categories->assign( _classification.categories().begin(), _classification.categories().end() ) ;
+    auto selections = new EVENT::LCIntVec() ;
+    selections->assign( _classification.selections().begin(), _classification.selections().end() ) ;
+    const double elapsed = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count() ;
+
+    auto outputCollection = new IMPL::LCCollectionVec( EVENT::LCIO::LCINTVEC ) ;
+    outputCollection->addElement( categories ) ;
+    outputCollection->addElement( selections ) ;
+    outputCollection->parameters().setValues( "CategoryNames", _categoryNames ) ;
+    outputCollection->parameters().setValues( "SelectionNames", _selectionNames ) ;
+    outputCollection->parameters().setValue( "PFOCollection", _pfoCollectionName ) ;
+    event.addCollection( outputCollection, _outputCollectionName ) ;
+
+    _lastTime = elapsed ;
+    ++_nEvents ;
+    _nPFOs += _classification.size() ;
+    _totalTime += elapsed ;
+    for( std::size_t s=0 ; s<reco::pfo::NSelections ; ++s ) {
+      _selectionCounts[s] += _classification.count( 1u << s ) ;
+    }
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline std::string PFOClassifierCore::eventSummary() const {
+    std::stringstream ss ;
+    ss << "Classified " << _classification.size() << " PFOs in " << _lastTime << " us" ;
+    return ss.str() ;
+  }
+
+  //--------------------------------------------------------------------------------
+
+  inline std::vector<std::string> PFOClassifierCore::summary( const std::string &scope ) const {
+    if( 0 == _nEvents ) {
+      return { "No event processed" + scope } ;
+    }
+    std::vector<std::string> lines ;
+    std::stringstream ss ;
+    ss << "Classified " << _nPFOs << " PFOs in " << _nEvents << " events" << scope << ", "
+      << _totalTime / _nEvents << " us per event" ;
+    lines.push_back( ss.str() ) ;
+    for( std::size_t s=0 ; s<reco::pfo::NSelections ; ++s ) {
+      ss.str( "" ) ;
+      ss << "  " << reco::pfo::Selections[s]._name << ": " << _selectionCounts[s] ;
+      lines.push_back( ss.str() ) ;
+    }
+    return lines ;
+  }
+
+}
+
+#endif
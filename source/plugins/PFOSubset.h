@@ -0,0 +1,34 @@
+
+#ifndef _LCANALYSISTOOLS_PFOSUBSET_H
+#define _LCANALYSISTOOLS_PFOSUBSET_H
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCIO.h>
+#include <IMPL/LCCollectionVec.h>
+
+// -- std headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lc_analysis {
+
+  /// Create a subset collection of PFOs pointing to the elements of a
+  /// PFO collection at the given indices, in order. The name of the PFO
+  /// collection is stored in its PFOCollection parameter. Shared by the
+  /// Marlin and MarlinMT processors
+  inline IMPL::LCCollectionVec *pfoSubset( const EVENT::LCCollection *pfos, const std::vector<uint32_t> &indices,
+    const std::string &pfoCollectionName ) {
+    auto collection = new IMPL::LCCollectionVec( EVENT::LCIO::RECONSTRUCTEDPARTICLE ) ;
+    collection->setSubset( true ) ;
+    for( const auto index : indices ) {
+      collection->addElement( pfos->getElementAt( index ) ) ;
+    }
+    collection->parameters().setValue( "PFOCollection", pfoCollectionName ) ;
+    return collection ;
+  }
+
+}
+
+#endif
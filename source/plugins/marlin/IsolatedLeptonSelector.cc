@@ -0,0 +1,110 @@
+
+// -- marlin headers
+#include <marlin/Processor.h>
+
+// -- lcio headers
+#include <EVENT/LCIO.h>
+
+// -- LCAnalysisTools headers
+#include "IsolatedLeptonSelectorCore.h"
+
+// -- std headers
+#include <string>
+
+using namespace lc_analysis ;
+
+/**
+ *  @brief  IsolatedLeptonSelector class
+ *
+ *  Selects the isolated charged leptons of a PFO collection (see
+ *  reco::IsolatedLeptonFinder): the electrons and muons with an energy of
+ *  at least MinEnergy and with at most MaxConeEnergyFraction of their
+ *  energy in the cone of cosine CosConeAngle around them. The isolated
+ *  leptons are written in a subset collection pointing to the input PFOs,
+ *  in the input order.
+ */
+class IsolatedLeptonSelector : public marlin::Processor {
+public:
+  marlin::Processor *newProcessor() { return new IsolatedLeptonSelector() ; }
+
+  IsolatedLeptonSelector() ;
+  void init() ;
+  void processEvent( EVENT::LCEvent *event ) ;
+  void end() ;
+
+private:
+  // processor parameters
+  std::string                _pfoCollectionName {} ;
+  std::string                _outputCollectionName {} ;
+  double                     _cosConeAngle {0.98} ;
+  double                     _minEnergy {5.} ;
+  double                     _maxConeEnergyFraction {0.1} ;
+  // isolation buffers and statistics
+  IsolatedLeptonSelectorCore _core {} ;
+};
+
+//--------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------
+
+IsolatedLeptonSelector aIsolatedLeptonSelector ;
+
+//--------------------------------------------------------------------------------
+
+IsolatedLeptonSelector::IsolatedLeptonSelector() :
+  marlin::Processor("IsolatedLeptonSelector") {
+  _description = "Selects the isolated electrons and muons of a PFO collection from their cone energy and writes them in a subset collection" ;
+
+  registerInputCollection( EVENT::LCIO::RECONSTRUCTEDPARTICLE,
+    "PFOCollection",
+    "The PFO collection to search",
+    _pfoCollectionName,
+    std::string("PandoraPFOs") ) ;
+
+  registerOutputCollection( EVENT::LCIO::RECONSTRUCTEDPARTICLE,
+    "OutputCollection",
+    "The subset collection of the isolated leptons",
+    _outputCollectionName,
+    std::string("IsolatedLeptons") ) ;
+
+  registerProcessorParameter( "CosConeAngle",
+    "The cosine of the isolation cone half angle",
+    _cosConeAngle,
+    double(0.98) ) ;
+
+  registerProcessorParameter( "MinEnergy",
+    "The minimum lepton energy (GeV)",
+    _minEnergy,
+    double(5.) ) ;
+
+  registerProcessorParameter( "MaxConeEnergyFraction",
+    "The maximum energy in the cone, relative to the lepton energy",
+    _maxConeEnergyFraction,
+    double(0.1) ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void IsolatedLeptonSelector::init() {
+  printParameters() ;
+  _core.init( _pfoCollectionName, _outputCollectionName,
+    _cosConeAngle, _minEnergy, _maxConeEnergyFraction ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void IsolatedLeptonSelector::processEvent( EVENT::LCEvent *event ) {
+  if( not _core.processEvent( *event ) ) {
+    streamlog_out( DEBUG5 ) << "No collection " << _pfoCollectionName
+      << " in event " << event->getEventNumber() << ", run " << event->getRunNumber() << std::endl ;
+    return ;
+  }
+  streamlog_out( DEBUG5 ) << _core.eventSummary() << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+
+void IsolatedLeptonSelector::end() {
+  for( const auto &line : _core.summary( "" ) ) {
+    streamlog_out( MESSAGE ) << line << std::endl ;
+  }
+}
@@ -0,0 +1,109 @@
+
+// -- marlin headers
+#include <marlin/Processor.h>
+
+// -- lcio headers
+#include <EVENT/LCIO.h>
+
+// -- LCAnalysisTools headers
+#include "KtOverlayRemovalCore.h"
+
+// -- std headers
+#include <string>
+
+using namespace lc_analysis ;
+
+/**
+ *  @brief  KtOverlayRemoval class
+ *
+ *  Removes the gamma gamma -> hadrons overlay from a PFO collection with
+ *  the exclusive kt algorithm (see reco::OverlayRemoval): the PFOs are
+ *  clustered in NJets exclusive jets with the kt radius R, the PFOs merged
+ *  with the beam are removed. The kept and removed PFOs are written in two
+ *  subset collections pointing to the input PFOs, in the input order.
+ */
+class KtOverlayRemoval : public marlin::Processor {
+public:
+  marlin::Processor *newProcessor() { return new KtOverlayRemoval() ; }
+
+  KtOverlayRemoval() ;
+  void init() ;
+  void processEvent( EVENT::LCEvent *event ) ;
+  void end() ;
+
+private:
+  // processor parameters
+  std::string                _pfoCollectionName {} ;
+  std::string                _keptCollectionName {} ;
+  std::string                _removedCollectionName {} ;
+  double                     _R {1.} ;
+  int                        _nJets {4} ;
+  // clustering buffers and statistics
+  KtOverlayRemovalCore       _core {} ;
+};
+
+//--------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------
+
+KtOverlayRemoval aKtOverlayRemoval ;
+
+//--------------------------------------------------------------------------------
+
+KtOverlayRemoval::KtOverlayRemoval() :
+  marlin::Processor("KtOverlayRemoval") {
+  _description = "Removes the gamma gamma -> hadrons overlay PFOs with the exclusive kt algorithm and writes the kept and removed PFOs in subset collections" ;
+
+  registerInputCollection( EVENT::LCIO::RECONSTRUCTEDPARTICLE,
+    "PFOCollection",
+    "The PFO collection to clean",
+    _pfoCollectionName,
+    std::string("PandoraPFOs") ) ;
+
+  registerOutputCollection( EVENT::LCIO::RECONSTRUCTEDPARTICLE,
+    "KeptCollection",
+    "The subset collection of the PFOs clustered in the exclusive jets",
+    _keptCollectionName,
+    std::string("PFOsWithoutOverlay") ) ;
+
+  registerOutputCollection( EVENT::LCIO::RECONSTRUCTEDPARTICLE,
+    "RemovedCollection",
+    "The subset collection of the PFOs merged with the beam",
+    _removedCollectionName,
+    std::string("PFOsFromOverlay") ) ;
+
+  registerProcessorParameter( "R",
+    "The kt radius",
+    _R,
+    double(1.) ) ;
+
+  registerProcessorParameter( "NJets",
+    "The number of exclusive jets",
+    _nJets,
+    int(4) ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void KtOverlayRemoval::init() {
+  printParameters() ;
+  _core.init( _pfoCollectionName, _keptCollectionName, _removedCollectionName, _R, _nJets ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void KtOverlayRemoval::processEvent( EVENT::LCEvent *event ) {
+  if( not _core.processEvent( *event ) ) {
+    streamlog_out( DEBUG5 ) << "No collection " << _pfoCollectionName
+      << " in event " << event->getEventNumber() << ", run " << event->getRunNumber() << std::endl ;
+    return ;
+  }
+  streamlog_out( DEBUG5 ) << _core.eventSummary() << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+
+void KtOverlayRemoval::end() {
+  for( const auto &line : _core.summary( "" ) ) {
+    streamlog_out( MESSAGE ) << line << std::endl ;
+  }
+}
@@ -0,0 +1,94 @@
+
+// -- marlin headers
+#include <marlin/Processor.h>
+
+// -- lcio headers
+#include <EVENT/LCIO.h>
+
+// -- LCAnalysisTools headers
+#include "MCParticleClassifierCore.h"
+
+// -- std headers
+#include <string>
+
+using namespace lc_analysis ;
+
+/**
+ *  @brief  MCParticleClassifier class
+ *
+ *  Classifies all the particles of an MCParticle collection in
+ *  a single batch pass and publishes their category flags (see
+ *  the lc_analysis::pdg::category namespace) in an LCIntVec collection.
+ *  The output collection holds a single LCIntVec, aligned with the
+ *  MCParticle collection: element i holds the flags of particle i.
+ *  The flag names are written in the "CategoryNames" collection
+ *  parameter, in bit order. Particles not in the PDG table get no flag.
+ *  The per-event classification time is printed at DEBUG level and
+ *  summarized at the end of the job.
+ */
+class MCParticleClassifier : public marlin::Processor {
+public:
+  marlin::Processor *newProcessor() { return new MCParticleClassifier() ; }
+
+  MCParticleClassifier() ;
+  void init() ;
+  void processEvent( EVENT::LCEvent *event ) ;
+  void end() ;
+
+private:
+  // processor parameters
+  std::string                _mcParticleCollectionName {} ;
+  std::string                _outputCollectionName {} ;
+  // classification buffers and timing statistics
+  MCParticleClassifierCore   _core {} ;
+};
+
+//--------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------
+
+MCParticleClassifier aMCParticleClassifier ;
+
+//--------------------------------------------------------------------------------
+
+MCParticleClassifier::MCParticleClassifier() :
+  marlin::Processor("MCParticleClassifier") {
+  _description = "Classifies the particles of an MCParticle collection and publishes their category flags in an LCIntVec collection" ;
+
+  registerInputCollection( EVENT::LCIO::MCPARTICLE,
+    "MCParticleCollection",
+    "The MCParticle collection to classify",
+    _mcParticleCollectionName,
+    std::string("MCParticle") ) ;
+
+  registerOutputCollection( EVENT::LCIO::LCINTVEC,
+    "OutputCollection",
+    "The output collection of particle category flags, aligned with the MCParticle collection",
+    _outputCollectionName,
+    std::string("MCParticleCategories") ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void MCParticleClassifier::init() {
+  printParameters() ;
+  _core.init( _mcParticleCollectionName, _outputCollectionName ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void MCParticleClassifier::processEvent( EVENT::LCEvent *event ) {
+  if( not _core.processEvent( *event ) ) {
+    streamlog_out( DEBUG5 ) << "No collection " << _mcParticleCollectionName
+      << " in event " << event->getEventNumber() << ", run " << event->getRunNumber() << std::endl ;
+    return ;
+  }
+  streamlog_out( DEBUG5 ) << _core.eventSummary() << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+
+void MCParticleClassifier::end() {
+  for( const auto &line : _core.summary( "" ) ) {
+    streamlog_out( MESSAGE ) << line << std::endl ;
+  }
+}
@@ -0,0 +1,93 @@
+
+// -- marlin headers
+#include <marlin/Processor.h>
+
+// -- lcio headers
+#include <EVENT/LCIO.h>
+
+// -- LCAnalysisTools headers
+#include "PFOClassifierCore.h"
+
+// -- std headers
+#include <string>
+
+using namespace lc_analysis ;
+
+/**
+ *  @brief  PFOClassifier class
+ *
+ *  Classifies all the PFOs of a ReconstructedParticle collection from
+ *  their type code, in a single batch pass (see reco::PFOClassification).
+ *  The output LCIntVec collection holds two LCIntVecs, aligned with the
+ *  PFO collection: the category flags of each PFO (element 0) and the
+ *  mask of the standard selections it passes (element 1). The flag and
+ *  selection names are written in the "CategoryNames" and "SelectionNames"
+ *  collection parameters, in bit order, so that the next processors select
+ *  PFOs without reading their type again.
+ */
+class PFOClassifier : public marlin::Processor {
+public:
+  marlin::Processor *newProcessor() { return new PFOClassifier() ; }
+
+  PFOClassifier() ;
+  void init() ;
+  void processEvent( EVENT::LCEvent *event ) ;
+  void end() ;
+
+private:
+  // processor parameters
+  std::string                _pfoCollectionName {} ;
+  std::string                _outputCollectionName {} ;
+  // classification buffers and statistics
+  PFOClassifierCore          _core {} ;
+};
+
+//--------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------
+
+PFOClassifier aPFOClassifier ;
+
+//--------------------------------------------------------------------------------
+
+PFOClassifier::PFOClassifier() :
+  marlin::Processor("PFOClassifier") {
+  _description = "Classifies the PFOs of a ReconstructedParticle collection and publishes their category flags and selection masks in an LCIntVec collection" ;
+
+  registerInputCollection( EVENT::LCIO::RECONSTRUCTEDPARTICLE,
+    "PFOCollection",
+    "The PFO collection to classify",
+    _pfoCollectionName,
+    std::string("PandoraPFOs") ) ;
+
+  registerOutputCollection( EVENT::LCIO::LCINTVEC,
+    "OutputCollection",
+    "The output collection of PFO category flags and selection masks, aligned with the PFO collection",
+    _outputCollectionName,
+    std::string("PFOCategories") ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void PFOClassifier::init() {
+  printParameters() ;
+  _core.init( _pfoCollectionName, _outputCollectionName ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void PFOClassifier::processEvent( EVENT::LCEvent *event ) {
+  if( not _core.processEvent( *event ) ) {
+    streamlog_out( DEBUG5 ) << "No collection " << _pfoCollectionName
+      << " in event " << event->getEventNumber() << ", run " << event->getRunNumber() << std::endl ;
+    return ;
+  }
+  streamlog_out( DEBUG5 ) << _core.eventSummary() << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+
+void PFOClassifier::end() {
+  for( const auto &line : _core.summary( "" ) ) {
+    streamlog_out( MESSAGE ) << line << std::endl ;
+  }
+}
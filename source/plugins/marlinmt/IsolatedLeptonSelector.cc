@@ -0,0 +1,86 @@
+
+// -- marlinmt headers
+#include <marlinmt/Processor.h>
+#include <marlinmt/EventStore.h>
+#include <marlinmt/PluginManager.h>
+
+// -- lcio headers
+#include <EVENT/LCEvent.h>
+#include <EVENT/LCIO.h>
+
+// -- LCAnalysisTools headers
+#include "IsolatedLeptonSelectorCore.h"
+
+using namespace lc_analysis ;
+
+/**
+ *  @brief  IsolatedLeptonSelector class
+ *
+ *  MarlinMT version of the IsolatedLeptonSelector Marlin processor: selects
+ *  the isolated electrons and muons of a PFO collection from their cone
+ *  energy and writes them in a subset collection. Each clone builds its
+ *  own IsolatedLeptonFinder in init(), with its cone buffers.
+ */
+class IsolatedLeptonSelector : public marlinmt::Processor {
+public:
+  IsolatedLeptonSelector() ;
+  void init() override ;
+  void processEvent( marlinmt::EventStore *event ) override ;
+  void end() override ;
+
+private:
+  // processor parameters
+  marlinmt::InputCollectionParameter    _pfoCollectionName {*this, EVENT::LCIO::RECONSTRUCTEDPARTICLE, "PFOCollection",
+    "The PFO collection to search", "PandoraPFOs" } ;
+  marlinmt::OutputCollectionParameter   _outputCollectionName {*this, EVENT::LCIO::RECONSTRUCTEDPARTICLE, "OutputCollection",
+    "The subset collection of the isolated leptons", "IsolatedLeptons" } ;
+  marlinmt::ProcessorParameter<double>  _cosConeAngle {*this, "CosConeAngle",
+    "The cosine of the isolation cone half angle", 0.98 } ;
+  marlinmt::ProcessorParameter<double>  _minEnergy {*this, "MinEnergy",
+    "The minimum lepton energy (GeV)", 5. } ;
+  marlinmt::ProcessorParameter<double>  _maxConeEnergyFraction {*this, "MaxConeEnergyFraction",
+    "The maximum energy in the cone, relative to the lepton energy", 0.1 } ;
+  // per-thread isolation buffers and statistics
+  IsolatedLeptonSelectorCore            _core {} ;
+};
+
+//--------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------
+
+MARLINMT_DECLARE_PROCESSOR( IsolatedLeptonSelector )
+
+//--------------------------------------------------------------------------------
+
+IsolatedLeptonSelector::IsolatedLeptonSelector() :
+  marlinmt::Processor("IsolatedLeptonSelector") {
+  _description = "Selects the isolated electrons and muons of a PFO collection from their cone energy and writes them in a subset collection" ;
+  setRuntimeOption( Processor::RuntimeOption::Critical, false ) ;
+  setRuntimeOption( Processor::RuntimeOption::Clone, true ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void IsolatedLeptonSelector::init() {
+  _core.init( _pfoCollectionName.get(), _outputCollectionName.get(),
+    _cosConeAngle.get(), _minEnergy.get(), _maxConeEnergyFraction.get() ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void IsolatedLeptonSelector::processEvent( marlinmt::EventStore *event ) {
+  auto lcevent = event->event<EVENT::LCEvent>() ;
+  if( not _core.processEvent( *lcevent ) ) {
+    log<DEBUG5>() << "No collection " << _pfoCollectionName.get()
+      << " in event " << lcevent->getEventNumber() << ", run " << lcevent->getRunNumber() << std::endl ;
+    return ;
+  }
+  log<DEBUG5>() << _core.eventSummary() << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+
+void IsolatedLeptonSelector::end() {
+  for( const auto &line : _core.summary( " in this thread" ) ) {
+    log<MESSAGE>() << line << std::endl ;
+  }
+}
@@ -0,0 +1,86 @@
+
+// -- marlinmt headers
+#include <marlinmt/Processor.h>
+#include <marlinmt/EventStore.h>
+#include <marlinmt/PluginManager.h>
+
+// -- lcio headers
+#include <EVENT/LCEvent.h>
+#include <EVENT/LCIO.h>
+
+// -- LCAnalysisTools headers
+#include "KtOverlayRemovalCore.h"
+
+using namespace lc_analysis ;
+
+/**
+ *  @brief  KtOverlayRemoval class
+ *
+ *  MarlinMT version of the KtOverlayRemoval Marlin processor: removes the
+ *  gamma gamma -> hadrons overlay from a PFO collection with the exclusive
+ *  kt algorithm and writes the kept and removed PFOs in two subset
+ *  collections. Each clone builds its own OverlayRemoval in init(), with
+ *  its clustering buffers.
+ */
+class KtOverlayRemoval : public marlinmt::Processor {
+public:
+  KtOverlayRemoval() ;
+  void init() override ;
+  void processEvent( marlinmt::EventStore *event ) override ;
+  void end() override ;
+
+private:
+  // processor parameters
+  marlinmt::InputCollectionParameter    _pfoCollectionName {*this, EVENT::LCIO::RECONSTRUCTEDPARTICLE, "PFOCollection",
+    "The PFO collection to clean", "PandoraPFOs" } ;
+  marlinmt::OutputCollectionParameter   _keptCollectionName {*this, EVENT::LCIO::RECONSTRUCTEDPARTICLE, "KeptCollection",
+    "The subset collection of the PFOs clustered in the exclusive jets", "PFOsWithoutOverlay" } ;
+  marlinmt::OutputCollectionParameter   _removedCollectionName {*this, EVENT::LCIO::RECONSTRUCTEDPARTICLE, "RemovedCollection",
+    "The subset collection of the PFOs merged with the beam", "PFOsFromOverlay" } ;
+  marlinmt::ProcessorParameter<double>  _R {*this, "R",
+    "The kt radius", 1. } ;
+  marlinmt::ProcessorParameter<int>     _nJets {*this, "NJets",
+    "The number of exclusive jets", 4 } ;
+  // per-thread clustering buffers and statistics
+  KtOverlayRemovalCore                  _core {} ;
+};
+
+//--------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------
+
+MARLINMT_DECLARE_PROCESSOR( KtOverlayRemoval )
+
+//--------------------------------------------------------------------------------
+
+KtOverlayRemoval::KtOverlayRemoval() :
+  marlinmt::Processor("KtOverlayRemoval") {
+  _description = "Removes the gamma gamma -> hadrons overlay PFOs with the exclusive kt algorithm and writes the kept and removed PFOs in subset collections" ;
+  setRuntimeOption( Processor::RuntimeOption::Critical, false ) ;
+  setRuntimeOption( Processor::RuntimeOption::Clone, true ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void KtOverlayRemoval::init() {
+  _core.init( _pfoCollectionName.get(), _keptCollectionName.get(), _removedCollectionName.get(), _R.get(), _nJets.get() ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void KtOverlayRemoval::processEvent( marlinmt::EventStore *event ) {
+  auto lcevent = event->event<EVENT::LCEvent>() ;
+  if( not _core.processEvent( *lcevent ) ) {
+    log<DEBUG5>() << "No collection " << _pfoCollectionName.get()
+      << " in event " << lcevent->getEventNumber() << ", run " << lcevent->getRunNumber() << std::endl ;
+    return ;
+  }
+  log<DEBUG5>() << _core.eventSummary() << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+
+void KtOverlayRemoval::end() {
+  for( const auto &line : _core.summary( " in this thread" ) ) {
+    log<MESSAGE>() << line << std::endl ;
+  }
+}
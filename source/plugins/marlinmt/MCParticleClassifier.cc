@@ -0,0 +1,80 @@
+
+// -- marlinmt headers
+#include <marlinmt/Processor.h>
+#include <marlinmt/EventStore.h>
+#include <marlinmt/PluginManager.h>
+
+// -- lcio headers
+#include <EVENT/LCEvent.h>
+#include <EVENT/LCIO.h>
+
+// -- LCAnalysisTools headers
+#include "MCParticleClassifierCore.h"
+
+using namespace lc_analysis ;
+
+/**
+ *  @brief  MCParticleClassifier class
+ *
+ *  MarlinMT version of the MCParticleClassifier Marlin processor:
+ *  classifies all the particles of an MCParticle collection in a single
+ *  batch pass and publishes their category flags in an LCIntVec collection,
+ *  aligned with the MCParticle collection. The clones share the PDGIndex,
+ *  built once before the event loop in init().
+ */
+class MCParticleClassifier : public marlinmt::Processor {
+public:
+  MCParticleClassifier() ;
+  void init() override ;
+  void processEvent( marlinmt::EventStore *event ) override ;
+  void end() override ;
+
+private:
+  // processor parameters
+  marlinmt::InputCollectionParameter    _mcParticleCollectionName {*this, EVENT::LCIO::MCPARTICLE, "MCParticleCollection",
+    "The MCParticle collection to classify", "MCParticle" } ;
+  marlinmt::OutputCollectionParameter   _outputCollectionName {*this, EVENT::LCIO::LCINTVEC, "OutputCollection",
+    "The output collection of particle category flags, aligned with the MCParticle collection", "MCParticleCategories" } ;
+  // per-thread classification buffers and timing statistics
+  MCParticleClassifierCore              _core {} ;
+};
+
+//--------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------
+
+MARLINMT_DECLARE_PROCESSOR( MCParticleClassifier )
+
+//--------------------------------------------------------------------------------
+
+MCParticleClassifier::MCParticleClassifier() :
+  marlinmt::Processor("MCParticleClassifier") {
+  _description = "Classifies the particles of an MCParticle collection and publishes their category flags in an LCIntVec collection" ;
+  setRuntimeOption( Processor::RuntimeOption::Critical, false ) ;
+  setRuntimeOption( Processor::RuntimeOption::Clone, true ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void MCParticleClassifier::init() {
+  _core.init( _mcParticleCollectionName.get(), _outputCollectionName.get() ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void MCParticleClassifier::processEvent( marlinmt::EventStore *event ) {
+  auto lcevent = event->event<EVENT::LCEvent>() ;
+  if( not _core.processEvent( *lcevent ) ) {
+    log<DEBUG5>() << "No collection " << _mcParticleCollectionName.get()
+      << " in event " << lcevent->getEventNumber() << ", run " << lcevent->getRunNumber() << std::endl ;
+    return ;
+  }
+  log<DEBUG5>() << _core.eventSummary() << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+
+void MCParticleClassifier::end() {
+  for( const auto &line : _core.summary( " in this thread" ) ) {
+    log<MESSAGE>() << line << std::endl ;
+  }
+}
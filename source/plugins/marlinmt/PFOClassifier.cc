@@ -0,0 +1,79 @@
+
+// -- marlinmt headers
+#include <marlinmt/Processor.h>
+#include <marlinmt/EventStore.h>
+#include <marlinmt/PluginManager.h>
+
+// -- lcio headers
+#include <EVENT/LCEvent.h>
+#include <EVENT/LCIO.h>
+
+// -- LCAnalysisTools headers
+#include "PFOClassifierCore.h"
+
+using namespace lc_analysis ;
+
+/**
+ *  @brief  PFOClassifier class
+ *
+ *  MarlinMT version of the PFOClassifier Marlin processor: classifies
+ *  the PFOs of a ReconstructedParticle collection from their type code
+ *  and publishes their category flags and selection masks in an LCIntVec
+ *  collection, aligned with the PFO collection.
+ */
+class PFOClassifier : public marlinmt::Processor {
+public:
+  PFOClassifier() ;
+  void init() override ;
+  void processEvent( marlinmt::EventStore *event ) override ;
+  void end() override ;
+
+private:
+  // processor parameters
+  marlinmt::InputCollectionParameter    _pfoCollectionName {*this, EVENT::LCIO::RECONSTRUCTEDPARTICLE, "PFOCollection",
+    "The PFO collection to classify", "PandoraPFOs" } ;
+  marlinmt::OutputCollectionParameter   _outputCollectionName {*this, EVENT::LCIO::LCINTVEC, "OutputCollection",
+    "The output collection of PFO category flags and selection masks, aligned with the PFO collection", "PFOCategories" } ;
+  // per-thread classification buffers and statistics
+  PFOClassifierCore                     _core {} ;
+};
+
+//--------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------
+
+MARLINMT_DECLARE_PROCESSOR( PFOClassifier )
+
+//--------------------------------------------------------------------------------
+
+PFOClassifier::PFOClassifier() :
+  marlinmt::Processor("PFOClassifier") {
+  _description = "Classifies the PFOs of a ReconstructedParticle collection and publishes their category flags and selection masks in an LCIntVec collection" ;
+  setRuntimeOption( Processor::RuntimeOption::Critical, false ) ;
+  setRuntimeOption( Processor::RuntimeOption::Clone, true ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void PFOClassifier::init() {
+  _core.init( _pfoCollectionName.get(), _outputCollectionName.get() ) ;
+}
+
+//--------------------------------------------------------------------------------
+
+void PFOClassifier::processEvent( marlinmt::EventStore *event ) {
+  auto lcevent = event->event<EVENT::LCEvent>() ;
+  if( not _core.processEvent( *lcevent ) ) {
+    log<DEBUG5>() << "No collection " << _pfoCollectionName.get()
+      << " in event " << lcevent->getEventNumber() << ", run " << lcevent->getRunNumber() << std::endl ;
+    return ;
+  }
+  log<DEBUG5>() << _core.eventSummary() << std::endl ;
+}
+
+//--------------------------------------------------------------------------------
+
+void PFOClassifier::end() {
+  for( const auto &line : _core.summary( " in this thread" ) ) {
+    log<MESSAGE>() << line << std::endl ;
+  }
+}
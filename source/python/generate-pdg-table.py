@@ -9,7 +9,8 @@ except ImportError:
 
 def particleToStr( part ):
     """ Dumps a particle into a C++ ParticleData object understandable format
-        Returns its string representation
+        Returns its string representation.
+        The charge is not written, it is computed from the pdg id on the C++ side
     """
     digit_str = str(abs(int(part.pdgid)))
     conc = ", " if len(digit_str) != 10 else ""
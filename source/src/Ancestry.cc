@@ -0,0 +1,60 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Ancestry.h>
+
+// -- std headers
+#include <limits>
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    void Ancestry::build( const DecayTree &tree, const AncestorSelector &selector ) {
+      tree.topologicalOrder( _order ) ;
+      build( tree, selector, _order ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void Ancestry::build( const DecayTree &tree, const AncestorSelector &selector, const std::vector<NodeIndex> &order ) {
+      constexpr uint16_t maxGenerations = std::numeric_limits<uint16_t>::max() ;
+      const auto nnodes = tree.size() ;
+      _nearest.assign( nnodes, NoNode ) ;
+      _generations.assign( nnodes, 0 ) ;
+      const auto &categories = tree.categoryArray() ;
+      const auto &flags = tree.flagArray() ;
+      for( const auto n : order ) {
+        NodeIndex nearest = NoNode ;
+        uint16_t generations = maxGenerations ;
+        for( const auto parent : tree.parents( n ) ) {
+          if( selector.matches( categories[parent], flags[parent] ) ) {
+            nearest = parent ;
+            generations = 1 ;
+            break ;
+          }
+          if( NoNode != _nearest[parent] && _generations[parent] + 1 < generations ) {
+            nearest = _nearest[parent] ;
+            generations = ( _generations[parent] < maxGenerations-1 ) ? _generations[parent] + 1 : maxGenerations-1 ;
+          }
+        }
+        _nearest[n] = nearest ;
+        _generations[n] = ( NoNode == nearest ) ? 0 : generations ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    constexpr AncestorSelector HeavyFlavourAncestry::BHadron ;
+    constexpr AncestorSelector HeavyFlavourAncestry::CHadron ;
+
+    //----------------------------------------------------------------------------
+
+    void HeavyFlavourAncestry::build( const DecayTree &tree ) {
+      tree.topologicalOrder( _order ) ;
+      _bAncestry.build( tree, BHadron, _order ) ;
+      _cAncestry.build( tree, CHadron, _order ) ;
+    }
+
+  }
+
+}
@@ -0,0 +1,197 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Candidates.h>
+
+// -- std headers
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    void CandidateArena::clear() {
+      _nDaughters = 0 ;
+      _daughters.clear() ;
+      _momenta.clear() ;
+      _masses.clear() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    CandidateBuilder::CandidateBuilder( double minMass, double maxMass ) {
+      setMassWindow( minMass, maxMass ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void CandidateBuilder::setMassWindow( double minMass, double maxMass ) {
+      if( minMass > maxMass ) {
+        std::stringstream ss ; ss << "CandidateBuilder: invalid mass window [" << minMass << ", " << maxMass << "]" << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      _minMass = minMass ;
+      _maxMass = maxMass ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t CandidateBuilder::build( const kinematics::FourMomentumArray &particles, const std::vector<DaughterList> &lists,
+      CandidateArena &candidates ) {
+      if( lists.size() < 2 ) {
+        std::stringstream ss ; ss << "CandidateBuilder::build: at least two daughter lists are needed, got " << lists.size() << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      candidates.clear() ;
+      candidates._nDaughters = lists.size() ;
+      _nlists = lists.size() ;
+      if( _lists.size() < _nlists ) {
+        _lists.resize( _nlists ) ;
+      }
+      for( std::size_t l=0 ; l<_nlists ; ++l ) {
+        if( nullptr == lists[l]._indices ) {
+          throw std::runtime_error( "CandidateBuilder::build: null daughter list" ) ;
+        }
+        if( lists[l]._indices->empty() ) {
+          return 0 ;
+        }
+        sortList( particles, lists[l], _lists[l] ) ;
+        _lists[l]._sameAs = l ;
+        for( std::size_t previous=0 ; previous<l ; ++previous ) {
+          if( lists[previous]._indices == lists[l]._indices && lists[previous]._massHypothesis == lists[l]._massHypothesis ) {
+            _lists[l]._sameAs = previous ;
+          }
+        }
+      }
+      _remainingMinMass.assign( _nlists, 0. ) ;
+      _remainingMaxEnergy.assign( _nlists, 0. ) ;
+      for( std::size_t l=_nlists-1 ; l>0 ; --l ) {
+        _remainingMinMass[l-1] = _remainingMinMass[l] + std::sqrt( std::max( _lists[l]._minMass2, 0. ) ) ;
+        _remainingMaxEnergy[l-1] = _remainingMaxEnergy[l] + _lists[l]._maxEnergy ;
+      }
+      _current.assign( _nlists, 0 ) ;
+      combine( 0, kinematics::FourMomentum{}, candidates ) ;
+      return candidates.size() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void CandidateBuilder::sortList( const kinematics::FourMomentumArray &particles, const DaughterList &list, SortedList &sorted ) {
+      const auto &indices = *list._indices ;
+      const auto n = indices.size() ;
+      _unsorted.clear() ;
+      for( const auto index : indices ) {
+        if( index >= particles.size() ) {
+          std::stringstream ss ; ss << "CandidateBuilder::build: particle index " << index << " out of range (" << particles.size() << " particles)" << std::endl ;
+          throw std::runtime_error( ss.str() ) ;
+        }
+        _unsorted.push_back( particles.get( index ) ) ;
+      }
+      if( 0 != list._massHypothesis ) {
+        _unsorted.setMassHypothesis( list._massHypothesis ) ;
+      }
+      const double *e = _unsorted.e() ;
+      _order.resize( n ) ;
+      std::iota( _order.begin(), _order.end(), 0 ) ;
+      std::sort( _order.begin(), _order.end(), [e]( uint32_t lhs, uint32_t rhs ) {
+        return e[lhs] < e[rhs] ;
+      }) ;
+      sorted._momenta.clear() ;
+      sorted._indices.resize( n ) ;
+      sorted._minMass2 = std::numeric_limits<double>::max() ;
+      sorted._maxMass2 = std::numeric_limits<double>::lowest() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const auto momentum = _unsorted.get( _order[i] ) ;
+        sorted._momenta.push_back( momentum ) ;
+        sorted._indices[i] = indices[ _order[i] ] ;
+        sorted._minMass2 = std::min( sorted._minMass2, momentum.m2() ) ;
+        sorted._maxMass2 = std::max( sorted._maxMass2, momentum.m2() ) ;
+      }
+      sorted._maxEnergy = e[ _order.back() ] ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void CandidateBuilder::combine( std::size_t level, const kinematics::FourMomentum &partial, CandidateArena &candidates ) {
+      if( level+1 == _nlists ) {
+        combineLast( partial, candidates ) ;
+        return ;
+      }
+      const auto &list = _lists[level] ;
+      for( std::size_t i=0 ; i<list._indices.size() ; ++i ) {
+        const auto index = list._indices[i] ;
+        if( not accepts( level, index ) ) {
+          continue ;
+        }
+        const auto next = partial + list._momenta.get( i ) ;
+        // the daughters still to add raise the mass by at least their masses,
+        // and the energy by at most their highest energies
+        if( next.mass() + _remainingMinMass[level] > _maxMass ) {
+          continue ;
+        }
+        if( next._e + _remainingMaxEnergy[level] < _minMass ) {
+          continue ;
+        }
+        _current[level] = index ;
+        combine( level+1, next, candidates ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void CandidateBuilder::combineLast( const kinematics::FourMomentum &partial, CandidateArena &candidates ) {
+      const auto level = _nlists-1 ;
+      const auto &list = _lists[level] ;
+      const auto n = list._indices.size() ;
+      const double minMass2 = _minMass > 0. ? _minMass*_minMass : std::numeric_limits<double>::lowest() ;
+      const double maxMass2 = _maxMass*_maxMass ;
+      // energy range of the last daughter from the mass bounds
+      const double partialMass2 = partial.m2() ;
+      const double partialP = partial.p() ;
+      const double partialE = partial._e ;
+      double minEnergy = std::numeric_limits<double>::lowest() ;
+      double maxEnergy = std::numeric_limits<double>::max() ;
+      if( partialE > 0. ) {
+        minEnergy = ( minMass2 - partialMass2 - list._maxMass2 ) / ( 4. * partialE ) ;
+      }
+      if( partialE > partialP ) {
+        maxEnergy = ( maxMass2 - partialMass2 - list._minMass2 ) / ( 2. * ( partialE - partialP ) ) ;
+      }
+      const double *px = list._momenta.px(), *py = list._momenta.py(), *pz = list._momenta.pz(), *e = list._momenta.e() ;
+      const auto first = static_cast<std::size_t>( std::lower_bound( e, e+n, minEnergy ) - e ) ;
+      const auto last = static_cast<std::size_t>( std::upper_bound( e+first, e+n, maxEnergy ) - e ) ;
+      if( first >= last ) {
+        return ;
+      }
+      // mass kernel over the range
+      _mass2.resize( last - first ) ;
+      double *mass2 = _mass2.data() ;
+      for( std::size_t i=first ; i<last ; ++i ) {
+        const double sx = partial._px + px[i] ;
+        const double sy = partial._py + py[i] ;
+        const double sz = partial._pz + pz[i] ;
+        const double se = partialE + e[i] ;
+        mass2[i-first] = se*se - sx*sx - sy*sy - sz*sz ;
+      }
+      for( std::size_t i=first ; i<last ; ++i ) {
+        const double m2 = mass2[i-first] ;
+        if( m2 < minMass2 || m2 > maxMass2 ) {
+          continue ;
+        }
+        const auto index = list._indices[i] ;
+        if( not accepts( level, index ) ) {
+          continue ;
+        }
+        candidates._daughters.insert( candidates._daughters.end(), _current.begin(), _current.begin() + level ) ;
+        candidates._daughters.push_back( index ) ;
+        candidates._momenta.push_back( partial._px + px[i], partial._py + py[i], partial._pz + pz[i], partialE + e[i] ) ;
+        candidates._masses.push_back( kinematics::signedSqrt( m2 ) ) ;
+      }
+    }
+
+  }
+
+}
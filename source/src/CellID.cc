@@ -0,0 +1,215 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/CellID.h>
+
+// -- lcio headers
+#include <EVENT/CalorimeterHit.h>
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCIO.h>
+#include <EVENT/LCParameters.h>
+#include <EVENT/SimCalorimeterHit.h>
+#include <EVENT/SimTrackerHit.h>
+#include <EVENT/TrackerHit.h>
+
+// -- std headers
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+namespace lc_analysis {
+
+  namespace hits {
+
+    namespace {
+      /// Split a string on a delimiter, removing the spaces of the tokens
+      void split( const std::string &str, char delimiter, std::vector<std::string> &tokens ) {
+        tokens.clear() ;
+        tokens.emplace_back() ;
+        for( const char c : str ) {
+          if( delimiter == c ) {
+            tokens.emplace_back() ;
+          }
+          else if( ' ' != c ) {
+            tokens.back().push_back( c ) ;
+          }
+        }
+      }
+
+      /// Parse an integer of an encoding field. Throws if not a number
+      long parseInteger( const std::string &token, const std::string &field ) {
+        char *end = nullptr ;
+        const long value = std::strtol( token.c_str(), &end, 10 ) ;
+        if( token.empty() || '\0' != *end ) {
+          std::stringstream ss ; ss << "CellIDDecoder: invalid number '" << token << "' in field '" << field << "'" << std::endl ;
+          throw std::runtime_error( ss.str() ) ;
+        }
+        return value ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    CellIDDecoder::CellIDDecoder( const std::string &encoding ) {
+      setEncoding( encoding ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void CellIDDecoder::setEncoding( const std::string &encoding ) {
+      if( encoding == _encoding && not _fields.empty() ) {
+        return ;
+      }
+      std::vector<CellIDField> fields ;
+      std::vector<std::string> descriptions, tokens ;
+      split( encoding, ',', descriptions ) ;
+      uint64_t usedBits = 0 ;
+      long offset = 0 ;
+      for( const auto &description : descriptions ) {
+        split( description, ':', tokens ) ;
+        if( ( 2 != tokens.size() && 3 != tokens.size() ) || tokens[0].empty() ) {
+          std::stringstream ss ; ss << "CellIDDecoder: invalid field '" << description << "' in encoding '" << encoding << "'" << std::endl ;
+          throw std::runtime_error( ss.str() ) ;
+        }
+        if( 3 == tokens.size() ) {
+          offset = parseInteger( tokens[1], description ) ;
+        }
+        const long width = parseInteger( tokens.back(), description ) ;
+        const long absWidth = std::labs( width ) ;
+        if( 0 == width || offset < 0 || offset + absWidth > 64 ) {
+          std::stringstream ss ; ss << "CellIDDecoder: invalid offset or width in field '" << description << "' of encoding '" << encoding << "'" << std::endl ;
+          throw std::runtime_error( ss.str() ) ;
+        }
+        CellIDField field ;
+        field._name = tokens[0] ;
+        field._offset = static_cast<uint32_t>( offset ) ;
+        field._width = static_cast<uint32_t>( absWidth ) ;
+        field._signed = ( width < 0 ) ;
+        const uint64_t mask = ( 64 == field._width ) ? ~uint64_t(0) : ( ( uint64_t(1) << field._width ) - 1 ) ;
+        if( 0 != ( usedBits & ( mask << field._offset ) ) ) {
+          std::stringstream ss ; ss << "CellIDDecoder: field '" << description << "' overlaps another field in encoding '" << encoding << "'" << std::endl ;
+          throw std::runtime_error( ss.str() ) ;
+        }
+        for( const auto &other : fields ) {
+          if( other._name == field._name ) {
+            std::stringstream ss ; ss << "CellIDDecoder: duplicated field '" << field._name << "' in encoding '" << encoding << "'" << std::endl ;
+            throw std::runtime_error( ss.str() ) ;
+          }
+        }
+        usedBits |= mask << field._offset ;
+        offset += absWidth ;
+        fields.push_back( field ) ;
+      }
+      // all checks passed: replace the tables
+      _encoding = encoding ;
+      _fields = std::move( fields ) ;
+      _masks.resize( _fields.size() ) ;
+      _signBits.resize( _fields.size() ) ;
+      for( std::size_t f=0 ; f<_fields.size() ; ++f ) {
+        const auto width = _fields[f]._width ;
+        _masks[f] = ( 64 == width ) ? ~uint64_t(0) : ( ( uint64_t(1) << width ) - 1 ) ;
+        _signBits[f] = _fields[f]._signed ? ( uint64_t(1) << ( width - 1 ) ) : 0 ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void CellIDDecoder::setEncoding( const EVENT::LCCollection *hits ) {
+      const auto &encoding = hits->getParameters().getStringVal( EVENT::LCIO::CellIDEncoding ) ;
+      if( encoding.empty() ) {
+        std::stringstream ss ; ss << "CellIDDecoder: no " << EVENT::LCIO::CellIDEncoding << " parameter in the " << hits->getTypeName() << " collection" << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      setEncoding( encoding ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t CellIDDecoder::index( const std::string &name ) const {
+      for( std::size_t f=0 ; f<_fields.size() ; ++f ) {
+        if( _fields[f]._name == name ) {
+          return f ;
+        }
+      }
+      std::stringstream ss ; ss << "CellIDDecoder: no field '" << name << "' in encoding '" << _encoding << "'" << std::endl ;
+      throw std::runtime_error( ss.str() ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void CellIDDecoder::decode( const uint64_t *cellIDs, std::size_t n, std::size_t field, int64_t *values ) const {
+      const uint64_t offset = _fields[field]._offset, mask = _masks[field], signBit = _signBits[field] ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        values[i] = static_cast<int64_t>( ( ( ( cellIDs[i] >> offset ) & mask ) ^ signBit ) - signBit ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t CellIDDecoder::nBins( std::size_t field ) const {
+      const auto width = _fields[field]._width ;
+      if( width > MaxHistogramWidth ) {
+        std::stringstream ss ; ss << "CellIDDecoder: field '" << _fields[field]._name << "' too wide for a histogram (" << width << " bits)" << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      return std::size_t(1) << width ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void CellIDDecoder::histogram( const uint64_t *cellIDs, const double *energies, std::size_t n, std::size_t field, double *bins ) const {
+      // throws for fields too wide for a histogram
+      nBins( field ) ;
+      // the bin is the value minus the smallest value: the bits with the sign bit flipped
+      const uint64_t offset = _fields[field]._offset, mask = _masks[field], signBit = _signBits[field] ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        bins[ ( ( cellIDs[i] >> offset ) & mask ) ^ signBit ] += energies[i] ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    template <typename T, float (T::*Energy)() const>
+    void HitArray::fillElements( const EVENT::LCCollection *hits ) {
+      const auto n = static_cast<std::size_t>( hits->getNumberOfElements() ) ;
+      _cellIDs.resize( n ) ;
+      _energies.resize( n ) ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const auto hit = static_cast<const T*>( hits->getElementAt( i ) ) ;
+        _cellIDs[i] = cellID( hit->getCellID0(), hit->getCellID1() ) ;
+        _energies[i] = (hit->*Energy)() ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void HitArray::fill( const EVENT::LCCollection *hits ) {
+      const auto &type = hits->getTypeName() ;
+      if( EVENT::LCIO::CALORIMETERHIT == type ) {
+        fillElements<EVENT::CalorimeterHit, &EVENT::CalorimeterHit::getEnergy>( hits ) ;
+      }
+      else if( EVENT::LCIO::SIMCALORIMETERHIT == type ) {
+        fillElements<EVENT::SimCalorimeterHit, &EVENT::SimCalorimeterHit::getEnergy>( hits ) ;
+      }
+      else if( EVENT::LCIO::TRACKERHIT == type ) {
+        fillElements<EVENT::TrackerHit, &EVENT::TrackerHit::getEDep>( hits ) ;
+      }
+      else if( EVENT::LCIO::SIMTRACKERHIT == type ) {
+        fillElements<EVENT::SimTrackerHit, &EVENT::SimTrackerHit::getEDep>( hits ) ;
+      }
+      else {
+        std::stringstream ss ; ss << "HitArray::fill: unsupported collection type " << type << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void HitArray::clear() {
+      _cellIDs.clear() ;
+      _energies.clear() ;
+    }
+
+  }
+
+}
@@ -0,0 +1,116 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/CommonAncestor.h>
+
+// -- std headers
+#include <algorithm>
+#include <limits>
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    void CommonAncestorIndex::build( const DecayTree &tree ) {
+      const auto nnodes = tree.size() ;
+      _tree = &tree ;
+      _depths.assign( nnodes, std::numeric_limits<uint32_t>::max() ) ;
+      _roots.assign( nnodes, NoNode ) ;
+      _firstVisits.assign( nnodes, 0 ) ;
+      // children in the first parent forest: count, prefix sum, fill
+      _childOffsets.assign( nnodes+1, 0 ) ;
+      for( NodeIndex n=0 ; n<nnodes ; ++n ) {
+        const auto parent = tree.firstParent( n ) ;
+        if( NoNode != parent ) {
+          ++_childOffsets[ parent+1 ] ;
+        }
+      }
+      for( std::size_t n=0 ; n<nnodes ; ++n ) {
+        _childOffsets[n+1] += _childOffsets[n] ;
+      }
+      _children.resize( _childOffsets[nnodes] ) ;
+      // the offsets are used as fill cursors, then shifted back
+      for( NodeIndex n=0 ; n<nnodes ; ++n ) {
+        const auto parent = tree.firstParent( n ) ;
+        if( NoNode != parent ) {
+          _children[ _childOffsets[parent]++ ] = n ;
+        }
+      }
+      for( std::size_t n=nnodes ; n>0 ; --n ) {
+        _childOffsets[n] = _childOffsets[n-1] ;
+      }
+      if( nnodes > 0 ) {
+        _childOffsets[0] = 0 ;
+      }
+      // Euler tour of each tree, iterative DFS. Level 0 of the sparse table
+      // is the tour itself
+      _table.clear() ;
+      _table.reserve( 2 * nnodes ) ;
+      for( const auto root : tree.roots() ) {
+        _depths[root] = 0 ;
+        _roots[root] = root ;
+        _firstVisits[root] = static_cast<uint32_t>( _table.size() ) ;
+        _table.push_back( entry( 0, root ) ) ;
+        _stack.clear() ;
+        _stack.emplace_back( root, _childOffsets[root] ) ;
+        while( not _stack.empty() ) {
+          const auto current = _stack.back().first ;
+          const auto next = _stack.back().second ;
+          if( next < _childOffsets[current+1] ) {
+            const auto child = _children[next] ;
+            ++_stack.back().second ;
+            _depths[child] = _depths[current] + 1 ;
+            _roots[child] = root ;
+            _firstVisits[child] = static_cast<uint32_t>( _table.size() ) ;
+            _table.push_back( entry( _depths[child], child ) ) ;
+            _stack.emplace_back( child, _childOffsets[child] ) ;
+          }
+          else {
+            _stack.pop_back() ;
+            if( not _stack.empty() ) {
+              const auto parent = _stack.back().first ;
+              _table.push_back( entry( _depths[parent], parent ) ) ;
+            }
+          }
+        }
+      }
+      // sparse table levels
+      const std::size_t ntour = _table.size() ;
+      _log2.assign( ntour+1, 0 ) ;
+      for( std::size_t i=2 ; i<=ntour ; ++i ) {
+        _log2[i] = _log2[i/2] + 1 ;
+      }
+      const std::size_t nlevels = ( ntour > 0 ) ? _log2[ntour] + 1 : 0 ;
+      _levelOffsets.assign( nlevels, 0 ) ;
+      std::size_t total = ntour ;
+      for( std::size_t level=1 ; level<nlevels ; ++level ) {
+        _levelOffsets[level] = total ;
+        total += ntour - ( std::size_t(1) << level ) + 1 ;
+      }
+      _table.resize( total ) ;
+      for( std::size_t level=1 ; level<nlevels ; ++level ) {
+        const uint64_t *previous = _table.data() + _levelOffsets[level-1] ;
+        uint64_t *current = _table.data() + _levelOffsets[level] ;
+        const std::size_t half = std::size_t(1) << ( level-1 ) ;
+        const std::size_t nentries = ntour - ( std::size_t(1) << level ) + 1 ;
+        for( std::size_t i=0 ; i<nentries ; ++i ) {
+          current[i] = std::min( previous[i], previous[i+half] ) ;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t CommonAncestorIndex::memoryBytes() const {
+      return _depths.capacity() * sizeof(uint32_t)
+        + _roots.capacity() * sizeof(NodeIndex)
+        + _firstVisits.capacity() * sizeof(uint32_t)
+        + _table.capacity() * sizeof(uint64_t)
+        + _levelOffsets.capacity() * sizeof(std::size_t)
+        + _log2.capacity() * sizeof(uint8_t)
+        + ( _childOffsets.capacity() + _children.capacity() ) * sizeof(NodeIndex)
+        + _stack.capacity() * sizeof(std::pair<NodeIndex, NodeIndex>) ;
+    }
+
+  }
+
+}
@@ -0,0 +1,317 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/DecayCensus.h>
+
+// -- std headers
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    namespace {
+
+      /**
+       *  @brief  StreamFormatGuard class
+       *
+       *  Restores the format flags and precision of a stream on destruction
+       */
+      class StreamFormatGuard {
+      public:
+        StreamFormatGuard( std::ostream &stream ) :
+          _stream(stream),
+          _flags(stream.flags()),
+          _precision(stream.precision()) {
+        }
+
+        ~StreamFormatGuard() {
+          _stream.flags( _flags ) ;
+          _stream.precision( _precision ) ;
+        }
+
+        StreamFormatGuard( const StreamFormatGuard & ) = delete ;
+        StreamFormatGuard &operator=( const StreamFormatGuard & ) = delete ;
+
+      private:
+        std::ostream              &_stream ;
+        std::ios_base::fmtflags    _flags ;
+        std::streamsize            _precision ;
+      };
+
+      /// Get the charge conjugate of a pdg id, itself if self-conjugate
+      int conjugate( int pdg ) {
+        return ( pdg::PDGIndex::NoRow != pdg::PDGIndex::instance().row( -pdg ) ) ? -pdg : pdg ;
+      }
+
+      /// Get the name of a pdg id, the id itself if not in the table
+      std::string pdgName( int pdg ) {
+        const auto particle = pdg::PDGIndex::instance().find( pdg ) ;
+        return ( nullptr != particle ) ? particle->name() : std::to_string( pdg ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    bool DecayModeTable::canonicalize( int &parent, std::vector<int> &daughters ) {
+      std::sort( daughters.begin(), daughters.end() ) ;
+      const int ccParent = conjugate( parent ) ;
+      if( ccParent != parent && parent > 0 ) {
+        return false ;
+      }
+      // the conjugate is needed: anti-particle parent or self-conjugate parent
+      thread_local std::vector<int> ccDaughters ;
+      ccDaughters.resize( daughters.size() ) ;
+      std::transform( daughters.begin(), daughters.end(), ccDaughters.begin(), conjugate ) ;
+      std::sort( ccDaughters.begin(), ccDaughters.end() ) ;
+      if( ccParent == parent && not std::lexicographical_compare( ccDaughters.begin(), ccDaughters.end(), daughters.begin(), daughters.end() ) ) {
+        return false ;
+      }
+      parent = ccParent ;
+      daughters.swap( ccDaughters ) ;
+      return true ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    DecayModeId DecayModeTable::intern( int parent, const std::vector<int> &daughters ) {
+      // keep the load factor under 1/2
+      if( 2 * ( size() + 1 ) > _slots.size() ) {
+        rehash( std::max<std::size_t>( 64, 2 * _slots.size() ) ) ;
+      }
+      const auto h = hash( parent, daughters.data(), daughters.size() ) ;
+      const auto s = slot( h, parent, daughters.data(), daughters.size() ) ;
+      if( NoDecayMode != _slots[s] ) {
+        return _slots[s] ;
+      }
+      const auto id = static_cast<DecayModeId>( size() ) ;
+      _pdgs.push_back( parent ) ;
+      _pdgs.insert( _pdgs.end(), daughters.begin(), daughters.end() ) ;
+      _offsets.push_back( static_cast<uint32_t>( _pdgs.size() ) ) ;
+      _hashes.push_back( h ) ;
+      _slots[s] = id ;
+      return id ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    DecayModeId DecayModeTable::find( int parent, const std::vector<int> &daughters ) const {
+      if( _slots.empty() ) {
+        return NoDecayMode ;
+      }
+      const auto h = hash( parent, daughters.data(), daughters.size() ) ;
+      return _slots[ slot( h, parent, daughters.data(), daughters.size() ) ] ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::string DecayModeTable::str( DecayModeId id ) const {
+      std::ostringstream ss ;
+      const int p = parent( id ) ;
+      ss << pdgName( p ) << " ->" ;
+      std::vector<int> ccDaughters( daughters( id ), daughters( id ) + nDaughters( id ) ) ;
+      for( const auto d : ccDaughters ) {
+        ss << " " << pdgName( d ) ;
+      }
+      std::transform( ccDaughters.begin(), ccDaughters.end(), ccDaughters.begin(), conjugate ) ;
+      std::sort( ccDaughters.begin(), ccDaughters.end() ) ;
+      const bool selfConjugate = ( conjugate( p ) == p ) && std::equal( ccDaughters.begin(), ccDaughters.end(), daughters( id ) ) ;
+      if( not selfConjugate ) {
+        ss << " [cc]" ;
+      }
+      return ss.str() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DecayModeTable::clear() {
+      _pdgs.clear() ;
+      _offsets.assign( 1, 0 ) ;
+      _hashes.clear() ;
+      _slots.clear() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t DecayModeTable::memoryBytes() const {
+      return _pdgs.capacity() * sizeof(int)
+        + _offsets.capacity() * sizeof(uint32_t)
+        + _hashes.capacity() * sizeof(uint64_t)
+        + _slots.capacity() * sizeof(DecayModeId) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    uint64_t DecayModeTable::hash( int parent, const int *daughters, std::size_t n ) {
+      // FNV-1a over the pdg ids, then a final avalanche
+      uint64_t h = 14695981039346656037ull ;
+      auto mix = [&h]( int value ) {
+        h ^= static_cast<uint32_t>( value ) ;
+        h *= 1099511628211ull ;
+      };
+      mix( parent ) ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        mix( daughters[i] ) ;
+      }
+      h ^= h >> 33 ;
+      h *= 0xff51afd7ed558ccdull ;
+      h ^= h >> 33 ;
+      return h ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    bool DecayModeTable::equals( DecayModeId id, int parent, const int *daughters, std::size_t n ) const {
+      return this->parent( id ) == parent && nDaughters( id ) == n
+        && std::equal( daughters, daughters + n, this->daughters( id ) ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t DecayModeTable::slot( uint64_t h, int parent, const int *daughters, std::size_t n ) const {
+      const std::size_t mask = _slots.size() - 1 ;
+      // linear probing
+      for( std::size_t s = h & mask ; ; s = ( s + 1 ) & mask ) {
+        const auto id = _slots[s] ;
+        if( NoDecayMode == id || ( _hashes[id] == h && equals( id, parent, daughters, n ) ) ) {
+          return s ;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DecayModeTable::rehash( std::size_t nslots ) {
+      _slots.assign( nslots, NoDecayMode ) ;
+      const std::size_t mask = nslots - 1 ;
+      for( DecayModeId id=0 ; id<size() ; ++id ) {
+        std::size_t s = _hashes[id] & mask ;
+        while( NoDecayMode != _slots[s] ) {
+          s = ( s + 1 ) & mask ;
+        }
+        _slots[s] = id ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    void DecayCensus::Shard::add( const DecayTree &tree, NodeFlags vetoed ) {
+      const auto &flags = tree.flagArray() ;
+      for( NodeIndex n=0 ; n<tree.size() ; ++n ) {
+        if( ( flags[n] & ( vetoed | node::Leaf ) ) ) {
+          continue ;
+        }
+        _daughters.clear() ;
+        for( const auto daughter : tree.daughters( n ) ) {
+          if( not ( flags[daughter] & node::CreatedInSimulation ) ) {
+            _daughters.push_back( tree.pdg( daughter ) ) ;
+          }
+        }
+        if( _daughters.empty() ) {
+          continue ;
+        }
+        int parent = tree.pdg( n ) ;
+        DecayModeTable::canonicalize( parent, _daughters ) ;
+        const auto id = _modes.intern( parent, _daughters ) ;
+        if( id >= _counts.size() ) {
+          _counts.resize( id+1, 0 ) ;
+        }
+        ++_counts[id] ;
+      }
+      ++_nEvents ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    DecayModeId DecayCensus::Shard::add( int parent, const std::vector<int> &daughters, uint64_t count ) {
+      _daughters.assign( daughters.begin(), daughters.end() ) ;
+      DecayModeTable::canonicalize( parent, _daughters ) ;
+      const auto id = _modes.intern( parent, _daughters ) ;
+      if( id >= _counts.size() ) {
+        _counts.resize( id+1, 0 ) ;
+      }
+      _counts[id] += count ;
+      return id ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DecayCensus::Shard::clear() {
+      _modes.clear() ;
+      _counts.clear() ;
+      _nEvents = 0 ;
+    }
+
+    //----------------------------------------------------------------------------
+    //----------------------------------------------------------------------------
+
+    void DecayCensus::merge( const Shard &shard ) {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      auto &total = _total ;
+      for( DecayModeId id=0 ; id<shard._modes.size() ; ++id ) {
+        const auto &modes = shard._modes ;
+        total._daughters.assign( modes.daughters( id ), modes.daughters( id ) + modes.nDaughters( id ) ) ;
+        // already canonical
+        const auto totalId = total._modes.intern( modes.parent( id ), total._daughters ) ;
+        if( totalId >= total._counts.size() ) {
+          total._counts.resize( totalId+1, 0 ) ;
+        }
+        total._counts[totalId] += shard._counts[id] ;
+      }
+      total._nEvents += shard._nEvents ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::vector<DecayModeId> DecayCensus::sortedModes() const {
+      const auto &modes = _total._modes ;
+      std::vector<DecayModeId> ids( modes.size() ) ;
+      for( DecayModeId id=0 ; id<ids.size() ; ++id ) {
+        ids[id] = id ;
+      }
+      std::sort( ids.begin(), ids.end(), [&]( DecayModeId lhs, DecayModeId rhs ) {
+        const int lp = std::abs( modes.parent( lhs ) ) ;
+        const int rp = std::abs( modes.parent( rhs ) ) ;
+        if( lp != rp ) {
+          return lp < rp ;
+        }
+        if( modes.parent( lhs ) != modes.parent( rhs ) ) {
+          return modes.parent( lhs ) > modes.parent( rhs ) ;
+        }
+        return ( count( lhs ) != count( rhs ) ) ? count( lhs ) > count( rhs ) : lhs < rhs ;
+      }) ;
+      return ids ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DecayCensus::print( std::ostream &stream ) const {
+      // the fractions are printed in fixed notation: restore the caller's format
+      StreamFormatGuard formatGuard( stream ) ;
+      const auto &modes = _total._modes ;
+      const auto ids = sortedModes() ;
+      stream << "Decay census: " << modes.size() << " decay modes in " << nEvents() << " events" << std::endl ;
+      for( std::size_t first=0 ; first<ids.size() ; ) {
+        // the range of modes with the same parent
+        const int parent = modes.parent( ids[first] ) ;
+        std::size_t last = first ;
+        uint64_t total = 0 ;
+        while( last < ids.size() && modes.parent( ids[last] ) == parent ) {
+          total += count( ids[last++] ) ;
+        }
+        stream << "  " << pdgName( parent ) << " (" << parent << "): " << total << " decays" << std::endl ;
+        for( ; first<last ; ++first ) {
+          stream << "    " << std::setw(12) << count( ids[first] ) << "  "
+            << std::fixed << std::setprecision(4) << static_cast<double>( count( ids[first] ) ) / total
+            << "  " << modes.str( ids[first] ) << std::endl ;
+        }
+      }
+    }
+
+  }
+
+}
@@ -0,0 +1,346 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/DecayPattern.h>
+
+// -- std headers
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    namespace {
+
+      /// A token of the pattern string
+      struct Token {
+        enum Type { Name, Open, Close, Arrow, Ellipsis } ;
+        Type                       _type {Name} ;
+        std::string                _text {} ;
+      };
+
+      /// A particle of the parsed pattern, before compilation
+      struct ParsedNode {
+        int                        _pdg {0} ;
+        bool                       _inclusive {false} ;
+        std::size_t                _size {1} ;
+        std::vector<ParsedNode>    _daughters {} ;
+      };
+
+      [[noreturn]] void syntaxError( const std::string &pattern, const std::string &what ) {
+        std::stringstream ss ; ss << "Invalid decay pattern '" << pattern << "': " << what << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+
+      /// Split a pattern in tokens. Particle names may contain parentheses,
+      /// e.g "K(S)0" or "J/psi(1S)", so only the leading parentheses and the
+      /// unbalanced trailing ones of a word are group delimiters
+      std::vector<Token> tokenize( const std::string &pattern, const std::string &body ) {
+        std::vector<Token> tokens ;
+        std::istringstream words( body ) ;
+        std::string word ;
+        while( words >> word ) {
+          std::size_t first = 0 ;
+          while( first < word.size() && '(' == word[first] ) {
+            tokens.push_back( { Token::Open, "(" } ) ;
+            ++first ;
+          }
+          std::size_t last = word.size() ;
+          std::size_t ncloses = 0 ;
+          while( last > first && ')' == word[last-1] ) {
+            const auto text = word.substr( first, last-first ) ;
+            if( std::count( text.begin(), text.end(), ')' ) <= std::count( text.begin(), text.end(), '(' ) ) {
+              break ;
+            }
+            --last ;
+            ++ncloses ;
+          }
+          if( last > first ) {
+            const auto text = word.substr( first, last-first ) ;
+            if( "->" == text ) {
+              tokens.push_back( { Token::Arrow, text } ) ;
+            }
+            else if( "..." == text ) {
+              tokens.push_back( { Token::Ellipsis, text } ) ;
+            }
+            else if( text.find_first_of( "[]" ) != std::string::npos ) {
+              syntaxError( pattern, "misplaced '[...]cc' in '" + text + "'" ) ;
+            }
+            else {
+              tokens.push_back( { Token::Name, text } ) ;
+            }
+          }
+          for( std::size_t i=0 ; i<ncloses ; ++i ) {
+            tokens.push_back( { Token::Close, ")" } ) ;
+          }
+        }
+        return tokens ;
+      }
+
+      /**
+       *  Recursive descent parser of the token list:
+       *
+       *    decay := particle [ '->' item+ ]
+       *    item  := particle | '(' particle '->' item+ ')' | '...'
+       */
+      class Parser {
+      public:
+        Parser( const std::string &pattern, std::vector<Token> tokens ) :
+          _pattern(pattern),
+          _tokens(std::move(tokens)) {
+        }
+
+        ParsedNode parse() {
+          auto root = parseDecay( false ) ;
+          if( _pos < _tokens.size() ) {
+            syntaxError( _pattern, "unexpected '" + _tokens[_pos]._text + "'" ) ;
+          }
+          return root ;
+        }
+
+      private:
+        ParsedNode parseDecay( bool requireArrow ) {
+          ParsedNode node ;
+          node._pdg = parseParticle() ;
+          if( _pos < _tokens.size() && Token::Arrow == _tokens[_pos]._type ) {
+            ++_pos ;
+            parseDaughters( node ) ;
+          }
+          else if( requireArrow ) {
+            syntaxError( _pattern, "expected '->' after a particle opening a sub-decay" ) ;
+          }
+          return node ;
+        }
+
+        void parseDaughters( ParsedNode &node ) {
+          bool empty = true ;
+          while( _pos < _tokens.size() && Token::Close != _tokens[_pos]._type ) {
+            switch( _tokens[_pos]._type ) {
+              case Token::Name: {
+                ParsedNode daughter ;
+                daughter._pdg = parseParticle() ;
+                node._daughters.push_back( std::move( daughter ) ) ;
+                break ;
+              }
+              case Token::Open: {
+                ++_pos ;
+                node._daughters.push_back( parseDecay( true ) ) ;
+                if( _pos >= _tokens.size() || Token::Close != _tokens[_pos]._type ) {
+                  syntaxError( _pattern, "missing ')'" ) ;
+                }
+                ++_pos ;
+                break ;
+              }
+              case Token::Ellipsis: {
+                node._inclusive = true ;
+                ++_pos ;
+                break ;
+              }
+              default: {
+                syntaxError( _pattern, "unexpected '" + _tokens[_pos]._text + "'" ) ;
+              }
+            }
+            empty = false ;
+          }
+          if( empty ) {
+            syntaxError( _pattern, "no daughter after '->'" ) ;
+          }
+          for( const auto &daughter : node._daughters ) {
+            node._size += daughter._size ;
+          }
+        }
+
+        int parseParticle() {
+          if( _pos >= _tokens.size() || Token::Name != _tokens[_pos]._type ) {
+            syntaxError( _pattern, "expected a particle" ) ;
+          }
+          const auto &text = _tokens[_pos++]._text ;
+          const bool numeric = std::all_of( text.begin() + ( '-' == text[0] ? 1 : 0 ), text.end(), []( char c ) {
+            return std::isdigit( static_cast<unsigned char>( c ) ) ;
+          }) && text != "-" ;
+          if( numeric ) {
+            try {
+              return std::stoi( text ) ;
+            }
+            catch( const std::out_of_range & ) {
+              syntaxError( _pattern, "pdg id " + text + " out of range" ) ;
+            }
+          }
+          const auto &index = pdg::PDGIndex::instance() ;
+          const auto row = index.rowFromName( text ) ;
+          if( pdg::PDGIndex::NoRow == row ) {
+            syntaxError( _pattern, "unknown particle '" + text + "'" ) ;
+          }
+          return pdg::pdgTable[row].pdg() ;
+        }
+
+      private:
+        const std::string         &_pattern ;
+        std::vector<Token>         _tokens {} ;
+        std::size_t                _pos {0} ;
+      };
+
+      /// Get the charge conjugate of a pdg id, itself if self-conjugate
+      int conjugate( int pdg ) {
+        return ( pdg::PDGIndex::NoRow != pdg::PDGIndex::instance().row( -pdg ) ) ? -pdg : pdg ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    DecayPattern::DecayPattern( const std::string &pattern ) {
+      compile( pattern ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DecayPattern::compile( const std::string &pattern ) {
+      std::string body = pattern ;
+      body.erase( 0, body.find_first_not_of( " \t\n" ) ) ;
+      body.erase( body.find_last_not_of( " \t\n" ) + 1 ) ;
+      const std::string ccSuffix = "]cc" ;
+      bool chargeConjugate = false ;
+      if( not body.empty() && '[' == body.front() ) {
+        if( body.size() < 1 + ccSuffix.size() || 0 != body.compare( body.size() - ccSuffix.size(), ccSuffix.size(), ccSuffix ) ) {
+          syntaxError( pattern, "'[' must close with ']cc' at the end of the pattern" ) ;
+        }
+        body = body.substr( 1, body.size() - 1 - ccSuffix.size() ) ;
+        chargeConjugate = true ;
+      }
+      const auto root = Parser( pattern, tokenize( pattern, body ) ).parse() ;
+      if( root._size > std::numeric_limits<uint16_t>::max() ) {
+        syntaxError( pattern, "too many particles" ) ;
+      }
+      // flatten in pattern string order, with contiguous daughter lists
+      std::vector<Node> nodes ;
+      std::vector<uint16_t> daughters ;
+      const auto &index = pdg::PDGIndex::instance() ;
+      auto flatten = [&]( const ParsedNode &parsed, auto &self ) -> uint16_t {
+        const auto p = static_cast<uint16_t>( nodes.size() ) ;
+        nodes.emplace_back() ;
+        const int pdgs[2] = { parsed._pdg, chargeConjugate ? conjugate( parsed._pdg ) : parsed._pdg } ;
+        nodes[p]._pdgs[0] = pdgs[0] ;
+        nodes[p]._pdgs[1] = pdgs[1] ;
+        nodes[p]._categories = index.categories( pdgs[0] ) & index.categories( pdgs[1] ) ;
+        nodes[p]._inclusive = parsed._inclusive ;
+        nodes[p]._nDaughters = static_cast<uint16_t>( parsed._daughters.size() ) ;
+        nodes[p]._firstDaughter = static_cast<uint16_t>( daughters.size() ) ;
+        daughters.resize( daughters.size() + parsed._daughters.size() ) ;
+        for( std::size_t i=0 ; i<parsed._daughters.size() ; ++i ) {
+          const auto d = self( parsed._daughters[i], self ) ;
+          daughters[ nodes[p]._firstDaughter + i ] = d ;
+        }
+        return p ;
+      };
+      flatten( root, flatten ) ;
+      // try the largest sub-decays first, they fail early
+      std::vector<std::size_t> sizes( nodes.size(), 1 ) ;
+      for( std::size_t p=nodes.size() ; p>0 ; --p ) {
+        const auto &node = nodes[p-1] ;
+        for( std::size_t i=0 ; i<node._nDaughters ; ++i ) {
+          sizes[p-1] += sizes[ daughters[ node._firstDaughter + i ] ] ;
+        }
+      }
+      for( const auto &node : nodes ) {
+        std::stable_sort( daughters.begin() + node._firstDaughter, daughters.begin() + node._firstDaughter + node._nDaughters,
+          [&sizes]( uint16_t lhs, uint16_t rhs ) {
+          return sizes[lhs] > sizes[rhs] ;
+        }) ;
+      }
+      const bool selfConjugate = std::all_of( nodes.begin(), nodes.end(), []( const Node &node ) {
+        return node._pdgs[0] == node._pdgs[1] ;
+      }) ;
+      _pattern = pattern ;
+      _nodes = std::move( nodes ) ;
+      _daughters = std::move( daughters ) ;
+      _chargeConjugate = chargeConjugate ;
+      _nVariants = ( chargeConjugate && not selfConjugate ) ? 2 : 1 ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t DecayPattern::match( const DecayTree &tree, std::vector<NodeIndex> &matches ) const {
+      if( _nodes.empty() ) {
+        return 0 ;
+      }
+      const auto &categories = tree.categoryArray() ;
+      const auto rootCategories = _nodes[0]._categories ;
+      const auto npnodes = _nodes.size() ;
+      std::size_t nmatches = 0 ;
+      for( NodeIndex n=0 ; n<tree.size() ; ++n ) {
+        if( ( categories[n] & rootCategories ) != rootCategories ) {
+          continue ;
+        }
+        for( std::size_t variant=0 ; variant<_nVariants ; ++variant ) {
+          const auto offset = matches.size() ;
+          matches.resize( offset + npnodes ) ;
+          if( matchNode( tree, n, 0, variant, matches.data() + offset ) ) {
+            ++nmatches ;
+            break ;
+          }
+          matches.resize( offset ) ;
+        }
+      }
+      return nmatches ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    bool DecayPattern::matches( const DecayTree &tree, NodeIndex n ) const {
+      if( _nodes.empty() || n >= tree.size() ) {
+        return false ;
+      }
+      std::vector<NodeIndex> assigned( _nodes.size() ) ;
+      for( std::size_t variant=0 ; variant<_nVariants ; ++variant ) {
+        if( matchNode( tree, n, 0, variant, assigned.data() ) ) {
+          return true ;
+        }
+      }
+      return false ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    bool DecayPattern::matchNode( const DecayTree &tree, NodeIndex n, std::size_t p, std::size_t variant, NodeIndex *assigned ) const {
+      const auto &node = _nodes[p] ;
+      if( ( tree.categories( n ) & node._categories ) != node._categories || tree.pdg( n ) != node._pdgs[variant] ) {
+        return false ;
+      }
+      assigned[p] = n ;
+      if( 0 == node._nDaughters ) {
+        return true ;
+      }
+      const auto daughters = tree.daughters( n ) ;
+      // the used daughters are tracked in a 64 bit mask
+      if( daughters.size() < node._nDaughters || daughters.size() > 64
+        || ( not node._inclusive && daughters.size() != node._nDaughters ) ) {
+        return false ;
+      }
+      return matchDaughters( tree, daughters, node, 0, 0, variant, assigned ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    bool DecayPattern::matchDaughters( const DecayTree &tree, NodeSpan daughters, const Node &node, std::size_t i, uint64_t used, std::size_t variant, NodeIndex *assigned ) const {
+      if( i == node._nDaughters ) {
+        return true ;
+      }
+      const auto p = _daughters[ node._firstDaughter + i ] ;
+      for( std::size_t d=0 ; d<daughters.size() ; ++d ) {
+        const uint64_t bit = uint64_t(1) << d ;
+        if( ( used & bit ) || not matchNode( tree, daughters[d], p, variant, assigned ) ) {
+          continue ;
+        }
+        if( matchDaughters( tree, daughters, node, i+1, used | bit, variant, assigned ) ) {
+          return true ;
+        }
+      }
+      return false ;
+    }
+
+  }
+
+}
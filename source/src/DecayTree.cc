@@ -0,0 +1,240 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/DecayTree.h>
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCEvent.h>
+#include <EVENT/MCParticle.h>
+
+// -- std headers
+#include <algorithm>
+#include <memory>
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    namespace {
+
+      /// A decay tree cached for an event collection
+      struct CachedTree {
+        std::string                  _collectionName {} ;
+        int                          _runNumber {0} ;
+        int                          _eventNumber {0} ;
+        const EVENT::LCCollection   *_collection {nullptr} ;
+        std::unique_ptr<DecayTree>   _tree {} ;
+      };
+
+      /// Get the node status flags of an MCParticle
+      NodeFlags statusFlags( const EVENT::MCParticle *particle ) {
+        NodeFlags flags = 0 ;
+        switch( particle->getGeneratorStatus() ) {
+          case 1: flags |= node::GeneratorStable ; break ;
+          case 2: flags |= node::GeneratorDecayed ; break ;
+          case 3: flags |= node::GeneratorDocumentation ; break ;
+          default: break ;
+        }
+        flags |= particle->isCreatedInSimulation() ? node::CreatedInSimulation : 0 ;
+        flags |= particle->isBackscatter() ? node::Backscatter : 0 ;
+        flags |= particle->isDecayedInTracker() ? node::DecayedInTracker : 0 ;
+        flags |= particle->isDecayedInCalorimeter() ? node::DecayedInCalorimeter : 0 ;
+        flags |= particle->hasLeftDetector() ? node::LeftDetector : 0 ;
+        flags |= particle->isStopped() ? node::Stopped : 0 ;
+        flags |= particle->isOverlay() ? node::Overlay : 0 ;
+        return flags ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    const DecayTree &DecayTree::eventTree( const EVENT::LCEvent *event, const std::string &collectionName ) {
+      thread_local std::vector<CachedTree> cache ;
+      const auto collection = event->getCollection( collectionName ) ;
+      auto iter = std::find_if( cache.begin(), cache.end(), [&]( const CachedTree &entry ) {
+        return entry._collectionName == collectionName ;
+      }) ;
+      if( cache.end() == iter ) {
+        cache.emplace_back() ;
+        iter = std::prev( cache.end() ) ;
+        iter->_collectionName = collectionName ;
+        iter->_tree = std::make_unique<DecayTree>() ;
+      }
+      else if( iter->_collection == collection
+        && iter->_runNumber == event->getRunNumber()
+        && iter->_eventNumber == event->getEventNumber() ) {
+        return *iter->_tree ;
+      }
+      iter->_collection = collection ;
+      iter->_runNumber = event->getRunNumber() ;
+      iter->_eventNumber = event->getEventNumber() ;
+      iter->_tree->build( collection ) ;
+      return *iter->_tree ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DecayTree::build( const EVENT::LCCollection *mcParticles ) {
+      clear() ;
+      const std::size_t nparticles = mcParticles->getNumberOfElements() ;
+      _mcParticles.resize( nparticles ) ;
+      _sortedMCParticles.resize( nparticles ) ;
+      _pdgs.resize( nparticles ) ;
+      _flags.resize( nparticles ) ;
+      for( std::size_t i=0 ; i<nparticles ; ++i ) {
+        const auto particle = static_cast<const EVENT::MCParticle*>( mcParticles->getElementAt( i ) ) ;
+        _mcParticles[i] = particle ;
+        _sortedMCParticles[i] = { particle, static_cast<NodeIndex>( i ) } ;
+        _pdgs[i] = particle->getPDG() ;
+        _flags[i] = statusFlags( particle ) ;
+      }
+      std::sort( _sortedMCParticles.begin(), _sortedMCParticles.end() ) ;
+      // edges from the parent lists, so that daughters come sorted by index
+      for( std::size_t i=0 ; i<nparticles ; ++i ) {
+        for( const auto parent : _mcParticles[i]->getParents() ) {
+          const auto p = node( parent ) ;
+          if( NoNode != p ) {
+            _edges.emplace_back( p, static_cast<NodeIndex>( i ) ) ;
+          }
+        }
+      }
+      buildArrays() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DecayTree::build( const std::vector<int> &pdgs, const std::vector<NodeFlags> &flags, const std::vector<Edge> &edges ) {
+      clear() ;
+      _pdgs.assign( pdgs.begin(), pdgs.end() ) ;
+      _flags.assign( flags.begin(), flags.end() ) ;
+      _flags.resize( _pdgs.size(), 0 ) ;
+      const auto nnodes = _pdgs.size() ;
+      std::copy_if( edges.begin(), edges.end(), std::back_inserter( _edges ), [nnodes]( const Edge &edge ) {
+        return edge.first < nnodes && edge.second < nnodes ;
+      }) ;
+      // sort by daughter, stable to keep the parent order
+      std::stable_sort( _edges.begin(), _edges.end(), []( const Edge &lhs, const Edge &rhs ) {
+        return lhs.second < rhs.second ;
+      }) ;
+      buildArrays() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DecayTree::clear() {
+      _pdgs.clear() ;
+      _particles.clear() ;
+      _categories.clear() ;
+      _flags.clear() ;
+      _parentOffsets.clear() ;
+      _parents.clear() ;
+      _daughterOffsets.clear() ;
+      _daughters.clear() ;
+      _roots.clear() ;
+      _mcParticles.clear() ;
+      _sortedMCParticles.clear() ;
+      _edges.clear() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    NodeIndex DecayTree::node( const EVENT::MCParticle *mcParticle ) const {
+      auto iter = std::lower_bound( _sortedMCParticles.begin(), _sortedMCParticles.end(), mcParticle,
+        []( const std::pair<const EVENT::MCParticle*, NodeIndex> &entry, const EVENT::MCParticle *p ) {
+        return entry.first < p ;
+      }) ;
+      return ( _sortedMCParticles.end() != iter && iter->first == mcParticle ) ? iter->second : NoNode ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DecayTree::topologicalOrder( std::vector<NodeIndex> &order ) const {
+      const auto nnodes = size() ;
+      order.clear() ;
+      order.reserve( nnodes ) ;
+      // Kahn's algorithm, using the output as queue
+      std::vector<NodeIndex> pending( nnodes ) ;
+      for( std::size_t n=0 ; n<nnodes ; ++n ) {
+        pending[n] = _parentOffsets[n+1] - _parentOffsets[n] ;
+      }
+      order.insert( order.end(), _roots.begin(), _roots.end() ) ;
+      for( std::size_t i=0 ; i<order.size() ; ++i ) {
+        for( const auto daughter : daughters( order[i] ) ) {
+          if( 0 == --pending[daughter] ) {
+            order.push_back( daughter ) ;
+          }
+        }
+      }
+      if( order.size() < nnodes ) {
+        for( std::size_t n=0 ; n<nnodes ; ++n ) {
+          if( pending[n] > 0 ) {
+            order.push_back( static_cast<NodeIndex>( n ) ) ;
+          }
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t DecayTree::memoryBytes() const {
+      return _pdgs.capacity() * sizeof(int)
+        + _particles.capacity() * sizeof(pdg::ParticleRef)
+        + _categories.capacity() * sizeof(pdg::Categories)
+        + _flags.capacity() * sizeof(NodeFlags)
+        + ( _parentOffsets.capacity() + _parents.capacity() + _daughterOffsets.capacity()
+          + _daughters.capacity() + _roots.capacity() ) * sizeof(NodeIndex)
+        + _mcParticles.capacity() * sizeof(const EVENT::MCParticle*)
+        + _sortedMCParticles.capacity() * sizeof(std::pair<const EVENT::MCParticle*, NodeIndex>)
+        + _edges.capacity() * sizeof(Edge) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DecayTree::buildArrays() {
+      const auto nnodes = _pdgs.size() ;
+      const auto &index = pdg::PDGIndex::instance() ;
+      _particles.resize( nnodes ) ;
+      _categories.resize( nnodes ) ;
+      for( std::size_t n=0 ; n<nnodes ; ++n ) {
+        const auto row = index.row( _pdgs[n] ) ;
+        _particles[n] = pdg::ParticleRef( row ) ;
+        _categories[n] = ( pdg::PDGIndex::NoRow == row ) ? 0 : index.rowCategories( row ) ;
+        _flags[n] &= ~( node::Root | node::Leaf | node::UnknownParticle ) ;
+        _flags[n] |= ( pdg::PDGIndex::NoRow == row ) ? node::UnknownParticle : 0 ;
+      }
+      // count, prefix sum, fill. The edges are sorted by daughter
+      _parentOffsets.assign( nnodes+1, 0 ) ;
+      _daughterOffsets.assign( nnodes+1, 0 ) ;
+      for( const auto &edge : _edges ) {
+        ++_parentOffsets[ edge.second+1 ] ;
+        ++_daughterOffsets[ edge.first+1 ] ;
+      }
+      for( std::size_t n=0 ; n<nnodes ; ++n ) {
+        _parentOffsets[n+1] += _parentOffsets[n] ;
+        _daughterOffsets[n+1] += _daughterOffsets[n] ;
+      }
+      _parents.resize( _edges.size() ) ;
+      _daughters.resize( _edges.size() ) ;
+      // the daughter offsets are used as fill cursors, then shifted back
+      for( std::size_t e=0 ; e<_edges.size() ; ++e ) {
+        _parents[e] = _edges[e].first ;
+        _daughters[ _daughterOffsets[ _edges[e].first ]++ ] = _edges[e].second ;
+      }
+      for( std::size_t n=nnodes ; n>0 ; --n ) {
+        _daughterOffsets[n] = _daughterOffsets[n-1] ;
+      }
+      _daughterOffsets[0] = 0 ;
+      for( std::size_t n=0 ; n<nnodes ; ++n ) {
+        if( _parentOffsets[n] == _parentOffsets[n+1] ) {
+          _flags[n] |= node::Root ;
+          _roots.push_back( static_cast<NodeIndex>( n ) ) ;
+        }
+        if( _daughterOffsets[n] == _daughterOffsets[n+1] ) {
+          _flags[n] |= node::Leaf ;
+        }
+      }
+    }
+
+  }
+
+}
@@ -0,0 +1,181 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/DurhamClustering.h>
+
+// -- std headers
+#include <limits>
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    namespace {
+      /// The cluster id of particles not yet merged, and the jet index of unassigned clusters
+      constexpr uint32_t NoCluster = std::numeric_limits<uint32_t>::max() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DurhamClustering::clusterExclusive( const kinematics::FourMomentumArray &particles, std::size_t njets ) {
+      cluster( particles, std::max<std::size_t>( njets, 1 ), 0. ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DurhamClustering::clusterYcut( const kinematics::FourMomentumArray &particles, double ycut ) {
+      cluster( particles, 0, ycut ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DurhamClustering::cluster( const kinematics::FourMomentumArray &particles, std::size_t njets, double ycut ) {
+      const auto nparticles = particles.size() ;
+      _nslots = nparticles ;
+      for( auto array : { &_px, &_py, &_pz, &_e, &_nx, &_ny, &_nz, &_angles, &_distances, &_scratch } ) {
+        array->resize( nparticles ) ;
+      }
+      _ids.resize( nparticles ) ;
+      _neighbours.resize( nparticles ) ;
+      _rescan.resize( nparticles ) ;
+      _parents.assign( 2 * nparticles, NoCluster ) ;
+      _yValues.assign( nparticles, 0. ) ;
+      _nclusters = nparticles ;
+      double evis = 0. ;
+      for( std::size_t i=0 ; i<nparticles ; ++i ) {
+        const auto p = particles.get( i ) ;
+        setSlot( i, p._px, p._py, p._pz, p._e, static_cast<uint32_t>( i ) ) ;
+        evis += p._e ;
+      }
+      const double norm = evis > 0. ? 1. / ( evis * evis ) : 1. ;
+      if( _nslots > 1 ) {
+        for( std::size_t i=0 ; i<_nslots ; ++i ) {
+          angularDistances( i ) ;
+          updateNeighbour( i ) ;
+          updateDistance( i ) ;
+        }
+      }
+      bool kept = false ;
+      while( _nslots > 1 ) {
+        // the closest pair, from the cached nearest neighbours
+        std::size_t a = 0 ;
+        for( std::size_t i=1 ; i<_nslots ; ++i ) {
+          if( _distances[i] < _distances[a] ) {
+            a = i ;
+          }
+        }
+        const double y = _distances[a] * norm ;
+        if( not kept && ( ( njets > 0 && _nslots <= njets ) || ( 0 == njets && y > ycut ) ) ) {
+          keepJets() ;
+          kept = true ;
+        }
+        _yValues[ _nslots-1 ] = y ;
+        // merge in the lower slot, move the last slot in the upper one
+        const std::size_t b = _neighbours[a] ;
+        const std::size_t keep = std::min( a, b ), gone = std::max( a, b ) ;
+        for( std::size_t k=0 ; k<_nslots ; ++k ) {
+          _rescan[k] = ( _neighbours[k] == a || _neighbours[k] == b ) ;
+        }
+        const auto id = static_cast<uint32_t>( _nclusters++ ) ;
+        _parents[ _ids[a] ] = id ;
+        _parents[ _ids[b] ] = id ;
+        setSlot( keep, _px[a] + _px[b], _py[a] + _py[b], _pz[a] + _pz[b], _e[a] + _e[b], id ) ;
+        const std::size_t last = _nslots-1 ;
+        if( gone != last ) {
+          setSlot( gone, _px[last], _py[last], _pz[last], _e[last], _ids[last] ) ;
+          _neighbours[gone] = _neighbours[last] ;
+          _angles[gone] = _angles[last] ;
+          _distances[gone] = _distances[last] ;
+          _rescan[gone] = _rescan[last] ;
+          for( std::size_t k=0 ; k<last ; ++k ) {
+            if( _neighbours[k] == last ) {
+              _neighbours[k] = static_cast<uint32_t>( gone ) ;
+            }
+          }
+        }
+        --_nslots ;
+        if( 1 == _nslots ) {
+          break ;
+        }
+        // the merged jet may be the new nearest neighbour of the others
+        angularDistances( keep ) ;
+        updateNeighbour( keep ) ;
+        updateDistance( keep ) ;
+        for( std::size_t k=0 ; k<_nslots ; ++k ) {
+          if( k != keep && not _rescan[k] && _scratch[k] < _angles[k] ) {
+            _neighbours[k] = static_cast<uint32_t>( keep ) ;
+            _angles[k] = _scratch[k] ;
+            updateDistance( k ) ;
+          }
+        }
+        // the slots that had one of the merged pair as neighbour search again
+        for( std::size_t k=0 ; k<_nslots ; ++k ) {
+          if( k != keep && _rescan[k] ) {
+            angularDistances( k ) ;
+            updateNeighbour( k ) ;
+            updateDistance( k ) ;
+          }
+        }
+      }
+      if( not kept ) {
+        keepJets() ;
+      }
+      assignParticles( nparticles ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DurhamClustering::angularDistances( std::size_t slot ) {
+      const double nx = _nx[slot], ny = _ny[slot], nz = _nz[slot] ;
+      const double *x = _nx.data(), *y = _ny.data(), *z = _nz.data() ;
+      double *scratch = _scratch.data() ;
+      for( std::size_t k=0 ; k<_nslots ; ++k ) {
+        scratch[k] = 1. - ( nx*x[k] + ny*y[k] + nz*z[k] ) ;
+      }
+      scratch[slot] = std::numeric_limits<double>::max() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DurhamClustering::updateNeighbour( std::size_t slot ) {
+      std::size_t neighbour = ( 0 == slot ) ? 1 : 0 ;
+      for( std::size_t k=neighbour+1 ; k<_nslots ; ++k ) {
+        if( _scratch[k] < _scratch[neighbour] ) {
+          neighbour = k ;
+        }
+      }
+      _neighbours[slot] = static_cast<uint32_t>( neighbour ) ;
+      _angles[slot] = _scratch[neighbour] ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DurhamClustering::keepJets() {
+      _jets.clear() ;
+      _jetIds.clear() ;
+      for( std::size_t i=0 ; i<_nslots ; ++i ) {
+        _jets.push_back( _px[i], _py[i], _pz[i], _e[i] ) ;
+        _jetIds.push_back( _ids[i] ) ;
+      }
+      _nclustersAtJets = _nclusters ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void DurhamClustering::assignParticles( std::size_t nparticles ) {
+      // parents have higher ids than their children: one pass in decreasing id order
+      _labels.assign( _nclustersAtJets, NoCluster ) ;
+      for( std::size_t j=0 ; j<_jetIds.size() ; ++j ) {
+        _labels[ _jetIds[j] ] = static_cast<uint32_t>( j ) ;
+      }
+      for( std::size_t c=_nclustersAtJets ; c>0 ; --c ) {
+        auto &label = _labels[c-1] ;
+        if( NoCluster == label ) {
+          label = _labels[ _parents[c-1] ] ;
+        }
+      }
+      _particleJets.assign( _labels.begin(), _labels.begin() + nparticles ) ;
+    }
+
+  }
+
+}
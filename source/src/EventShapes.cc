@@ -0,0 +1,458 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/EventShapes.h>
+
+// -- std headers
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    namespace {
+      constexpr double Pi = 3.141592653589793 ;
+      /// Particles with a smaller squared transverse momentum to the pivot,
+      /// relative to their squared momentum, are collinear to the pivot
+      constexpr double Collinear = 1e-20 ;
+      /// The initial cells of the approximate thrust, in theta and phi
+      constexpr std::size_t NThetaCells = 4 ;
+      constexpr std::size_t NPhiCells = 8 ;
+      /// Maximum number of iterations of the axis improvement
+      constexpr std::size_t MaxIterations = 16 ;
+
+      /// Orient a thrust axis to z >= 0 and set the thrust value
+      Thrust makeThrust( double x, double y, double z, double norm, double error ) {
+        Thrust result ;
+        const double length = std::sqrt( x*x + y*y + z*z ) ;
+        if( length <= 0. ) {
+          return result ;
+        }
+        const double sign = z < 0. ? -1. : 1. ;
+        result._thrust = length / norm ;
+        result._x = sign * x / length ;
+        result._y = sign * y / length ;
+        result._z = sign * z / length ;
+        result._error = error ;
+        return result ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    const kinematics::FourMomentumArray &EventShapes::select( const EVENT::LCCollection *pfos, const PFOSelection &selection ) {
+      _classification.classify( pfos ) ;
+      _classification.select( selection, _selected ) ;
+      _particles.fill( pfos, _selected ) ;
+      return _particles ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    const kinematics::FourMomentumArray &EventShapes::select( const EVENT::LCCollection *pfos, SelectionMask mask ) {
+      _classification.classify( pfos ) ;
+      _classification.select( mask, _selected ) ;
+      _particles.fill( pfos, _selected ) ;
+      return _particles ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    Thrust EventShapes::thrust( const kinematics::FourMomentumArray &particles ) {
+      const double norm = setMomenta( particles ) ;
+      const auto n = particles.size() ;
+      if( norm <= 0. ) {
+        return Thrust{} ;
+      }
+      _angles.resize( n ) ;
+      _sides.resize( n ) ;
+      _scratch.resize( n ) ;
+      _order.resize( n ) ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data(), *p = _p.data() ;
+      double *angles = _angles.data(), *sides = _sides.data(), *transverse = _scratch.data() ;
+      double best = -1., bestX = 0., bestY = 0., bestZ = 0. ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        if( p[i] <= 0. ) {
+          continue ;
+        }
+        // the planes containing the pivot have normals m = cos(a) e1 + sin(a) e2, for a in [0, pi)
+        const double nx = _nx[i], ny = _ny[i], nz = _nz[i] ;
+        const double ax = std::fabs( nx ), ay = std::fabs( ny ), az = std::fabs( nz ) ;
+        double e1x = 0., e1y = 0., e1z = 0. ;
+        if( ax <= ay && ax <= az ) {
+          e1y = nz ; e1z = -ny ;
+        }
+        else if( ay <= az ) {
+          e1x = -nz ; e1z = nx ;
+        }
+        else {
+          e1x = ny ; e1y = -nx ;
+        }
+        const double e1 = std::sqrt( e1x*e1x + e1y*e1y + e1z*e1z ) ;
+        e1x /= e1 ; e1y /= e1 ; e1z /= e1 ;
+        const double e2x = ny*e1z - nz*e1y, e2y = nz*e1x - nx*e1z, e2z = nx*e1y - ny*e1x ;
+        for( std::size_t j=0 ; j<n ; ++j ) {
+          const double u = px[j]*e1x + py[j]*e1y + pz[j]*e1z ;
+          const double v = px[j]*e2x + py[j]*e2y + pz[j]*e2z ;
+          // side of the particle at the start of the sweep
+          sides[j] = ( u > 0. || ( 0. == u && v > 0. ) ) ? 1. : -1. ;
+          // it changes side at the angle a of (-v, u), folded into (0, pi]:
+          // monotonic pseudo-angle in (0, 2] instead of atan2
+          const double fold = ( u < 0. || ( 0. == u && v < 0. ) ) ? -1. : 1. ;
+          const double x = -fold * v, y = fold * u ;
+          const double l1 = std::fabs( x ) + std::fabs( y ) ;
+          const double nullLength = ( 0. == l1 ) ;
+          angles[j] = 1. - x / ( l1 + nullLength ) ;
+          transverse[j] = u*u + v*v ;
+        }
+        // the pivot and the particles collinear to it can be on either side
+        double pivotX = px[i], pivotY = py[i], pivotZ = pz[i] ;
+        double dx = 0., dy = 0., dz = 0. ;
+        std::size_t m = 0 ;
+        for( std::size_t j=0 ; j<n ; ++j ) {
+          if( j == i ) {
+            continue ;
+          }
+          if( transverse[j] <= Collinear * p[j]*p[j] ) {
+            const double sign = ( px[j]*nx + py[j]*ny + pz[j]*nz ) < 0. ? -1. : 1. ;
+            pivotX += sign * px[j] ; pivotY += sign * py[j] ; pivotZ += sign * pz[j] ;
+            continue ;
+          }
+          dx += sides[j] * px[j] ; dy += sides[j] * py[j] ; dz += sides[j] * pz[j] ;
+          _order[m++] = static_cast<uint32_t>( j ) ;
+        }
+        const auto evaluate = [&]() {
+          for( const double sign : { 1., -1. } ) {
+            const double x = dx + sign * pivotX, y = dy + sign * pivotY, z = dz + sign * pivotZ ;
+            const double length2 = x*x + y*y + z*z ;
+            if( length2 > best ) {
+              best = length2 ;
+              bestX = x ; bestY = y ; bestZ = z ;
+            }
+          }
+        } ;
+        evaluate() ;
+        std::sort( _order.begin(), _order.begin() + m, [angles]( uint32_t lhs, uint32_t rhs ) {
+          return angles[lhs] < angles[rhs] ;
+        }) ;
+        for( std::size_t k=0 ; k<m ; ++k ) {
+          const auto j = _order[k] ;
+          const double flip = 2. * sides[j] ;
+          dx -= flip * px[j] ; dy -= flip * py[j] ; dz -= flip * pz[j] ;
+          evaluate() ;
+        }
+      }
+      return makeThrust( bestX, bestY, bestZ, norm, 0. ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    Thrust EventShapes::approximateThrust( const kinematics::FourMomentumArray &particles, double maxError ) {
+      if( not ( maxError > 0. ) ) {
+        std::stringstream ss ; ss << "EventShapes::approximateThrust: invalid maximum error " << maxError << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      const double norm = setMomenta( particles ) ;
+      if( norm <= 0. ) {
+        return Thrust{} ;
+      }
+      _scratch.resize( particles.size() ) ;
+      _sides.resize( particles.size() ) ;
+      const double tolerance = maxError * norm ;
+      double best = 0., bestX = 0., bestY = 0., bestZ = 1. ;
+      // the largest bound of the cells dropped because of the tolerance
+      double droppedBound = 0. ;
+      _cells.clear() ;
+      for( std::size_t t=0 ; t<NThetaCells ; ++t ) {
+        for( std::size_t f=0 ; f<NPhiCells ; ++f ) {
+          Cell cell ;
+          cell._theta0 = 0.5 * Pi * t / NThetaCells ;
+          cell._theta1 = 0.5 * Pi * ( t+1 ) / NThetaCells ;
+          cell._phi0 = 2. * Pi * f / NPhiCells ;
+          cell._phi1 = 2. * Pi * ( f+1 ) / NPhiCells ;
+          cell._bound = cellBound( cell ) ;
+          _cells.push_back( cell ) ;
+        }
+      }
+      std::make_heap( _cells.begin(), _cells.end() ) ;
+      while( not _cells.empty() ) {
+        std::pop_heap( _cells.begin(), _cells.end() ) ;
+        const auto cell = _cells.back() ;
+        _cells.pop_back() ;
+        // the remaining cells have lower bounds
+        if( cell._bound <= best + tolerance ) {
+          droppedBound = std::max( droppedBound, cell._bound ) ;
+          break ;
+        }
+        const double theta = 0.5 * ( cell._theta0 + cell._theta1 ) ;
+        const double phi = 0.5 * ( cell._phi0 + cell._phi1 ) ;
+        double nx = std::sin( theta ) * std::cos( phi ), ny = std::sin( theta ) * std::sin( phi ), nz = std::cos( theta ) ;
+        const double value = improveAxis( nx, ny, nz ) ;
+        if( value > best ) {
+          best = value ;
+          bestX = nx ; bestY = ny ; bestZ = nz ;
+        }
+        if( cell._bound <= best + tolerance ) {
+          droppedBound = std::max( droppedBound, cell._bound ) ;
+          continue ;
+        }
+        for( std::size_t child=0 ; child<4 ; ++child ) {
+          Cell split = cell ;
+          ( child & 1 ? split._theta0 : split._theta1 ) = theta ;
+          ( child & 2 ? split._phi0 : split._phi1 ) = phi ;
+          split._bound = cellBound( split ) ;
+          if( split._bound <= best + tolerance ) {
+            droppedBound = std::max( droppedBound, split._bound ) ;
+            continue ;
+          }
+          _cells.push_back( split ) ;
+          std::push_heap( _cells.begin(), _cells.end() ) ;
+        }
+      }
+      return makeThrust( bestX * best, bestY * best, bestZ * best, norm, std::max( droppedBound - best, 0. ) / norm ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    MomentumTensor EventShapes::sphericityTensor( const kinematics::FourMomentumArray &particles ) {
+      const double *px = particles.px(), *py = particles.py(), *pz = particles.pz() ;
+      double xx = 0., yy = 0., zz = 0., xy = 0., xz = 0., yz = 0. ;
+      for( std::size_t i=0 ; i<particles.size() ; ++i ) {
+        xx += px[i]*px[i] ; yy += py[i]*py[i] ; zz += pz[i]*pz[i] ;
+        xy += px[i]*py[i] ; xz += px[i]*pz[i] ; yz += py[i]*pz[i] ;
+      }
+      return eigenvalues( xx, yy, zz, xy, xz, yz ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    MomentumTensor EventShapes::linearizedTensor( const kinematics::FourMomentumArray &particles ) {
+      setMomenta( particles ) ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data(), *p = _p.data() ;
+      double xx = 0., yy = 0., zz = 0., xy = 0., xz = 0., yz = 0. ;
+      for( std::size_t i=0 ; i<particles.size() ; ++i ) {
+        if( p[i] <= 0. ) {
+          continue ;
+        }
+        const double w = 1. / p[i] ;
+        xx += w*px[i]*px[i] ; yy += w*py[i]*py[i] ; zz += w*pz[i]*pz[i] ;
+        xy += w*px[i]*py[i] ; xz += w*px[i]*pz[i] ; yz += w*py[i]*pz[i] ;
+      }
+      return eigenvalues( xx, yy, zz, xy, xz, yz ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    const std::vector<double> &EventShapes::foxWolframMoments( const kinematics::FourMomentumArray &particles, std::size_t lmax ) {
+      const auto n = particles.size() ;
+      const auto nmoments = lmax+1 ;
+      _moments.assign( nmoments, 0. ) ;
+      double evis = 0. ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        evis += particles.e()[i] ;
+      }
+      if( 0 == n || evis <= 0. ) {
+        return _moments ;
+      }
+      setMomenta( particles ) ;
+      _legendreSums.assign( nmoments * n, 0. ) ;
+      for( auto array : { &_cosines, &_weights, &_previous, &_current } ) {
+        array->resize( n ) ;
+      }
+      const double *ux = _nx.data(), *uy = _ny.data(), *uz = _nz.data(), *p = _p.data() ;
+      double *x = _cosines.data(), *w = _weights.data(), *previous = _previous.data(), *current = _current.data() ;
+      double *sums = _legendreSums.data() ;
+      // pairs i < j: the Legendre terms are summed per particle j, for all the
+      // orders, so that the inner loops have no reduction and vectorize
+      for( std::size_t i=0 ; i+1<n ; ++i ) {
+        if( p[i] <= 0. ) {
+          continue ;
+        }
+        const double nx = ux[i], ny = uy[i], nz = uz[i], pi = p[i] ;
+        double *sums0 = sums ;
+        for( std::size_t j=i+1 ; j<n ; ++j ) {
+          x[j] = nx*ux[j] + ny*uy[j] + nz*uz[j] ;
+          w[j] = pi * p[j] ;
+          previous[j] = 1. ;
+          current[j] = x[j] ;
+          sums0[j] += w[j] ;
+        }
+        if( lmax < 1 ) {
+          continue ;
+        }
+        double *sums1 = sums + n ;
+        for( std::size_t j=i+1 ; j<n ; ++j ) {
+          sums1[j] += w[j] * x[j] ;
+        }
+        // (l+1) P_l+1 = (2l+1) x P_l - l P_l-1
+        for( std::size_t l=1 ; l<lmax ; ++l ) {
+          const double a = ( 2.*l + 1. ) / ( l + 1. ), b = l / ( l + 1. ) ;
+          double *next = sums + ( l+1 ) * n ;
+          for( std::size_t j=i+1 ; j<n ; ++j ) {
+            const double legendre = a * x[j] * current[j] - b * previous[j] ;
+            previous[j] = current[j] ;
+            current[j] = legendre ;
+            next[j] += w[j] * legendre ;
+          }
+        }
+      }
+      // diagonal terms, with P_l(1) = 1
+      double diagonal = 0. ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        diagonal += p[i]*p[i] ;
+      }
+      for( std::size_t l=0 ; l<nmoments ; ++l ) {
+        double offDiagonal = 0. ;
+        const double *sumsl = sums + l * n ;
+        for( std::size_t j=0 ; j<n ; ++j ) {
+          offDiagonal += sumsl[j] ;
+        }
+        _moments[l] = ( diagonal + 2. * offDiagonal ) / ( evis * evis ) ;
+      }
+      return _moments ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    double EventShapes::setMomenta( const kinematics::FourMomentumArray &particles ) {
+      const auto n = particles.size() ;
+      for( auto array : { &_px, &_py, &_pz, &_p, &_nx, &_ny, &_nz } ) {
+        array->resize( n ) ;
+      }
+      const double *inx = particles.px(), *iny = particles.py(), *inz = particles.pz() ;
+      double *px = _px.data(), *py = _py.data(), *pz = _pz.data(), *p = _p.data() ;
+      double *nx = _nx.data(), *ny = _ny.data(), *nz = _nz.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        px[i] = inx[i] ; py[i] = iny[i] ; pz[i] = inz[i] ;
+        p[i] = std::sqrt( px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i] ) ;
+        const double nullMomentum = ( 0. == p[i] ) ;
+        const double norm = 1. / ( p[i] + nullMomentum ) ;
+        nx[i] = px[i] * norm ; ny[i] = py[i] * norm ; nz[i] = pz[i] * norm ;
+      }
+      double sum = 0. ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        sum += p[i] ;
+      }
+      return sum ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    double EventShapes::projection( double nx, double ny, double nz ) {
+      const auto n = _p.size() ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data() ;
+      double *scratch = _scratch.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        scratch[i] = std::fabs( px[i]*nx + py[i]*ny + pz[i]*nz ) ;
+      }
+      double sum = 0. ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        sum += scratch[i] ;
+      }
+      return sum ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    double EventShapes::cellBound( const Cell &cell ) {
+      const double theta = 0.5 * ( cell._theta0 + cell._theta1 ) ;
+      const double phi = 0.5 * ( cell._phi0 + cell._phi1 ) ;
+      const double cx = std::sin( theta ) * std::cos( phi ), cy = std::sin( theta ) * std::sin( phi ), cz = std::cos( theta ) ;
+      // any axis of the cell is reached from the center along its parallel,
+      // then along its meridian: the cell is in the cap of this angular radius
+      const double radius = std::min( 0.5 * ( cell._theta1 - cell._theta0 ) + 0.5 * std::sin( theta ) * ( cell._phi1 - cell._phi0 ), 0.5 * Pi ) ;
+      const double cosRadius = std::cos( radius ), sinRadius = std::sin( radius ) ;
+      const auto n = _p.size() ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data(), *p = _p.data() ;
+      double *signs = _sides.data(), *scratch = _scratch.data() ;
+      // particles further than the radius from the plane orthogonal to the center
+      // keep their side in the cap: their sum d has the projection d.n. The others
+      // are bounded one by one: |p| sin( angle to the plane + radius )
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const double projection = px[i]*cx + py[i]*cy + pz[i]*cz ;
+        const double parallel = std::fabs( projection ) ;
+        const double perpendicular = std::sqrt( std::max( p[i]*p[i] - parallel*parallel, 0. ) ) ;
+        const bool fixed = ( parallel >= p[i] * sinRadius ) ;
+        signs[i] = fixed ? ( projection < 0. ? -1. : 1. ) : 0. ;
+        scratch[i] = fixed ? 0. : parallel * cosRadius + perpendicular * sinRadius ;
+      }
+      double dx = 0., dy = 0., dz = 0., bound = 0. ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        dx += signs[i] * px[i] ; dy += signs[i] * py[i] ; dz += signs[i] * pz[i] ;
+        bound += scratch[i] ;
+      }
+      // largest projection of d on the axes of the cap: |d| cos( max( angle - radius, 0 ) )
+      const double length = std::sqrt( dx*dx + dy*dy + dz*dz ) ;
+      const double parallel = dx*cx + dy*cy + dz*cz ;
+      if( parallel >= length * cosRadius ) {
+        return bound + length ;
+      }
+      const double perpendicular = std::sqrt( std::max( length*length - parallel*parallel, 0. ) ) ;
+      return bound + parallel * cosRadius + perpendicular * sinRadius ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    double EventShapes::improveAxis( double &nx, double &ny, double &nz ) {
+      const auto n = _p.size() ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data() ;
+      double value = projection( nx, ny, nz ) ;
+      double lastX = 0., lastY = 0., lastZ = 0. ;
+      for( std::size_t iteration=0 ; iteration<MaxIterations ; ++iteration ) {
+        double dx = 0., dy = 0., dz = 0. ;
+        for( std::size_t i=0 ; i<n ; ++i ) {
+          const double sign = ( px[i]*nx + py[i]*ny + pz[i]*nz ) < 0. ? -1. : 1. ;
+          dx += sign * px[i] ; dy += sign * py[i] ; dz += sign * pz[i] ;
+        }
+        // |d| = d.n' <= sum |p.n'| for the new axis n' = d / |d|
+        const double length = std::sqrt( dx*dx + dy*dy + dz*dz ) ;
+        if( length <= value ) {
+          break ;
+        }
+        value = length ;
+        nx = dx / length ; ny = dy / length ; nz = dz / length ;
+        if( dx == lastX && dy == lastY && dz == lastZ ) {
+          break ;
+        }
+        lastX = dx ; lastY = dy ; lastZ = dz ;
+      }
+      return value ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    MomentumTensor EventShapes::eigenvalues( double xx, double yy, double zz, double xy, double xz, double yz ) {
+      MomentumTensor tensor ;
+      const double trace = xx + yy + zz ;
+      if( trace <= 0. ) {
+        return tensor ;
+      }
+      xx /= trace ; yy /= trace ; zz /= trace ;
+      xy /= trace ; xz /= trace ; yz /= trace ;
+      // closed form eigenvalues of a symmetric 3x3 matrix
+      const double offDiagonal = xy*xy + xz*xz + yz*yz ;
+      const double q = 1. / 3. ;
+      const double p2 = ( xx-q )*( xx-q ) + ( yy-q )*( yy-q ) + ( zz-q )*( zz-q ) + 2. * offDiagonal ;
+      double lambda[3] = { xx, yy, zz } ;
+      if( p2 > 0. ) {
+        const double p = std::sqrt( p2 / 6. ) ;
+        const double bxx = ( xx-q ) / p, byy = ( yy-q ) / p, bzz = ( zz-q ) / p ;
+        const double bxy = xy / p, bxz = xz / p, byz = yz / p ;
+        const double determinant = bxx * ( byy*bzz - byz*byz ) - bxy * ( bxy*bzz - byz*bxz ) + bxz * ( bxy*byz - byy*bxz ) ;
+        const double angle = std::acos( std::min( std::max( 0.5 * determinant, -1. ), 1. ) ) / 3. ;
+        lambda[0] = q + 2. * p * std::cos( angle ) ;
+        lambda[2] = q + 2. * p * std::cos( angle + 2. * Pi / 3. ) ;
+        lambda[1] = 1. - lambda[0] - lambda[2] ;
+      }
+      std::sort( lambda, lambda+3 ) ;
+      tensor._lambda1 = lambda[2] ;
+      tensor._lambda2 = lambda[1] ;
+      tensor._lambda3 = std::max( lambda[0], 0. ) ;
+      return tensor ;
+    }
+
+  }
+
+}
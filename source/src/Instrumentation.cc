@@ -0,0 +1,168 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Instrumentation.h>
+
+// -- std headers
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lc_analysis {
+  
+  namespace instrumentation {
+    
+    namespace {
+      
+      class Registry ;
+      
+      /// Merge the data of all threads of the registry and write a report
+      void dumpRegistry( Registry &reg, std::ostream &out ) ;
+      
+      /**
+       *  @brief  Registry class
+       *
+       *  Owns the instrumentation data of all threads, so 
+       *  that they outlive the threads. Dumps the merged 
+       *  data at job end.
+       */
+      class Registry {
+      public:
+        ~Registry() {
+          const char *output = std::getenv( "LCANALYSISTOOLS_INSTRUMENTATION_OUTPUT" ) ;
+          if( nullptr != output ) {
+            std::ofstream file( output ) ;
+            if( file ) {
+              dumpRegistry( *this, file ) ;
+              return ;
+            }
+          }
+          dumpRegistry( *this, std::cerr ) ;
+        }
+        
+        std::mutex                                _mutex {} ;
+        std::vector<std::unique_ptr<ThreadData>>  _threads {} ;
+      };
+      
+      Registry &registry() {
+        static Registry reg ;
+        return reg ;
+      }
+      
+      /// Latency value at a given quantile, from a merged log2 histogram (upper bin edge)
+      uint64_t latencyQuantile( const std::array<uint64_t, NLatencyBins> &histogram, uint64_t total, double quantile ) {
+        uint64_t cumulated = 0 ;
+        for( std::size_t bin=0 ; bin<NLatencyBins ; ++bin ) {
+          cumulated += histogram[bin] ;
+          if( cumulated >= quantile * total ) {
+            return uint64_t(1) << ( bin + 1 ) ;
+          }
+        }
+        return uint64_t(1) << NLatencyBins ;
+      }
+      
+      void dumpRegistry( Registry &reg, std::ostream &out ) {
+        std::lock_guard<std::mutex> lock( reg._mutex ) ;
+        // merge all threads
+        std::array<uint64_t, NCounters> counters {} ;
+        std::array<std::array<uint64_t, NLatencyBins>, NCounters> latencies {} ;
+        std::unordered_map<int, uint64_t> misses ;
+        for( const auto &thread : reg._threads ) {
+          for( std::size_t c=0 ; c<NCounters ; ++c ) {
+            counters[c] += thread->_counters[c].load( std::memory_order_relaxed ) ;
+            for( std::size_t bin=0 ; bin<NLatencyBins ; ++bin ) {
+              latencies[c][bin] += thread->_latencies[c][bin].load( std::memory_order_relaxed ) ;
+            }
+          }
+          for( const auto &miss : thread->_misses ) {
+            misses[ miss.first ] += miss.second ;
+          }
+        }
+        out << "==== LCAnalysisTools instrumentation report (" << reg._threads.size() << " thread(s)) ====" << std::endl ;
+        out << std::left << std::setw(28) << "entry point" << std::right << std::setw(16) << "calls" 
+          << std::setw(12) << "samples" << std::setw(12) << "p50 [ns]" << std::setw(12) << "p90 [ns]" << std::setw(12) << "p99 [ns]" << std::endl ;
+        for( std::size_t c=0 ; c<NCounters ; ++c ) {
+          if( 0 == counters[c] ) {
+            continue ;
+          }
+          uint64_t samples = 0 ;
+          for( const auto entries : latencies[c] ) {
+            samples += entries ;
+          }
+          out << std::left << std::setw(28) << counterName( static_cast<Counter>( c ) ) << std::right 
+            << std::setw(16) << counters[c] << std::setw(12) << samples ;
+          if( samples > 0 ) {
+            out << std::setw(12) << latencyQuantile( latencies[c], samples, 0.5 )
+              << std::setw(12) << latencyQuantile( latencies[c], samples, 0.9 )
+              << std::setw(12) << latencyQuantile( latencies[c], samples, 0.99 ) ;
+          }
+          out << std::endl ;
+        }
+        if( not misses.empty() ) {
+          std::vector<std::pair<int, uint64_t>> sortedMisses( misses.begin(), misses.end() ) ;
+          std::sort( sortedMisses.begin(), sortedMisses.end(), []( const auto &lhs, const auto &rhs ) {
+            return ( lhs.second != rhs.second ) ? lhs.second > rhs.second : lhs.first < rhs.first ;
+          }) ;
+          out << "Unknown pdg ids (pdg: count):" << std::endl ;
+          for( const auto &miss : sortedMisses ) {
+            out << "  " << std::setw(12) << miss.first << ": " << miss.second << std::endl ;
+          }
+        }
+      }
+    }
+    
+    //--------------------------------------------------------------------------
+    
+    const char *counterName( Counter counter ) {
+      static const char *names[NCounters] = {
+        "particle", "particle (miss)", "isQuark", "isLepton", "isHadron", "isMeson", "isBaryon",
+        "isDiQuark", "isNucleus", "isPentaQuark", "isGaugeBosonOrHiggs", "isSMGaugeBosonOrHiggs",
+        "isGeneratorSpecific", "isSpecialParticle", "isRHadron", "isQBall", "isDyon", "isSUSY",
+        "isTechnicolor", "isCompositeQuarkOrLepton", "hasQuark", "hasFundamentalAnti" 
+      };
+      return names[ static_cast<std::size_t>( counter ) ] ;
+    }
+    
+    //--------------------------------------------------------------------------
+    
+    ThreadData *registerThread() {
+      auto &reg = registry() ;
+      std::lock_guard<std::mutex> lock( reg._mutex ) ;
+      reg._threads.push_back( std::make_unique<ThreadData>() ) ;
+      return reg._threads.back().get() ;
+    }
+    
+    //--------------------------------------------------------------------------
+    
+    void recordMiss( const EntryPoint &lookup, int pdg ) {
+      if( lookup.counted() ) {
+        auto &data = threadData() ;
+        count( data, Counter::ParticleMiss ) ;
+        ++data._misses[ pdg ] ;
+      }
+    }
+    
+    //--------------------------------------------------------------------------
+    
+    void recordLatency( Counter counter, uint64_t nanoseconds ) {
+      std::size_t bin = 0 ;
+      while( ( nanoseconds >> ( bin + 1 ) ) != 0 && bin+1 < NLatencyBins ) {
+        ++bin ;
+      }
+      auto &value = threadData()._latencies[ static_cast<std::size_t>( counter ) ][ bin ] ;
+      value.store( value.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed ) ;
+    }
+    
+    //--------------------------------------------------------------------------
+    
+    void dump( std::ostream &out ) {
+      dumpRegistry( registry(), out ) ;
+    }
+    
+  }
+  
+}
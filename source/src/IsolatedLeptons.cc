@@ -0,0 +1,202 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/IsolatedLeptons.h>
+
+// -- std headers
+#include <sstream>
+#include <stdexcept>
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    namespace {
+      constexpr double Pi = 3.141592653589793 ;
+      constexpr double TwoPi = 6.283185307179586 ;
+      /// Maximum number of bins in cos theta and in phi
+      constexpr double MaxBins = 256. ;
+      /// Angular margin of the bin ranges of a cone, against rounding
+      constexpr double Margin = 1e-9 ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    IsolatedLeptonFinder::IsolatedLeptonFinder( const std::vector<double> &cosConeAngles ) :
+      _cosConeAngles(cosConeAngles) {
+      if( _cosConeAngles.empty() ) {
+        throw std::runtime_error( "IsolatedLeptonFinder: no isolation cone" ) ;
+      }
+      for( std::size_t c=0 ; c<_cosConeAngles.size() ; ++c ) {
+        const double cosAngle = _cosConeAngles[c] ;
+        if( not ( cosAngle > 0. && cosAngle < 1. ) || ( c > 0 && cosAngle > _cosConeAngles[c-1] ) ) {
+          std::stringstream ss ; ss << "IsolatedLeptonFinder: invalid cone cosine " << cosAngle << ", expected in (0, 1) and in decreasing order" << std::endl ;
+          throw std::runtime_error( ss.str() ) ;
+        }
+      }
+      _maxConeAngle = std::acos( _cosConeAngles.back() ) ;
+      _sinMaxConeAngle = std::sin( _maxConeAngle ) ;
+      // bins about half as large as the largest cone (in angle, at the equator)
+      _nCosThetaBins = static_cast<std::size_t>( std::min( std::max( std::floor( 4. / _maxConeAngle ), 1. ), MaxBins ) ) ;
+      _nPhiBins = static_cast<std::size_t>( std::min( std::max( std::floor( 2. * TwoPi / _maxConeAngle ), 1. ), MaxBins ) ) ;
+      _cosThetaBinSize = 2. / _nCosThetaBins ;
+      _phiBinSize = 4. / _nPhiBins ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void IsolatedLeptonFinder::process( const EVENT::LCCollection *pfos ) {
+      _classification.classify( pfos ) ;
+      _momenta.fill( pfos ) ;
+      setParticles( _momenta ) ;
+      processCandidates( _momenta ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void IsolatedLeptonFinder::process( const kinematics::FourMomentumArray &particles, const std::vector<int> &types ) {
+      if( types.size() != particles.size() ) {
+        std::stringstream ss ; ss << "IsolatedLeptonFinder: " << types.size() << " types for " << particles.size() << " particles" << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      _classification.classify( types ) ;
+      setParticles( particles ) ;
+      processCandidates( particles ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void IsolatedLeptonFinder::setParticles( const kinematics::FourMomentumArray &particles ) {
+      const auto nparticles = particles.size() ;
+      const double *px = particles.px(), *py = particles.py(), *pz = particles.pz() ;
+      _ux.resize( nparticles ) ;
+      _uy.resize( nparticles ) ;
+      _uz.resize( nparticles ) ;
+      _bins.resize( nparticles ) ;
+      double *ux = _ux.data(), *uy = _uy.data(), *uz = _uz.data() ;
+      for( std::size_t i=0 ; i<nparticles ; ++i ) {
+        const double pmag = std::sqrt( px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i] ) ;
+        // null momenta get a null direction: never in a cone
+        const double nullMomentum = ( 0. == pmag ) ;
+        const double norm = 1. / ( pmag + nullMomentum ) ;
+        ux[i] = px[i] * norm ;
+        uy[i] = py[i] * norm ;
+        uz[i] = pz[i] * norm ;
+      }
+      const long lastCosThetaBin = static_cast<long>( _nCosThetaBins ) - 1 ;
+      uint32_t *bins = _bins.data() ;
+      for( std::size_t i=0 ; i<nparticles ; ++i ) {
+        const long ic = std::min( std::max( cosThetaBin( uz[i] ), 0L ), lastCosThetaBin ) ;
+        bins[i] = static_cast<uint32_t>( ic * _nPhiBins + phiBin( ux[i], uy[i] ) ) ;
+      }
+      // count the particles per bin, then fill the bins at their offsets
+      _binOffsets.assign( _nCosThetaBins * _nPhiBins + 1, 0 ) ;
+      for( std::size_t i=0 ; i<nparticles ; ++i ) {
+        ++_binOffsets[ bins[i] + 1 ] ;
+      }
+      for( std::size_t b=1 ; b<_binOffsets.size() ; ++b ) {
+        _binOffsets[b] += _binOffsets[b-1] ;
+      }
+      _positions.assign( _binOffsets.begin(), _binOffsets.end() - 1 ) ;
+      _x.resize( nparticles ) ;
+      _y.resize( nparticles ) ;
+      _z.resize( nparticles ) ;
+      _e.resize( nparticles ) ;
+      _indices.resize( nparticles ) ;
+      const double *e = particles.e() ;
+      for( std::size_t i=0 ; i<nparticles ; ++i ) {
+        const auto k = _positions[ bins[i] ]++ ;
+        _x[k] = ux[i] ;
+        _y[k] = uy[i] ;
+        _z[k] = uz[i] ;
+        _e[k] = e[i] ;
+        _indices[k] = static_cast<uint32_t>( i ) ;
+      }
+      _candidates.clear() ;
+      _candidateEnergies.clear() ;
+      _coneEnergies.clear() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void IsolatedLeptonFinder::coneEnergies( double x, double y, double z, uint32_t excluded, double *energies ) const {
+      const auto ncones = _cosConeAngles.size() ;
+      std::fill( energies, energies + ncones, 0. ) ;
+      if( _binOffsets.empty() ) {
+        return ;
+      }
+      // the cos theta rows crossed by the largest cone
+      const double theta = std::acos( std::min( std::max( z, -1. ), 1. ) ) ;
+      const double minTheta = theta - _maxConeAngle - Margin ;
+      const double maxTheta = theta + _maxConeAngle + Margin ;
+      const double minCosTheta = maxTheta < Pi ? std::cos( maxTheta ) : -1. ;
+      const double maxCosTheta = minTheta > 0. ? std::cos( minTheta ) : 1. ;
+      const long firstRow = std::max( cosThetaBin( minCosTheta ), 0L ) ;
+      const long lastRow = std::min( cosThetaBin( maxCosTheta ), static_cast<long>( _nCosThetaBins ) - 1 ) ;
+      // the phi range of the cone: all phi if it contains a pole, else
+      // phi0 +- asin( sin alpha / sin theta0 ), from the pseudo-angles of its ends
+      const double rho = std::sqrt( x*x + y*y ) ;
+      const bool allPhi = ( minTheta <= 0. || maxTheta >= Pi || _sinMaxConeAngle >= rho ) ;
+      long firstPhi = 0, lastPhi = 0 ;
+      if( not allPhi ) {
+        const double deltaPhi = std::asin( _sinMaxConeAngle / rho ) + Margin ;
+        const double c = std::cos( deltaPhi ), s = std::sin( deltaPhi ) ;
+        firstPhi = phiBin( x*c + y*s, y*c - x*s ) ;
+        lastPhi = phiBin( x*c - y*s, y*c + x*s ) ;
+      }
+      const long nphi = static_cast<long>( _nPhiBins ) ;
+      if( allPhi ) {
+        // the rows are contiguous
+        addEnergies( x, y, z, excluded, _binOffsets[ firstRow * nphi ], _binOffsets[ ( lastRow + 1 ) * nphi ], energies ) ;
+      }
+      else {
+        for( long row=firstRow ; row<=lastRow ; ++row ) {
+          const long first = row * nphi ;
+          if( lastPhi < firstPhi ) {
+            // the phi range wraps around. It spans less than pi and there are
+            // at least 8 phi bins (cones below pi/2): it cannot end in its first bin
+            addEnergies( x, y, z, excluded, _binOffsets[ first + firstPhi ], _binOffsets[ first + nphi ], energies ) ;
+            addEnergies( x, y, z, excluded, _binOffsets[ first ], _binOffsets[ first + lastPhi + 1 ], energies ) ;
+          }
+          else {
+            addEnergies( x, y, z, excluded, _binOffsets[ first + firstPhi ], _binOffsets[ first + lastPhi + 1 ], energies ) ;
+          }
+        }
+      }
+      // each energy was added to the smallest cone containing it only
+      for( std::size_t c=1 ; c<ncones ; ++c ) {
+        energies[c] += energies[c-1] ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void IsolatedLeptonFinder::isolated( std::size_t cone, double minEnergy, double maxConeEnergyFraction, std::vector<uint32_t> &indices ) const {
+      indices.clear() ;
+      for( std::size_t c=0 ; c<_candidates.size() ; ++c ) {
+        const double energy = _candidateEnergies[c] ;
+        if( energy >= minEnergy && coneEnergy( c, cone ) <= maxConeEnergyFraction * energy ) {
+          indices.push_back( _candidates[c] ) ;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void IsolatedLeptonFinder::processCandidates( const kinematics::FourMomentumArray &particles ) {
+      _classification.select( pfo::ChargedLeptonBit, _candidates ) ;
+      const auto ncones = _cosConeAngles.size() ;
+      _candidateEnergies.resize( _candidates.size() ) ;
+      _coneEnergies.resize( _candidates.size() * ncones ) ;
+      for( std::size_t c=0 ; c<_candidates.size() ; ++c ) {
+        const auto p = particles.get( _candidates[c] ) ;
+        const double pmag = std::sqrt( p._px*p._px + p._py*p._py + p._pz*p._pz ) ;
+        const double nullMomentum = ( 0. == pmag ) ;
+        const double norm = 1. / ( pmag + nullMomentum ) ;
+        coneEnergies( p._px * norm, p._py * norm, p._pz * norm, _candidates[c], &_coneEnergies[ c * ncones ] ) ;
+        _candidateEnergies[c] = p._e ;
+      }
+    }
+
+  }
+
+}
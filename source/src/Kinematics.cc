@@ -0,0 +1,326 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Kinematics.h>
+#include <LCAnalysisTools/PDGIndex.h>
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCIO.h>
+#include <EVENT/MCParticle.h>
+#include <EVENT/ReconstructedParticle.h>
+
+// -- std headers
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace lc_analysis {
+
+  namespace kinematics {
+
+    double mass( int pdg ) {
+      const auto row = pdg::PDGIndex::instance().row( pdg ) ;
+      if( pdg::PDGIndex::NoRow == row || not pdg::pdgTable[row].hasMass() ) {
+        return 0. ;
+      }
+      return pdg::pdgTable[row].mass() * MeVToGeV ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void masses( const std::vector<int> &pdgs, std::vector<double> &masses ) {
+      // same direct mapped cache as PDGHelper::categories(): few distinct ids per batch
+      constexpr std::size_t cacheSize = 251 ;
+      struct CacheEntry {
+        int          _pdg {std::numeric_limits<int>::min()} ;
+        double       _mass {0.} ;
+      };
+      CacheEntry cache[cacheSize] ;
+      masses.resize( pdgs.size() ) ;
+      for( std::size_t i=0 ; i<pdgs.size() ; ++i ) {
+        const int pdg = pdgs[i] ;
+        auto &entry = cache[ static_cast<uint32_t>( pdg ) % cacheSize ] ;
+        if( entry._pdg != pdg ) {
+          entry._pdg = pdg ;
+          entry._mass = mass( pdg ) ;
+        }
+        masses[i] = entry._mass ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::fill( const EVENT::LCCollection *particles ) {
+      fillCollection( particles, nullptr, particles->getNumberOfElements() ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::fill( const EVENT::LCCollection *particles, const std::vector<uint32_t> &indices ) {
+      fillCollection( particles, indices.data(), indices.size() ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::clear() {
+      _px.clear() ;
+      _py.clear() ;
+      _pz.clear() ;
+      _e.clear() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::reserve( std::size_t n ) {
+      _px.reserve( n ) ;
+      _py.reserve( n ) ;
+      _pz.reserve( n ) ;
+      _e.reserve( n ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    FourMomentum FourMomentumArray::sum() const {
+      FourMomentum total ;
+      const auto n = size() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        total._px += _px[i] ;
+        total._py += _py[i] ;
+        total._pz += _pz[i] ;
+        total._e += _e[i] ;
+      }
+      return total ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    FourMomentum FourMomentumArray::sum( const std::vector<uint32_t> &indices ) const {
+      FourMomentum total ;
+      for( const auto i : indices ) {
+        total._px += _px[i] ;
+        total._py += _py[i] ;
+        total._pz += _pz[i] ;
+        total._e += _e[i] ;
+      }
+      return total ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::setMass( double m ) {
+      const auto n = size() ;
+      const double m2 = m*m ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data() ;
+      double *e = _e.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        e[i] = std::sqrt( px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i] + m2 ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::setMasses( const std::vector<double> &m ) {
+      if( m.size() != size() ) {
+        std::stringstream ss ; ss << "FourMomentumArray::setMasses: got " << m.size() << " masses for " << size() << " particles" << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      const auto n = size() ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data(), *mm = m.data() ;
+      double *e = _e.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        e[i] = std::sqrt( px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i] + mm[i]*mm[i] ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::setMassHypothesis( int pdg ) {
+      setMass( mass( pdg ) ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::setMassHypotheses( const std::vector<int> &pdgs ) {
+      kinematics::masses( pdgs, _masses ) ;
+      setMasses( _masses ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::boost( double bx, double by, double bz ) {
+      const double b2 = bx*bx + by*by + bz*bz ;
+      const double gamma = 1. / std::sqrt( 1. - b2 ) ;
+      const double gamma2 = b2 > 0. ? ( gamma - 1. ) / b2 : 0. ;
+      const auto n = size() ;
+      double *px = _px.data(), *py = _py.data(), *pz = _pz.data(), *e = _e.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const double bp = bx*px[i] + by*py[i] + bz*pz[i] ;
+        const double ei = e[i] ;
+        px[i] += gamma2*bp*bx + gamma*bx*ei ;
+        py[i] += gamma2*bp*by + gamma*by*ei ;
+        pz[i] += gamma2*bp*bz + gamma*bz*ei ;
+        e[i] = gamma * ( ei + bp ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::boostToRestFrame( const FourMomentum &frame ) {
+      boost( -frame._px/frame._e, -frame._py/frame._e, -frame._pz/frame._e ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::masses( std::vector<double> &out ) const {
+      const auto n = size() ;
+      out.resize( n ) ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data(), *e = _e.data() ;
+      double *o = out.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        o[i] = signedSqrt( e[i]*e[i] - px[i]*px[i] - py[i]*py[i] - pz[i]*pz[i] ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::momenta( std::vector<double> &out ) const {
+      const auto n = size() ;
+      out.resize( n ) ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data() ;
+      double *o = out.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        o[i] = std::sqrt( px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i] ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::transverseMomenta( std::vector<double> &out ) const {
+      const auto n = size() ;
+      out.resize( n ) ;
+      const double *px = _px.data(), *py = _py.data() ;
+      double *o = out.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        o[i] = std::sqrt( px[i]*px[i] + py[i]*py[i] ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::cosThetas( std::vector<double> &out ) const {
+      const auto n = size() ;
+      out.resize( n ) ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data() ;
+      double *o = out.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const double p = std::sqrt( px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i] ) ;
+        // arithmetic instead of a branch: null momenta give 0 / 1 + 1
+        const double nullMomentum = ( 0. == p ) ;
+        o[i] = pz[i] / ( p + nullMomentum ) + nullMomentum ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::phis( std::vector<double> &out ) const {
+      // atan2 has no SIMD version in the standard library: scalar loop
+      const auto n = size() ;
+      out.resize( n ) ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        out[i] = std::atan2( _py[i], _px[i] ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::cosAngles( const FourMomentum &axis, std::vector<double> &out ) const {
+      const auto n = size() ;
+      out.resize( n ) ;
+      const double axisP = axis.p() ;
+      const double ax = axisP > 0. ? axis._px / axisP : 0. ;
+      const double ay = axisP > 0. ? axis._py / axisP : 0. ;
+      const double az = axisP > 0. ? axis._pz / axisP : 1. ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data() ;
+      double *o = out.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const double p = std::sqrt( px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i] ) ;
+        const double dot = ax*px[i] + ay*py[i] + az*pz[i] ;
+        const double nullMomentum = ( 0. == p ) ;
+        o[i] = dot / ( p + nullMomentum ) + nullMomentum ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::recoilMasses( const FourMomentum &initial, std::vector<double> &out ) const {
+      const auto n = size() ;
+      out.resize( n ) ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data(), *e = _e.data() ;
+      double *o = out.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const double rx = initial._px - px[i] ;
+        const double ry = initial._py - py[i] ;
+        const double rz = initial._pz - pz[i] ;
+        const double re = initial._e - e[i] ;
+        o[i] = signedSqrt( re*re - rx*rx - ry*ry - rz*rz ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::pairMasses( const FourMomentumArray &other, std::vector<double> &out ) const {
+      if( other.size() != size() ) {
+        std::stringstream ss ; ss << "FourMomentumArray::pairMasses: arrays of different sizes (" << size() << ", " << other.size() << ")" << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      const auto n = size() ;
+      out.resize( n ) ;
+      const double *px = _px.data(), *py = _py.data(), *pz = _pz.data(), *e = _e.data() ;
+      const double *qx = other._px.data(), *qy = other._py.data(), *qz = other._pz.data(), *qe = other._e.data() ;
+      double *o = out.data() ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const double sx = px[i] + qx[i] ;
+        const double sy = py[i] + qy[i] ;
+        const double sz = pz[i] + qz[i] ;
+        const double se = e[i] + qe[i] ;
+        o[i] = signedSqrt( se*se - sx*sx - sy*sy - sz*sz ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    template <typename T>
+    void FourMomentumArray::fillElements( const EVENT::LCCollection *particles, const uint32_t *indices, std::size_t n ) {
+      _px.resize( n ) ;
+      _py.resize( n ) ;
+      _pz.resize( n ) ;
+      _e.resize( n ) ;
+      for( std::size_t i=0 ; i<n ; ++i ) {
+        const auto particle = static_cast<const T*>( particles->getElementAt( indices ? indices[i] : i ) ) ;
+        const double *momentum = particle->getMomentum() ;
+        _px[i] = momentum[0] ;
+        _py[i] = momentum[1] ;
+        _pz[i] = momentum[2] ;
+        _e[i] = particle->getEnergy() ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void FourMomentumArray::fillCollection( const EVENT::LCCollection *particles, const uint32_t *indices, std::size_t n ) {
+      const auto &type = particles->getTypeName() ;
+      if( EVENT::LCIO::MCPARTICLE == type ) {
+        fillElements<EVENT::MCParticle>( particles, indices, n ) ;
+      }
+      else if( EVENT::LCIO::RECONSTRUCTEDPARTICLE == type ) {
+        fillElements<EVENT::ReconstructedParticle>( particles, indices, n ) ;
+      }
+      else {
+        std::stringstream ss ; ss << "FourMomentumArray::fill: unsupported collection type " << type << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+    }
+
+  }
+
+}
@@ -0,0 +1,136 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/PDGHelper.h>
+#include <LCAnalysisTools/PDGIndex.h>
+
+// -- std headers
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// -- unix headers
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace lc_analysis {
+  
+  namespace pdg {
+    
+    namespace {
+      
+      /// Find the name of the mapping holding an address in /proc/self/maps
+      std::string findMapping( const void *address ) {
+        std::ifstream maps( "/proc/self/maps" ) ;
+        const auto addr = reinterpret_cast<uintptr_t>( address ) ;
+        std::string line ;
+        while( std::getline( maps, line ) ) {
+          unsigned long begin(0), end(0) ;
+          if( std::sscanf( line.c_str(), "%lx-%lx", &begin, &end ) != 2 ) {
+            continue ;
+          }
+          if( addr < begin || addr >= end ) {
+            continue ;
+          }
+          // the path is the 6th field, if any
+          std::istringstream fields( line ) ;
+          std::string field, path ;
+          for( int f=0 ; f<5 ; ++f ) {
+            fields >> field ;
+          }
+          fields >> path ;
+          return path.empty() ? "[anonymous]" : path ;
+        }
+        return "" ;
+      }
+      
+      /// Measure the resident and shared bytes of an address 
+      /// range using /proc/self/pagemap. Returns false if not available
+      bool measureResidency( const void *begin, std::size_t size, std::size_t &resident, std::size_t &shared ) {
+        // page flags in pagemap entries
+        constexpr uint64_t pagePresent = uint64_t(1) << 63 ;
+        constexpr uint64_t pageExclusive = uint64_t(1) << 56 ;
+        const int fd = ::open( "/proc/self/pagemap", O_RDONLY ) ;
+        if( fd < 0 ) {
+          return false ;
+        }
+        const auto pageSize = static_cast<uintptr_t>( ::sysconf( _SC_PAGESIZE ) ) ;
+        const auto first = reinterpret_cast<uintptr_t>( begin ) / pageSize ;
+        const auto last = ( reinterpret_cast<uintptr_t>( begin ) + size + pageSize - 1 ) / pageSize ;
+        bool success = true ;
+        for( auto page = first ; page < last ; ++page ) {
+          uint64_t entry = 0 ;
+          if( ::pread( fd, &entry, sizeof(entry), page * sizeof(entry) ) != sizeof(entry) ) {
+            success = false ;
+            break ;
+          }
+          if( entry & pagePresent ) {
+            resident += pageSize ;
+            if( not ( entry & pageExclusive ) ) {
+              shared += pageSize ;
+            }
+          }
+        }
+        ::close( fd ) ;
+        return success ;
+      }
+    }
+    
+    //----------------------------------------------------------------------------
+    
+    MemoryReport PDGHelper::memoryReport() {
+      using Data = ParticleData::Data ;
+      MemoryReport report ;
+      report._records = pdgTable.size() ;
+      report._recordBytes = pdgTable.capacity() * sizeof(ParticleData) ;
+      // 7 optional floats and 2 optional ints per record
+      constexpr std::size_t optionalBytes = 7 * sizeof(std::optional<float>) + 2 * sizeof(std::optional<int>) ;
+      constexpr std::size_t optionalValueBytes = 7 * sizeof(float) + 2 * sizeof(int) ;
+      static_assert( sizeof(Data) >= optionalBytes, "Unexpected particle record layout" ) ;
+      report._optionalBytes = pdgTable.size() * optionalBytes ;
+      report._optionalOverheadBytes = pdgTable.size() * ( optionalBytes - optionalValueBytes ) ;
+      const auto smallBufferCapacity = std::string().capacity() ;
+      for( const auto &particle : pdgTable ) {
+        const auto capacity = particle._data._name.capacity() ;
+        if( capacity > smallBufferCapacity ) {
+          report._nameHeapBytes += capacity + 1 ;
+        }
+      }
+      report._indexBytes = PDGIndex::instance().memoryBytes() ;
+      if( not pdgTable.empty() ) {
+        report._mapping = findMapping( pdgTable.data() ) ;
+        report._fileMapped = ( not report._mapping.empty() && report._mapping[0] == '/' ) ;
+        report._residencyAvailable = measureResidency( pdgTable.data(), report._recordBytes, report._residentBytes, report._sharedBytes ) ;
+      }
+      return report ;
+    }
+    
+    //----------------------------------------------------------------------------
+    
+    std::ostream &operator<<( std::ostream &out, const MemoryReport &report ) {
+      auto kiB = []( std::size_t bytes ) {
+        std::ostringstream ss ; ss << std::fixed << std::setprecision(1) << ( bytes / 1024. ) << " kiB" ;
+        return ss.str() ;
+      };
+      out << "PDG table memory report:" << std::endl ;
+      out << "  records:             " << report._records << std::endl ;
+      out << "  record bytes:        " << kiB( report._recordBytes ) << " (" << ( report._records ? report._recordBytes / report._records : 0 ) << " bytes/record)" << std::endl ;
+      out << "    optional fields:   " << kiB( report._optionalBytes ) << " (flags and padding: " << kiB( report._optionalOverheadBytes ) << ")" << std::endl ;
+      out << "  name heap bytes:     " << kiB( report._nameHeapBytes ) << std::endl ;
+      out << "  index bytes:         " << kiB( report._indexBytes ) << std::endl ;
+      out << "  total:               " << kiB( report.totalBytes() ) << std::endl ;
+      out << "  records mapping:     " << report._mapping << ( report._fileMapped ? " (file mapped)" : " (not file mapped)" ) << std::endl ;
+      if( report._residencyAvailable ) {
+        out << "  records resident:    " << kiB( report._residentBytes ) << std::endl ;
+        out << "  records shared:      " << kiB( report._sharedBytes ) << std::endl ;
+      }
+      else {
+        out << "  records resident:    not available" << std::endl ;
+      }
+      return out ;
+    }
+    
+  }
+  
+}
@@ -0,0 +1,267 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/OverlayRemoval.h>
+
+// -- std headers
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    namespace {
+      /// No pseudo-jet: end of the tile lists, no nearest neighbour, not merged
+      constexpr uint32_t NoJet = std::numeric_limits<uint32_t>::max() ;
+      /// The parent of the pseudo-jets merged with the beam
+      constexpr uint32_t BeamJet = NoJet - 1 ;
+      /// The rapidity of particles along the beam axis (pT = 0)
+      constexpr double BeamRapidity = 1e5 ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    OverlayRemoval::OverlayRemoval( double R, std::size_t njets ) :
+      _R2(R*R),
+      _njets(njets) {
+      if( not ( R > 0. ) ) {
+        std::stringstream ss ; ss << "OverlayRemoval: invalid kt radius " << R << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      // tiles at least as large as R, so that the neighbours closer than R are in the next tiles
+      _nRapidityTiles = std::max<std::size_t>( static_cast<std::size_t>( 2. * MaxRapidity / R ), 1 ) ;
+      _nPhiTiles = std::max<std::size_t>( static_cast<std::size_t>( TwoPi / R ), 1 ) ;
+      _rapidityTileSize = 2. * MaxRapidity / _nRapidityTiles ;
+      _phiTileSize = TwoPi / _nPhiTiles ;
+      _minRapidity = -MaxRapidity ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void OverlayRemoval::process( const EVENT::LCCollection *pfos ) {
+      _momenta.fill( pfos ) ;
+      process( _momenta ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void OverlayRemoval::process( const kinematics::FourMomentumArray &particles ) {
+      const auto nparticles = particles.size() ;
+      // all the pseudo-jets of the history, so that addJet never reallocates
+      _pseudoJets.clear() ;
+      _pseudoJets.reserve( 2 * nparticles ) ;
+      _parents.clear() ;
+      _parents.reserve( 2 * nparticles ) ;
+      _tileHeads.assign( _nRapidityTiles * _nPhiTiles, NoJet ) ;
+      _heap.clear() ;
+      _nactive = 0 ;
+      for( std::size_t i=0 ; i<nparticles ; ++i ) {
+        const auto p = particles.get( i ) ;
+        addJet( p._px, p._py, p._pz, p._e ) ;
+      }
+      if( _nactive > _njets ) {
+        for( std::size_t i=0 ; i<nparticles ; ++i ) {
+          findNeighbour( static_cast<uint32_t>( i ) ) ;
+          pushDistance( static_cast<uint32_t>( i ) ) ;
+        }
+      }
+      while( _nactive > _njets && not _heap.empty() ) {
+        std::pop_heap( _heap.begin(), _heap.end() ) ;
+        const auto entry = _heap.back() ;
+        _heap.pop_back() ;
+        if( not _pseudoJets[entry._jet]._active || _pseudoJets[entry._jet]._version != entry._version ) {
+          continue ;
+        }
+        const uint32_t a = entry._jet ;
+        const uint32_t b = _pseudoJets[a]._neighbour ;
+        _tiles.clear() ;
+        addNeighbourTiles( _pseudoJets[a]._tile ) ;
+        uint32_t merged = NoJet ;
+        removeJet( a ) ;
+        if( NoJet == b ) {
+          _parents[a] = BeamJet ;
+        }
+        else {
+          addNeighbourTiles( _pseudoJets[b]._tile ) ;
+          removeJet( b ) ;
+          const auto &ja = _pseudoJets[a], &jb = _pseudoJets[b] ;
+          merged = addJet( ja._px + jb._px, ja._py + jb._py, ja._pz + jb._pz, ja._e + jb._e ) ;
+          _parents[a] = merged ;
+          _parents[b] = merged ;
+          addNeighbourTiles( _pseudoJets[merged]._tile ) ;
+          findNeighbour( merged ) ;
+          pushDistance( merged ) ;
+        }
+        // only the pseudo-jets around the merged pair can have a new nearest neighbour
+        for( const auto tile : _tiles ) {
+          for( uint32_t k=_tileHeads[tile] ; NoJet != k ; k=_pseudoJets[k]._next ) {
+            if( k == merged ) {
+              continue ;
+            }
+            auto &jet = _pseudoJets[k] ;
+            if( jet._neighbour == a || ( NoJet != b && jet._neighbour == b ) ) {
+              findNeighbour( k ) ;
+              pushDistance( k ) ;
+            }
+            else if( NoJet != merged ) {
+              const double dr2 = deltaR2( jet, _pseudoJets[merged] ) ;
+              if( dr2 < jet._dr2 ) {
+                jet._neighbour = merged ;
+                jet._dr2 = dr2 ;
+                pushDistance( k ) ;
+              }
+            }
+          }
+        }
+      }
+      // parents have higher indices than their children: one pass in decreasing order
+      _labels.assign( _pseudoJets.size(), 0 ) ;
+      _jets.clear() ;
+      for( std::size_t c=_pseudoJets.size() ; c>0 ; --c ) {
+        const auto parent = _parents[c-1] ;
+        if( NoJet == parent ) {
+          _labels[c-1] = 1 ;
+        }
+        else if( BeamJet != parent ) {
+          _labels[c-1] = _labels[parent] ;
+        }
+      }
+      for( const auto &jet : _pseudoJets ) {
+        if( jet._active ) {
+          _jets.push_back( jet._px, jet._py, jet._pz, jet._e ) ;
+        }
+      }
+      _kept.clear() ;
+      _removed.clear() ;
+      for( std::size_t i=0 ; i<nparticles ; ++i ) {
+        ( _labels[i] ? _kept : _removed ).push_back( static_cast<uint32_t>( i ) ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    uint32_t OverlayRemoval::addJet( double px, double py, double pz, double e ) {
+      const auto index = static_cast<uint32_t>( _pseudoJets.size() ) ;
+      _pseudoJets.emplace_back() ;
+      _parents.push_back( NoJet ) ;
+      auto &jet = _pseudoJets.back() ;
+      jet._px = px ; jet._py = py ; jet._pz = pz ; jet._e = e ;
+      jet._pt2 = px*px + py*py ;
+      // massless treatment of unphysical (m^2 < 0) momenta, as in FastJet
+      const double mt2 = jet._pt2 + std::max( e*e - jet._pt2 - pz*pz, 0. ) ;
+      const double eplus = e + std::fabs( pz ) ;
+      double rapidity = BeamRapidity ;
+      if( mt2 > 0. && eplus > 0. ) {
+        rapidity = std::min( 0.5 * std::log( eplus*eplus / mt2 ), BeamRapidity ) ;
+      }
+      jet._rapidity = pz < 0. ? -rapidity : rapidity ;
+      double phi = std::atan2( py, px ) ;
+      if( phi < 0. ) {
+        phi += TwoPi ;
+      }
+      jet._phi = phi < TwoPi ? phi : 0. ;
+      jet._neighbour = NoJet ;
+      jet._dr2 = _R2 ;
+      jet._active = true ;
+      jet._tile = tileIndex( jet._rapidity, jet._phi ) ;
+      jet._previous = NoJet ;
+      jet._next = _tileHeads[jet._tile] ;
+      if( NoJet != jet._next ) {
+        _pseudoJets[jet._next]._previous = index ;
+      }
+      _tileHeads[jet._tile] = index ;
+      ++_nactive ;
+      return index ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void OverlayRemoval::removeJet( uint32_t index ) {
+      auto &jet = _pseudoJets[index] ;
+      if( NoJet != jet._previous ) {
+        _pseudoJets[jet._previous]._next = jet._next ;
+      }
+      else {
+        _tileHeads[jet._tile] = jet._next ;
+      }
+      if( NoJet != jet._next ) {
+        _pseudoJets[jet._next]._previous = jet._previous ;
+      }
+      jet._active = false ;
+      --_nactive ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t OverlayRemoval::neighbourTiles( uint32_t tile, uint32_t *tiles ) const {
+      const std::size_t iy = tile / _nPhiTiles, iphi = tile % _nPhiTiles ;
+      const std::size_t firstY = iy > 0 ? iy-1 : 0, lastY = std::min( iy+1, _nRapidityTiles-1 ) ;
+      std::size_t n = 0 ;
+      for( std::size_t y=firstY ; y<=lastY ; ++y ) {
+        if( _nPhiTiles <= 3 ) {
+          for( std::size_t phi=0 ; phi<_nPhiTiles ; ++phi ) {
+            tiles[n++] = static_cast<uint32_t>( y * _nPhiTiles + phi ) ;
+          }
+        }
+        else {
+          // phi tiles wrap around
+          const std::size_t previous = ( iphi + _nPhiTiles - 1 ) % _nPhiTiles, next = ( iphi + 1 ) % _nPhiTiles ;
+          tiles[n++] = static_cast<uint32_t>( y * _nPhiTiles + previous ) ;
+          tiles[n++] = static_cast<uint32_t>( y * _nPhiTiles + iphi ) ;
+          tiles[n++] = static_cast<uint32_t>( y * _nPhiTiles + next ) ;
+        }
+      }
+      return n ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void OverlayRemoval::addNeighbourTiles( uint32_t tile ) {
+      uint32_t tiles[9] ;
+      const auto n = neighbourTiles( tile, tiles ) ;
+      for( std::size_t t=0 ; t<n ; ++t ) {
+        if( _tiles.end() == std::find( _tiles.begin(), _tiles.end(), tiles[t] ) ) {
+          _tiles.push_back( tiles[t] ) ;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void OverlayRemoval::findNeighbour( uint32_t index ) {
+      auto &jet = _pseudoJets[index] ;
+      uint32_t tiles[9] ;
+      const auto n = neighbourTiles( jet._tile, tiles ) ;
+      uint32_t neighbour = NoJet ;
+      double dr2 = _R2 ;
+      for( std::size_t t=0 ; t<n ; ++t ) {
+        for( uint32_t k=_tileHeads[tiles[t]] ; NoJet != k ; k=_pseudoJets[k]._next ) {
+          if( k == index ) {
+            continue ;
+          }
+          const double d = deltaR2( jet, _pseudoJets[k] ) ;
+          if( d < dr2 ) {
+            dr2 = d ;
+            neighbour = k ;
+          }
+        }
+      }
+      jet._neighbour = neighbour ;
+      jet._dr2 = dr2 ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void OverlayRemoval::pushDistance( uint32_t index ) {
+      auto &jet = _pseudoJets[index] ;
+      ++jet._version ;
+      // beam distance if no neighbour closer than R, as then dr2 = R^2
+      const double pt2 = ( NoJet == jet._neighbour ) ? jet._pt2 : std::min( jet._pt2, _pseudoJets[jet._neighbour]._pt2 ) ;
+      _heap.push_back( HeapEntry{ pt2 * jet._dr2 / _R2, index, jet._version } ) ;
+      std::push_heap( _heap.begin(), _heap.end() ) ;
+    }
+
+  }
+
+}
@@ -0,0 +1,123 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/Instrumentation.h>
+#include <LCAnalysisTools/PDGIndex.h>
+
+// -- std headers
+#include <algorithm>
+#include <numeric>
+
+namespace lc_analysis {
+
+  namespace pdg {
+
+    namespace category {
+
+      const char *name( std::size_t bit ) {
+        static constexpr const char *names[NCategories] = {
+          "Known", "Quark", "Lepton", "Hadron", "Meson", "Baryon", "DiQuark", "Nucleus",
+          "PentaQuark", "GaugeBosonOrHiggs", "SMGaugeBosonOrHiggs", "GeneratorSpecific",
+          "SpecialParticle", "RHadron", "QBall", "Dyon", "SUSY", "Technicolor",
+          "CompositeQuarkOrLepton", "FundamentalAnti", "HasU", "HasD", "HasS", "HasC",
+          "HasB", "HasT", "Charged"
+        };
+        return ( bit < NCategories ) ? names[bit] : "Unknown" ;
+      }
+
+    }
+
+    //----------------------------------------------------------------------------
+
+    const PDGIndex &PDGIndex::instance() {
+      static const PDGIndex index ;
+      return index ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t PDGIndex::memoryBytes() const {
+      return sizeof(PDGIndex)
+        + _sortedPdgs.capacity() * sizeof(int)
+        + _sortedRows.capacity() * sizeof(Row)
+        + _categories.capacity() * sizeof(Categories)
+        + _nameSortedRows.capacity() * sizeof(Row) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    PDGIndex::Row PDGIndex::rowFromName( const std::string &name ) const {
+      auto iter = std::lower_bound( _nameSortedRows.begin(), _nameSortedRows.end(), name, []( Row r, const std::string &n ) {
+        return pdgTable[r].name() < n ;
+      }) ;
+      return ( _nameSortedRows.end() != iter && pdgTable[*iter].name() == name ) ? *iter : NoRow ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    PDGIndex::PDGIndex() {
+      // the categories are computed with the instrumented predicates
+      LCANALYSISTOOLS_SUSPEND_COUNTING() ;
+      const auto nrows = pdgTable.size() ;
+      std::vector<Row> rows( nrows ) ;
+      std::iota( rows.begin(), rows.end(), 0 ) ;
+      std::stable_sort( rows.begin(), rows.end(), []( Row lhs, Row rhs ) {
+        return pdgTable[lhs].pdg() < pdgTable[rhs].pdg() ;
+      }) ;
+      // keep the first row in case of duplicated pdg ids
+      rows.erase( std::unique( rows.begin(), rows.end(), []( Row lhs, Row rhs ) {
+        return pdgTable[lhs].pdg() == pdgTable[rhs].pdg() ;
+      }), rows.end() ) ;
+      _sortedPdgs.reserve( rows.size() ) ;
+      for( const auto r : rows ) {
+        _sortedPdgs.push_back( pdgTable[r].pdg() ) ;
+      }
+      _sortedRows = std::move( rows ) ;
+      _nameSortedRows.resize( nrows ) ;
+      std::iota( _nameSortedRows.begin(), _nameSortedRows.end(), 0 ) ;
+      std::stable_sort( _nameSortedRows.begin(), _nameSortedRows.end(), []( Row lhs, Row rhs ) {
+        return pdgTable[lhs].name() < pdgTable[rhs].name() ;
+      }) ;
+      _categories.reserve( nrows ) ;
+      for( const auto &particle : pdgTable ) {
+        _categories.push_back( computeCategories( particle ) ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    Categories PDGIndex::computeCategories( const ParticleData &p ) {
+      auto flag = []( bool set, Categories c ) {
+        return set ? c : Categories(0) ;
+      };
+      return category::Known
+        | flag( PDGHelper::isQuark( p ), category::Quark )
+        | flag( PDGHelper::isLepton( p ), category::Lepton )
+        | flag( PDGHelper::isHadron( p ), category::Hadron )
+        | flag( PDGHelper::isMeson( p ), category::Meson )
+        | flag( PDGHelper::isBaryon( p ), category::Baryon )
+        | flag( PDGHelper::isDiQuark( p ), category::DiQuark )
+        | flag( PDGHelper::isNucleus( p ), category::Nucleus )
+        | flag( PDGHelper::isPentaQuark( p ), category::PentaQuark )
+        | flag( PDGHelper::isGaugeBosonOrHiggs( p ), category::GaugeBosonOrHiggs )
+        | flag( PDGHelper::isSMGaugeBosonOrHiggs( p ), category::SMGaugeBosonOrHiggs )
+        | flag( PDGHelper::isGeneratorSpecific( p ), category::GeneratorSpecific )
+        | flag( PDGHelper::isSpecialParticle( p ), category::SpecialParticle )
+        | flag( PDGHelper::isRHadron( p ), category::RHadron )
+        | flag( PDGHelper::isQBall( p ), category::QBall )
+        | flag( PDGHelper::isDyon( p ), category::Dyon )
+        | flag( PDGHelper::isSUSY( p ), category::SUSY )
+        | flag( PDGHelper::isTechnicolor( p ), category::Technicolor )
+        | flag( PDGHelper::isCompositeQuarkOrLepton( p ), category::CompositeQuarkOrLepton )
+        | flag( PDGHelper::hasFundamentalAnti( p ), category::FundamentalAnti )
+        | flag( PDGHelper::hasQuark<Quark::u>( p ), category::HasU )
+        | flag( PDGHelper::hasQuark<Quark::d>( p ), category::HasD )
+        | flag( PDGHelper::hasQuark<Quark::s>( p ), category::HasS )
+        | flag( PDGHelper::hasQuark<Quark::c>( p ), category::HasC )
+        | flag( PDGHelper::hasQuark<Quark::b>( p ), category::HasB )
+        | flag( PDGHelper::hasQuark<Quark::t>( p ), category::HasT )
+        | flag( 0 != p.threeCharge(), category::Charged ) ;
+    }
+
+  }
+
+}
@@ -0,0 +1,86 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/PFOClassification.h>
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+#include <EVENT/ReconstructedParticle.h>
+
+// -- std headers
+#include <algorithm>
+
+namespace lc_analysis {
+
+  namespace reco {
+
+    void PFOClassification::classify( const EVENT::LCCollection *pfos ) {
+      const std::size_t npfos = pfos->getNumberOfElements() ;
+      _types.resize( npfos ) ;
+      for( std::size_t i=0 ; i<npfos ; ++i ) {
+        _types[i] = static_cast<const EVENT::ReconstructedParticle*>( pfos->getElementAt( i ) )->getType() ;
+      }
+      classifyTypes() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void PFOClassification::classify( const std::vector<int> &types ) {
+      _types.assign( types.begin(), types.end() ) ;
+      classifyTypes() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void PFOClassification::select( SelectionMask mask, std::vector<uint32_t> &indices ) const {
+      indices.clear() ;
+      for( std::size_t i=0 ; i<_selections.size() ; ++i ) {
+        if( ( _selections[i] & mask ) == mask ) {
+          indices.push_back( static_cast<uint32_t>( i ) ) ;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void PFOClassification::select( const PFOSelection &selection, std::vector<uint32_t> &indices ) const {
+      indices.clear() ;
+      for( std::size_t i=0 ; i<_categories.size() ; ++i ) {
+        if( selection.matches( _categories[i] ) ) {
+          indices.push_back( static_cast<uint32_t>( i ) ) ;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t PFOClassification::count( SelectionMask mask ) const {
+      std::size_t n = 0 ;
+      for( const auto selection : _selections ) {
+        n += ( ( selection & mask ) == mask ) ? 1 : 0 ;
+      }
+      return n ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void PFOClassification::classifyTypes() {
+      const auto npfos = _types.size() ;
+      _categories.resize( npfos ) ;
+      _selections.resize( npfos ) ;
+      pdg::PDGHelper::categories( _types.data(), _categories.data(), npfos ) ;
+      // branchless, vectorizable: one pass per selection
+      std::fill( _selections.begin(), _selections.end(), 0 ) ;
+      for( std::size_t s=0 ; s<pfo::NSelections ; ++s ) {
+        const auto required = pfo::Selections[s]._requiredCategories ;
+        const auto vetoed = pfo::Selections[s]._vetoedCategories ;
+        const SelectionMask bit = 1u << s ;
+        for( std::size_t i=0 ; i<npfos ; ++i ) {
+          const auto c = _categories[i] ;
+          _selections[i] |= ( ( c & required ) == required && 0 == ( c & vetoed ) ) ? bit : 0 ;
+        }
+      }
+    }
+
+  }
+
+}
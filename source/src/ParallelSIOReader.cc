@@ -0,0 +1,137 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/ParallelSIOReader.h>
+
+// -- std headers
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace lc_analysis {
+
+  namespace io {
+
+    namespace {
+      /// The default number of slots per worker thread
+      constexpr std::size_t SlotsPerThread = 4 ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    ParallelSIOReader::ParallelSIOReader( const SIOScanner &scanner, unsigned int nThreads, std::size_t nSlots ) :
+      _scanner(scanner) {
+      if( 0 == nThreads ) {
+        std::stringstream ss ; ss << "ParallelSIOReader: at least one worker thread is needed" << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      _slots.resize( ( 0 == nSlots ) ? SlotsPerThread * nThreads : nSlots ) ;
+      _threads.reserve( nThreads ) ;
+      try {
+        for( unsigned int t=0 ; t<nThreads ; ++t ) {
+          _threads.emplace_back( &ParallelSIOReader::work, this ) ;
+        }
+      }
+      catch( ... ) {
+        stop() ;
+        throw ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    ParallelSIOReader::~ParallelSIOReader() {
+      stop() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void ParallelSIOReader::stop() {
+      {
+        std::lock_guard<std::mutex> lock( _mutex ) ;
+        _stop = true ;
+      }
+      _freeCondition.notify_all() ;
+      for( auto &thread : _threads ) {
+        if( thread.joinable() ) {
+          thread.join() ;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    bool ParallelSIOReader::next( SIOEventData &event ) {
+      // only the consumer writes _nextEvent: no lock needed to read it here
+      if( _nextEvent >= _scanner.events().size() ) {
+        return false ;
+      }
+      auto &slot = _slots[ _nextEvent % _slots.size() ] ;
+      std::unique_lock<std::mutex> lock( _mutex ) ;
+      _readyCondition.wait( lock, [&slot]() { return slot._ready ; } ) ;
+      // the slot is ready: the workers don't touch it until it is given back
+      lock.unlock() ;
+      std::exception_ptr error = nullptr ;
+      std::swap( error, slot._error ) ;
+      if( nullptr == error ) {
+        std::swap( event, slot._event ) ;
+      }
+      lock.lock() ;
+      slot._ready = false ;
+      ++_nextEvent ;
+      lock.unlock() ;
+      // one slot freed: one more event can be inflated
+      _freeCondition.notify_one() ;
+      if( nullptr != error ) {
+        std::rethrow_exception( error ) ;
+      }
+      return true ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void ParallelSIOReader::decode( const SIOScanner &scanner, std::size_t index, SIOEventData &event ) {
+      const auto &sioEvent = scanner.events()[index] ;
+      const auto &headerRecord = scanner.records()[ sioEvent._headerRecord ] ;
+      const auto &eventRecord = scanner.records()[ sioEvent._eventRecord ] ;
+      event._index = index ;
+      event._runNumber = sioEvent._runNumber ;
+      event._eventNumber = sioEvent._eventNumber ;
+      event._headerData = scanner.recordData( headerRecord, event._headerBuffer ) ;
+      SIOScanner::blocks( event._headerData, headerRecord._uncompressedLength, event._headerBlocks ) ;
+      event._eventData = scanner.recordData( eventRecord, event._eventBuffer ) ;
+      SIOScanner::blocks( event._eventData, eventRecord._uncompressedLength, event._blocks ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void ParallelSIOReader::work() {
+      const auto nEvents = _scanner.events().size() ;
+      const auto nSlots = _slots.size() ;
+      std::unique_lock<std::mutex> lock( _mutex ) ;
+      while( true ) {
+        // wait for a free slot, i.e the event to inflate is at most nSlots ahead of the consumer
+        _freeCondition.wait( lock, [this, nEvents, nSlots]() {
+          return _stop || _nextTask >= nEvents || _nextTask < _nextEvent + nSlots ;
+        }) ;
+        if( _stop || _nextTask >= nEvents ) {
+          return ;
+        }
+        const auto task = _nextTask++ ;
+        auto &slot = _slots[ task % nSlots ] ;
+        // inflate without the lock: the slot is owned by this worker until ready
+        lock.unlock() ;
+        try {
+          decode( _scanner, task, slot._event ) ;
+        }
+        catch( ... ) {
+          slot._error = std::current_exception() ;
+        }
+        lock.lock() ;
+        slot._ready = true ;
+        _readyCondition.notify_one() ;
+      }
+    }
+
+  }
+
+}
@@ -0,0 +1,208 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/SIOScanner.h>
+
+// -- std headers
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+// -- system headers
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// -- zlib headers
+#include <zlib.h>
+
+namespace lc_analysis {
+
+  namespace io {
+
+    namespace {
+      /// The record and block markers
+      constexpr uint32_t RecordMarker = 0xabadcafe ;
+      constexpr uint32_t BlockMarker = 0xdeadbeef ;
+      /// The record option of compressed data
+      constexpr uint32_t CompressOption = 0x00000001 ;
+      /// The record and block header lengths, without the name
+      constexpr uint32_t RecordHeaderLength = 24 ;
+      constexpr uint32_t BlockHeaderLength = 16 ;
+
+      /// Read a big endian 32 bits word
+      inline uint32_t readUInt32( const uint8_t *data ) {
+        return ( uint32_t(data[0]) << 24 ) | ( uint32_t(data[1]) << 16 ) | ( uint32_t(data[2]) << 8 ) | uint32_t(data[3]) ;
+      }
+
+      /// Round a length up to a multiple of 4 (SIO padding)
+      inline uint64_t padded( uint64_t length ) {
+        return ( length + 3 ) & ~uint64_t(3) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    SIOScanner::SIOScanner( const std::string &fileName ) :
+      _fileName(fileName) {
+      const int descriptor = ::open( fileName.c_str(), O_RDONLY ) ;
+      if( descriptor < 0 ) {
+        std::stringstream ss ; ss << "SIOScanner: can't open " << fileName << ": " << std::strerror( errno ) << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      struct stat status ;
+      if( ::fstat( descriptor, &status ) < 0 ) {
+        const int error = errno ;
+        ::close( descriptor ) ;
+        std::stringstream ss ; ss << "SIOScanner: can't stat " << fileName << ": " << std::strerror( error ) << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+      _size = static_cast<std::size_t>( status.st_size ) ;
+      if( _size > 0 ) {
+        void *mapping = ::mmap( nullptr, _size, PROT_READ, MAP_PRIVATE, descriptor, 0 ) ;
+        if( MAP_FAILED == mapping ) {
+          const int error = errno ;
+          ::close( descriptor ) ;
+          std::stringstream ss ; ss << "SIOScanner: can't map " << fileName << ": " << std::strerror( error ) << std::endl ;
+          throw std::runtime_error( ss.str() ) ;
+        }
+        // the records are walked in order: let the kernel read ahead
+        ::madvise( mapping, _size, MADV_SEQUENTIAL ) ;
+        _data = static_cast<const uint8_t*>( mapping ) ;
+      }
+      // the mapping stays valid once the file is closed
+      ::close( descriptor ) ;
+      try {
+        scan() ;
+      }
+      catch( ... ) {
+        if( nullptr != _data ) {
+          ::munmap( const_cast<uint8_t*>( _data ), _size ) ;
+        }
+        throw ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    SIOScanner::~SIOScanner() {
+      if( nullptr != _data ) {
+        ::munmap( const_cast<uint8_t*>( _data ), _size ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    const uint8_t *SIOScanner::recordData( const SIORecord &record, std::vector<uint8_t> &buffer ) const {
+      if( not record._compressed ) {
+        return _data + record._dataOffset ;
+      }
+      buffer.resize( record._uncompressedLength ) ;
+      inflate( _data + record._dataOffset, record._dataLength, buffer.data(), buffer.size() ) ;
+      return buffer.data() ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    const uint8_t *SIOScanner::collections( std::size_t event, std::vector<uint8_t> &buffer, std::vector<SIOBlock> &blocks ) const {
+      const auto &record = _records[ _events[event]._eventRecord ] ;
+      const auto data = recordData( record, buffer ) ;
+      SIOScanner::blocks( data, record._uncompressedLength, blocks ) ;
+      return data ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void SIOScanner::blocks( const uint8_t *data, std::size_t length, std::vector<SIOBlock> &blocks ) {
+      blocks.clear() ;
+      std::size_t offset = 0 ;
+      while( offset + BlockHeaderLength <= length ) {
+        const uint8_t *header = data + offset ;
+        const uint32_t blockLength = readUInt32( header ) ;
+        const uint32_t nameLength = readUInt32( header + 12 ) ;
+        const uint64_t headerLength = BlockHeaderLength + padded( nameLength ) ;
+        if( BlockMarker != readUInt32( header + 4 ) || blockLength < headerLength || offset + blockLength > length ) {
+          std::stringstream ss ; ss << "SIOScanner: invalid block header at offset " << offset << " of the record data" << std::endl ;
+          throw std::runtime_error( ss.str() ) ;
+        }
+        SIOBlock block ;
+        block._name.assign( reinterpret_cast<const char*>( header + BlockHeaderLength ), nameLength ) ;
+        block._version = readUInt32( header + 8 ) ;
+        block._offset = static_cast<uint32_t>( offset + headerLength ) ;
+        block._length = static_cast<uint32_t>( blockLength - headerLength ) ;
+        blocks.push_back( std::move( block ) ) ;
+        offset += padded( blockLength ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void SIOScanner::inflate( const uint8_t *data, std::size_t length, uint8_t *out, std::size_t outLength ) {
+      uLongf inflatedLength = static_cast<uLongf>( outLength ) ;
+      const int status = ::uncompress( out, &inflatedLength, data, static_cast<uLong>( length ) ) ;
+      if( Z_OK != status || inflatedLength != outLength ) {
+        std::stringstream ss ; ss << "SIOScanner: can't inflate record data (zlib status " << status << ", "
+          << inflatedLength << " of " << outLength << " bytes)" << std::endl ;
+        throw std::runtime_error( ss.str() ) ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void SIOScanner::scan() {
+      std::vector<uint8_t> buffer ;
+      std::vector<SIOBlock> headerBlocks ;
+      std::size_t pendingHeader = _records.max_size() ;
+      SIOEvent event ;
+      uint64_t offset = 0 ;
+      while( offset < _size ) {
+        const uint8_t *header = _data + offset ;
+        if( offset + RecordHeaderLength > _size || RecordMarker != readUInt32( header + 4 ) ) {
+          std::stringstream ss ; ss << "SIOScanner: invalid record header at offset " << offset << " of " << _fileName << std::endl ;
+          throw std::runtime_error( ss.str() ) ;
+        }
+        const uint64_t headerLength = readUInt32( header ) ;
+        const uint64_t nameLength = readUInt32( header + 20 ) ;
+        const uint64_t dataLength = readUInt32( header + 12 ) ;
+        // checked against the remaining bytes, in this order, so that no
+        // subtraction underflows. The data of the last record may not be padded
+        if( headerLength > _size - offset || headerLength < RecordHeaderLength
+          || nameLength > headerLength - RecordHeaderLength || dataLength > _size - ( offset + headerLength ) ) {
+          std::stringstream ss ; ss << "SIOScanner: truncated record at offset " << offset << " of " << _fileName << std::endl ;
+          throw std::runtime_error( ss.str() ) ;
+        }
+        SIORecord record ;
+        record._offset = offset ;
+        record._dataOffset = offset + headerLength ;
+        record._dataLength = static_cast<uint32_t>( dataLength ) ;
+        record._compressed = ( 0 != ( readUInt32( header + 8 ) & CompressOption ) ) ;
+        record._uncompressedLength = record._compressed ? readUInt32( header + 16 ) : record._dataLength ;
+        record._name.assign( reinterpret_cast<const char*>( header + RecordHeaderLength ), nameLength ) ;
+        offset = record._dataOffset + padded( record._dataLength ) ;
+        // events: an LCEventHeader record, then its LCEvent record
+        if( "LCEventHeader" == record._name ) {
+          const auto data = recordData( record, buffer ) ;
+          blocks( data, record._uncompressedLength, headerBlocks ) ;
+          pendingHeader = _records.max_size() ;
+          for( const auto &block : headerBlocks ) {
+            if( "EventHeader" == block._name && block._length >= 8 ) {
+              event._runNumber = static_cast<int>( readUInt32( data + block._offset ) ) ;
+              event._eventNumber = static_cast<int>( readUInt32( data + block._offset + 4 ) ) ;
+              pendingHeader = _records.size() ;
+            }
+          }
+        }
+        else if( "LCEvent" == record._name && _records.max_size() != pendingHeader ) {
+          event._headerRecord = static_cast<uint32_t>( pendingHeader ) ;
+          event._eventRecord = static_cast<uint32_t>( _records.size() ) ;
+          _events.push_back( event ) ;
+          pendingHeader = _records.max_size() ;
+        }
+        _records.push_back( std::move( record ) ) ;
+      }
+    }
+
+  }
+
+}
@@ -0,0 +1,156 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/TruthLinks.h>
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCIO.h>
+#include <EVENT/LCRelation.h>
+
+// -- std headers
+#include <algorithm>
+#include <iterator>
+
+namespace lc_analysis {
+
+  namespace mc {
+
+    namespace {
+
+      using SortedObjects = std::vector<std::pair<const EVENT::LCObject*, ObjectIndex>> ;
+
+      /// Sort the objects of a collection by address, with their index
+      void sortObjects( const EVENT::LCCollection *collection, SortedObjects &objects ) {
+        const std::size_t nobjects = collection->getNumberOfElements() ;
+        objects.resize( nobjects ) ;
+        for( std::size_t i=0 ; i<nobjects ; ++i ) {
+          objects[i] = { collection->getElementAt( i ), static_cast<ObjectIndex>( i ) } ;
+        }
+        std::sort( objects.begin(), objects.end() ) ;
+      }
+
+      /// Get the collection index of an object. NoObject if not found
+      ObjectIndex objectIndex( const SortedObjects &objects, const EVENT::LCObject *object ) {
+        auto iter = std::lower_bound( objects.begin(), objects.end(), object,
+          []( const std::pair<const EVENT::LCObject*, ObjectIndex> &entry, const EVENT::LCObject *o ) {
+          return entry.first < o ;
+        }) ;
+        return ( objects.end() != iter && iter->first == object ) ? iter->second : NoObject ;
+      }
+
+      /// Decode a link weight
+      float decodeWeight( float weight, LinkWeight mode ) {
+        switch( mode ) {
+          case LinkWeight::Track: return ( static_cast<int>( weight ) % 10000 ) / 1000.f ;
+          case LinkWeight::Cluster: return ( static_cast<int>( weight ) / 10000 ) / 1000.f ;
+          default: return weight ;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    void TruthLinkIndex::build( const EVENT::LCCollection *relations, const EVENT::LCCollection *recoObjects,
+      const EVENT::LCCollection *mcParticles, LinkWeight weight ) {
+      sortObjects( recoObjects, _sortedRecoObjects ) ;
+      sortObjects( mcParticles, _sortedMCParticles ) ;
+      const bool mcFirst = ( relations->getParameters().getStringVal( "FromType" ) == EVENT::LCIO::MCPARTICLE ) ;
+      const std::size_t nrelations = relations->getNumberOfElements() ;
+      _links.clear() ;
+      _links.reserve( nrelations ) ;
+      for( std::size_t i=0 ; i<nrelations ; ++i ) {
+        const auto relation = static_cast<const EVENT::LCRelation*>( relations->getElementAt( i ) ) ;
+        const auto reco = mcFirst ? relation->getTo() : relation->getFrom() ;
+        const auto mc = mcFirst ? relation->getFrom() : relation->getTo() ;
+        Link link ;
+        link._reco = objectIndex( _sortedRecoObjects, reco ) ;
+        link._mc = objectIndex( _sortedMCParticles, mc ) ;
+        link._weight = decodeWeight( relation->getWeight(), weight ) ;
+        if( NoObject != link._reco && NoObject != link._mc ) {
+          _links.push_back( link ) ;
+        }
+      }
+      build( _sortedRecoObjects.size(), _sortedMCParticles.size(), _links ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void TruthLinkIndex::build( std::size_t nrecoObjects, std::size_t nmcParticles, const std::vector<Link> &links ) {
+      // the links are already in the scratch when built from a relation collection
+      if( &links != &_links ) {
+        _links.clear() ;
+        std::copy_if( links.begin(), links.end(), std::back_inserter( _links ), [&]( const Link &link ) {
+          return link._reco < nrecoObjects && link._mc < nmcParticles ;
+        }) ;
+      }
+      fillSide( nrecoObjects, _links, true, _recoOffsets, _recoLinks ) ;
+      fillSide( nmcParticles, _links, false, _mcOffsets, _mcLinks ) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void TruthLinkIndex::truthCategories( const DecayTree &tree, std::vector<pdg::Categories> &categories ) const {
+      const auto nreco = nRecoObjects() ;
+      const auto &treeCategories = tree.categoryArray() ;
+      categories.resize( nreco ) ;
+      for( std::size_t reco=0 ; reco<nreco ; ++reco ) {
+        const auto mc = bestMC( static_cast<ObjectIndex>( reco ) ) ;
+        categories[reco] = ( NoObject != mc && mc < treeCategories.size() ) ? treeCategories[mc] : 0 ;
+      }
+    }
+
+    //----------------------------------------------------------------------------
+
+    std::size_t TruthLinkIndex::memoryBytes() const {
+      return ( _recoOffsets.capacity() + _mcOffsets.capacity() ) * sizeof(uint32_t)
+        + ( _recoLinks.capacity() + _mcLinks.capacity() ) * sizeof(TruthLink)
+        + _links.capacity() * sizeof(Link)
+        + ( _sortedRecoObjects.capacity() + _sortedMCParticles.capacity() ) * sizeof(std::pair<const EVENT::LCObject*, ObjectIndex>) ;
+    }
+
+    //----------------------------------------------------------------------------
+
+    void TruthLinkIndex::fillSide( std::size_t nobjects, const std::vector<Link> &links, bool recoSide,
+      std::vector<uint32_t> &offsets, std::vector<TruthLink> &sideLinks ) {
+      // count, prefix sum, fill
+      offsets.assign( nobjects+1, 0 ) ;
+      for( const auto &link : links ) {
+        ++offsets[ ( recoSide ? link._reco : link._mc ) + 1 ] ;
+      }
+      for( std::size_t i=0 ; i<nobjects ; ++i ) {
+        offsets[i+1] += offsets[i] ;
+      }
+      sideLinks.resize( links.size() ) ;
+      // the offsets are used as fill cursors, then shifted back
+      for( const auto &link : links ) {
+        const auto object = recoSide ? link._reco : link._mc ;
+        auto &sideLink = sideLinks[ offsets[object]++ ] ;
+        sideLink._index = recoSide ? link._mc : link._reco ;
+        sideLink._weight = link._weight ;
+      }
+      for( std::size_t i=nobjects ; i>0 ; --i ) {
+        offsets[i] = offsets[i-1] ;
+      }
+      offsets[0] = 0 ;
+      // most objects have one or two links: insertion sort by decreasing weight, then index
+      for( std::size_t i=0 ; i<nobjects ; ++i ) {
+        const auto first = sideLinks.begin() + offsets[i] ;
+        const auto last = sideLinks.begin() + offsets[i+1] ;
+        for( auto iter = first ; iter != last ; ++iter ) {
+          const auto link = *iter ;
+          auto hole = iter ;
+          for( ; hole != first ; --hole ) {
+            const auto &previous = *std::prev( hole ) ;
+            if( previous._weight > link._weight || ( previous._weight == link._weight && previous._index <= link._index ) ) {
+              break ;
+            }
+            *hole = previous ;
+          }
+          *hole = link ;
+        }
+      }
+    }
+
+  }
+
+}
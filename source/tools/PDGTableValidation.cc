@@ -0,0 +1,215 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/PDGHelper.h>
+#include <LCAnalysisTools/PDGIndex.h>
+
+// -- std headers
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace lc_analysis::pdg ;
+
+namespace {
+
+  /**
+   *  @brief  ReferenceCharge struct
+   *
+   *  A pdg id with its known charge, in units of e/3
+   */
+  struct ReferenceCharge {
+    int          _pdg {0} ;
+    const char  *_name {nullptr} ;
+    int          _threeCharge {0} ;
+  };
+
+  /// Known charges, independent of the pdg id decoding. The antiparticles
+  /// are checked with the opposite pdg ids and charges
+  const std::vector<ReferenceCharge> referenceCharges = {
+    // leptons
+    {11, "e-", -3}, {12, "nu_e", 0}, {13, "mu-", -3}, {14, "nu_mu", 0}, {15, "tau-", -3}, {16, "nu_tau", 0},
+    // quarks
+    {1, "d", -1}, {2, "u", 2}, {3, "s", -1}, {4, "c", 2}, {5, "b", -1}, {6, "t", 2},
+    // di-quarks
+    {1103, "dd_1", -2}, {2101, "ud_0", 1}, {2203, "uu_1", 4}, {3101, "sd_0", -2}, {3201, "su_0", 1},
+    // gauge and Higgs bosons
+    {21, "g", 0}, {22, "gamma", 0}, {23, "Z0", 0}, {24, "W+", 3}, {25, "h0", 0}, {37, "H+", 3},
+    // light, strange, charm and bottom mesons
+    {111, "pi0", 0}, {211, "pi+", 3}, {113, "rho0", 0}, {213, "rho+", 3}, {221, "eta", 0}, {130, "K_L0", 0},
+    {310, "K_S0", 0}, {311, "K0", 0}, {321, "K+", 3}, {323, "K*+", 3}, {411, "D+", 3}, {421, "D0", 0},
+    {431, "D_s+", 3}, {443, "J/psi", 0}, {511, "B0", 0}, {521, "B+", 3}, {531, "B_s0", 0}, {541, "B_c+", 3},
+    {553, "Upsilon", 0},
+    // baryons
+    {2212, "p+", 3}, {2112, "n0", 0}, {2224, "Delta++", 6}, {1114, "Delta-", -3}, {3122, "Lambda0", 0},
+    {3222, "Sigma+", 3}, {3112, "Sigma-", -3}, {3312, "Xi-", -3}, {3334, "Omega-", -3}, {4122, "Lambda_c+", 3},
+    {4222, "Sigma_c++", 6}, {5122, "Lambda_b0", 0}, {5132, "Xi_b-", -3},
+    // SUSY states
+    {1000011, "~e_L-", -3}, {2000013, "~mu_R-", -3}, {1000012, "~nu_eL", 0}, {1000002, "~u_L", 2},
+    {1000005, "~b_1", -1}, {1000021, "~g", 0}, {1000022, "~chi_10", 0}, {1000024, "~chi_1+", 3},
+    {1000037, "~chi_2+", 3},
+    // nuclei, 10LZZZAAAI
+    {1000010020, "deuteron", 3}, {1000010030, "triton", 3}, {1000020040, "alpha", 6}, {1000060120, "C12", 18},
+    {1000080160, "O16", 24}, {1000260560, "Fe56", 78}, {1000791970, "Au197", 237}, {1000822080, "Pb208", 246}
+  };
+
+  /// Check the charges computed from the pdg ids by the scalar and the batch
+  /// functions against the reference charges. Returns the number of mismatches
+  std::size_t checkReferenceCharges() {
+    std::vector<int> pdgids ;
+    std::vector<int> expected ;
+    std::vector<std::string> names ;
+    for( const auto &reference : referenceCharges ) {
+      for( const int sign : { 1, -1 } ) {
+        pdgids.push_back( sign * reference._pdg ) ;
+        expected.push_back( sign * reference._threeCharge ) ;
+        names.push_back( ( sign > 0 ? "" : "anti-" ) + std::string( reference._name ) ) ;
+      }
+    }
+    std::vector<int16_t> batchThreeCharges( pdgids.size() ) ;
+    PDGHelper::threeCharge( pdgids.data(), batchThreeCharges.data(), pdgids.size() ) ;
+    std::size_t nmismatches = 0 ;
+    for( std::size_t i=0 ; i<pdgids.size() ; ++i ) {
+      const int threeCharge = PDGHelper::threeCharge( pdgids[i] ) ;
+      if( threeCharge != expected[i] || batchThreeCharges[i] != expected[i] ) {
+        std::cout << "  " << names[i] << " (" << pdgids[i] << "): expected " << expected[i] / 3.f
+          << ", computed " << threeCharge / 3.f << ", batch " << batchThreeCharges[i] / 3.f << std::endl ;
+        ++nmismatches ;
+      }
+    }
+    std::cout << "reference charges: " << pdgids.size() << " pdg ids, " << nmismatches << " mismatches" << std::endl ;
+    return nmismatches ;
+  }
+
+  /// Check the batch charge function against the scalar one for every pdg id
+  /// of the table. Returns the number of mismatches
+  std::size_t checkBatchCharges() {
+    std::vector<int> pdgids ;
+    pdgids.reserve( pdgTable.size() ) ;
+    for( const auto &particle : pdgTable ) {
+      pdgids.push_back( particle.pdg() ) ;
+    }
+    std::vector<int16_t> batchThreeCharges( pdgids.size() ) ;
+    PDGHelper::threeCharge( pdgids.data(), batchThreeCharges.data(), pdgids.size() ) ;
+    std::size_t nmismatches = 0 ;
+    for( std::size_t r=0 ; r<pdgTable.size() ; ++r ) {
+      const auto &particle = pdgTable[r] ;
+      const int threeCharge = PDGHelper::threeCharge( particle.pdg() ) ;
+      if( batchThreeCharges[r] != threeCharge ) {
+        std::cout << "  " << particle.name() << " (" << particle.pdg() << "): computed " << threeCharge / 3.f
+          << ", batch " << batchThreeCharges[r] / 3.f << std::endl ;
+        ++nmismatches ;
+      }
+    }
+    std::cout << "batch charges: " << pdgTable.size() << " particles, " << nmismatches << " mismatches" << std::endl ;
+    return nmismatches ;
+  }
+
+  /// Get the names of the category flags set in a mask, space separated
+  std::string categoryNames( Categories categories ) {
+    std::string names ;
+    for( std::size_t bit=0 ; bit<category::NCategories ; ++bit ) {
+      if( categories & ( Categories(1) << bit ) ) {
+        names += ( names.empty() ? "" : " " ) + std::string( category::name( bit ) ) ;
+      }
+    }
+    return names ;
+  }
+
+  /// Write the category flags of every pdg id of the table, one "pdg flags" line per id
+  void dumpFlags( const std::string &fname ) {
+    std::ofstream file( fname ) ;
+    if( not file ) {
+      throw std::runtime_error( "Couldn't open flags output file " + fname ) ;
+    }
+    for( const auto &particle : pdgTable ) {
+      file << particle.pdg() << " " << PDGHelper::categories( particle.pdg() ) << "\n" ;
+    }
+    std::cout << "flags: " << pdgTable.size() << " particles written to " << fname << std::endl ;
+  }
+
+  /// Compare the category flags of every pdg id of the table to a dump written
+  /// by dumpFlags(), listing the flags set and unset per pdg id.
+  /// Returns the number of pdg ids whose flags differ
+  std::size_t compareFlags( const std::string &fname ) {
+    std::ifstream file( fname ) ;
+    if( not file ) {
+      throw std::runtime_error( "Couldn't open flags file " + fname ) ;
+    }
+    std::map<int, Categories> reference ;
+    int pdg = 0 ;
+    Categories categories = 0 ;
+    while( file >> pdg >> categories ) {
+      reference.emplace( pdg, categories ) ;
+    }
+    std::map<int, std::string> names ;
+    for( const auto &particle : pdgTable ) {
+      names.emplace( particle.pdg(), particle.name() ) ;
+    }
+    std::size_t nchanged = 0 ;
+    for( const auto &entry : names ) {
+      auto iter = reference.find( entry.first ) ;
+      if( reference.end() == iter ) {
+        std::cout << "  " << std::setw(12) << entry.first << " " << std::left << std::setw(20) << entry.second << std::right << " not in the reference" << std::endl ;
+        ++nchanged ;
+        continue ;
+      }
+      const auto current = PDGHelper::categories( entry.first ) ;
+      if( current == iter->second ) {
+        continue ;
+      }
+      std::cout << "  " << std::setw(12) << entry.first << " " << std::left << std::setw(20) << entry.second << std::right ;
+      const auto set = current & ~iter->second ;
+      const auto unset = iter->second & ~current ;
+      if( set ) {
+        std::cout << " +[" << categoryNames( set ) << "]" ;
+      }
+      if( unset ) {
+        std::cout << " -[" << categoryNames( unset ) << "]" ;
+      }
+      std::cout << std::endl ;
+      ++nchanged ;
+    }
+    std::cout << "flags: " << names.size() << " pdg ids, " << nchanged << " changed" << std::endl ;
+    return nchanged ;
+  }
+
+}
+
+int main( int argc, char **argv ) {
+  std::string dumpFile ;
+  std::string referenceFile ;
+  for( int i=1 ; i<argc ; ++i ) {
+    const std::string arg = argv[i] ;
+    const bool hasValue = ( i+1 < argc ) ;
+    if( arg == "--dump-flags" && hasValue ) {
+      dumpFile = argv[++i] ;
+    }
+    else if( arg == "--compare-flags" && hasValue ) {
+      referenceFile = argv[++i] ;
+    }
+    else {
+      std::cerr << "Usage: " << argv[0] << " [--dump-flags <file>] [--compare-flags <file>]" << std::endl ;
+      return 2 ;
+    }
+  }
+  try {
+    std::size_t nfailed = 0 ;
+    nfailed += checkReferenceCharges() ;
+    nfailed += checkBatchCharges() ;
+    if( not referenceFile.empty() ) {
+      nfailed += compareFlags( referenceFile ) ;
+    }
+    if( not dumpFile.empty() ) {
+      dumpFlags( dumpFile ) ;
+    }
+    return nfailed > 0 ? 1 : 0 ;
+  }
+  catch( const std::exception &e ) {
+    std::cerr << "Error: " << e.what() << std::endl ;
+    return 2 ;
+  }
+}
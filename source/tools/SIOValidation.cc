@@ -0,0 +1,135 @@
+
+// -- LCAnalysisTools headers
+#include <LCAnalysisTools/ParallelSIOReader.h>
+#include <LCAnalysisTools/SIOScanner.h>
+
+// -- lcio headers
+#include <EVENT/LCEvent.h>
+#include <IO/LCReader.h>
+#include <IOIMPL/LCFactory.h>
+
+// -- std headers
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lc_analysis ;
+
+namespace {
+
+  /// Get the elapsed time since a start time, in ms
+  double elapsedMs( std::chrono::steady_clock::time_point start ) {
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count() ;
+  }
+
+  /// The content of an event: its numbers and sorted collection names
+  struct EventContent {
+    int                        _runNumber {0} ;
+    int                        _eventNumber {0} ;
+    std::vector<std::string>   _collections {} ;
+  };
+
+  /// Scan a file with the SIOScanner, listing the collections of all the events,
+  /// inflated by a ParallelSIOReader with nThreads workers
+  std::vector<EventContent> scanFile( const std::string &fileName, unsigned int nThreads, double &scanTime, std::size_t &nbytes ) {
+    const auto start = std::chrono::steady_clock::now() ;
+    io::SIOScanner scanner( fileName ) ;
+    io::ParallelSIOReader reader( scanner, nThreads ) ;
+    std::vector<EventContent> events ;
+    events.reserve( scanner.events().size() ) ;
+    io::SIOEventData event ;
+    nbytes = 0 ;
+    while( reader.next( event ) ) {
+      EventContent content ;
+      content._runNumber = event._runNumber ;
+      content._eventNumber = event._eventNumber ;
+      for( const auto &block : event._blocks ) {
+        content._collections.push_back( block._name ) ;
+        nbytes += block._length ;
+      }
+      std::sort( content._collections.begin(), content._collections.end() ) ;
+      events.push_back( std::move( content ) ) ;
+    }
+    scanTime = elapsedMs( start ) ;
+    return events ;
+  }
+
+  /// Read a file with the LCIO reader
+  std::vector<EventContent> readFile( const std::string &fileName, double &readTime ) {
+    const auto start = std::chrono::steady_clock::now() ;
+    std::unique_ptr<IO::LCReader> reader( IOIMPL::LCFactory::getInstance()->createLCReader() ) ;
+    reader->open( fileName ) ;
+    std::vector<EventContent> events ;
+    while( const auto event = reader->readNextEvent() ) {
+      EventContent content ;
+      content._runNumber = event->getRunNumber() ;
+      content._eventNumber = event->getEventNumber() ;
+      content._collections = *event->getCollectionNames() ;
+      std::sort( content._collections.begin(), content._collections.end() ) ;
+      events.push_back( std::move( content ) ) ;
+    }
+    reader->close() ;
+    readTime = elapsedMs( start ) ;
+    return events ;
+  }
+
+  /// Compare the scanner and reader contents of a file. Returns the number of differences
+  std::size_t compare( const std::vector<EventContent> &scanned, const std::vector<EventContent> &read ) {
+    std::size_t ndifferences = 0 ;
+    if( scanned.size() != read.size() ) {
+      std::cout << "  scanned " << scanned.size() << " events, read " << read.size() << std::endl ;
+      ++ndifferences ;
+    }
+    for( std::size_t e=0 ; e<std::min( scanned.size(), read.size() ) ; ++e ) {
+      const auto &lhs = scanned[e], &rhs = read[e] ;
+      if( lhs._runNumber != rhs._runNumber || lhs._eventNumber != rhs._eventNumber ) {
+        std::cout << "  event " << e << ": scanned run " << lhs._runNumber << " event " << lhs._eventNumber
+          << ", read run " << rhs._runNumber << " event " << rhs._eventNumber << std::endl ;
+        ++ndifferences ;
+      }
+      else if( lhs._collections != rhs._collections ) {
+        std::cout << "  event " << e << " (run " << lhs._runNumber << " event " << lhs._eventNumber << "): scanned "
+          << lhs._collections.size() << " collections, read " << rhs._collections.size() << std::endl ;
+        ++ndifferences ;
+      }
+    }
+    return ndifferences ;
+  }
+
+}
+
+int main( int argc, char **argv ) {
+  if( argc < 2 ) {
+    std::cerr << "Usage: " << argv[0] << " file.slcio [file.slcio ...]" << std::endl ;
+    std::cerr << "Checks that the SIOScanner and the ParallelSIOReader find the events and collections read by the LCIO reader" << std::endl ;
+    return 2 ;
+  }
+  const unsigned int nThreads = std::max( 1u, std::thread::hardware_concurrency() ) ;
+  std::size_t nfailed = 0 ;
+  for( int f=1 ; f<argc ; ++f ) {
+    const std::string fileName = argv[f] ;
+    try {
+      double scanTime = 0., readTime = 0. ;
+      std::size_t nbytes = 0 ;
+      const auto scanned = scanFile( fileName, nThreads, scanTime, nbytes ) ;
+      const auto read = readFile( fileName, readTime ) ;
+      std::cout << fileName << ": " << scanned.size() << " events, " << nbytes << " collection bytes, scanned in "
+        << scanTime << " ms (" << nThreads << " threads), read in " << readTime << " ms" << std::endl ;
+      const auto ndifferences = compare( scanned, read ) ;
+      if( ndifferences > 0 ) {
+        std::cout << "  FAILED: " << ndifferences << " differences" << std::endl ;
+        ++nfailed ;
+      }
+    }
+    catch( const std::exception &e ) {
+      std::cout << fileName << ": FAILED: " << e.what() << std::endl ;
+      ++nfailed ;
+    }
+  }
+  return nfailed > 0 ? 1 : 0 ;
+}